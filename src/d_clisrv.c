@@ -46,6 +46,10 @@
 #include "md5.h"
 #include "m_perfstats.h"
 
+#ifdef HAVE_ZLIB
+#include <zlib.h> // gamestate compression
+#endif
+
 #ifndef NONET
 // cl loading screen
 #include "v_video.h"
@@ -87,6 +91,7 @@ static boolean sendingsavegame[MAXNETNODES]; // Are we sending the savegame?
 static boolean resendingsavegame[MAXNETNODES]; // Are we resending the savegame?
 static tic_t savegameresendcooldown[MAXNETNODES]; // How long before we can resend again?
 static tic_t freezetimeout[MAXNETNODES]; // Until when can this node freeze the server before getting a timeout?
+static UINT8 gamestatecompression[MAXNETNODES]; // How the gamestates sent to this node are compressed, as told in PT_SERVERCFG
 
 // Incremented by cv_joindelay when a client joins, decremented each tic.
 // If higher than cv_joindelay * 2 (3 joins in a short timespan), joins are temporarily disabled.
@@ -122,6 +127,7 @@ static boolean cl_packetmissed;
 // here it is for the secondary local player (splitscreen)
 static UINT8 mynode; // my address pointofview server
 static boolean cl_redownloadinggamestate = false;
+static UINT8 cl_gamestatecompression = GSCOMPRESSION_LZF; // as told by the server in PT_SERVERCFG
 
 static UINT8 localtextcmd[MAXTEXTCMD];
 static UINT8 localtextcmd2[MAXTEXTCMD]; // splitscreen
@@ -1357,6 +1363,10 @@ static boolean SV_SendServerConfig(INT32 node)
 
 	memcpy(netbuffer->u.servercfg.server_context, server_context, 8);
 
+	// Stick to this for any gamestate resent later, whatever the cvar says by then
+	gamestatecompression[node] = (UINT8)cv_gamestatecompression.value;
+	netbuffer->u.servercfg.gamestatecompression = gamestatecompression[node];
+
 	{
 		const size_t len = sizeof (serverconfig_pak);
 
@@ -1391,6 +1401,253 @@ static boolean SV_SendServerConfig(INT32 node)
 #ifndef NONET
 #define SAVEGAMESIZE (768*1024)
 
+static boolean GamestateCompressionSupported(UINT8 method)
+{
+	switch (method)
+	{
+		case GSCOMPRESSION_LZF:
+			return true;
+#ifdef HAVE_ZLIB
+		case GSCOMPRESSION_ZLIB:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+/** Compresses a gamestate.
+  *
+  * \param method A gamestatecompression_t.
+  * \param level Compression level, for zlib: 1 is the fastest, 9 the densest.
+  * \param src The gamestate.
+  * \param srclen Size of the gamestate.
+  * \param dest Buffer for the compressed gamestate.
+  * \param destlen Size of dest.
+  * \return Size of the compressed gamestate, or 0 if it doesn't fit in dest.
+  */
+static size_t CompressGamestate(UINT8 method, INT32 level, const UINT8 *src, size_t srclen, UINT8 *dest, size_t destlen)
+{
+	switch (method)
+	{
+#ifdef HAVE_ZLIB
+		case GSCOMPRESSION_ZLIB:
+		{
+			uLongf zlen = (uLongf)destlen;
+
+			if (compress2(dest, &zlen, src, (uLong)srclen, level) != Z_OK)
+				return 0;
+			return (size_t)zlen;
+		}
+#endif
+		default:
+			(void)level;
+			return lzf_compress(src, srclen, dest, destlen);
+	}
+}
+
+/** Decompresses a gamestate.
+  *
+  * \param method A gamestatecompression_t.
+  * \param src The compressed gamestate.
+  * \param srclen Size of the compressed gamestate.
+  * \param dest Buffer for the gamestate.
+  * \param destlen Size of the gamestate.
+  * \return True if the gamestate was decompressed whole.
+  */
+static boolean DecompressGamestate(UINT8 method, const UINT8 *src, size_t srclen, UINT8 *dest, size_t destlen)
+{
+	switch (method)
+	{
+#ifdef HAVE_ZLIB
+		case GSCOMPRESSION_ZLIB:
+		{
+			uLongf zlen = (uLongf)destlen;
+
+			return (uncompress(dest, &zlen, src, (uLong)srclen) == Z_OK && zlen == destlen);
+		}
+#endif
+		default:
+			return (lzf_decompress(src, srclen, dest, destlen) == destlen);
+	}
+}
+
+/** Serializes the current game state into a malloc'd buffer, as it would be
+  * sent to a joining player, minus the length header.
+  *
+  * \param length Receives the size of the game state.
+  * \return The game state, or NULL if there is no memory for it.
+  */
+static UINT8 *SaveGamestateForBench(size_t *length)
+{
+	UINT8 *savebuffer = malloc(SAVEGAMESIZE);
+
+	if (!savebuffer)
+		return NULL;
+
+	save_p = savebuffer;
+	P_SaveNetGame(false);
+	*length = save_p - savebuffer;
+	save_p = NULL;
+
+	if (*length > SAVEGAMESIZE)
+		I_Error("Savegame buffer overrun");
+
+	return savebuffer;
+}
+
+/** Turns a file name given to gamestatebench into a .sav file in srb2home.
+  * Lua can run the command too, so the name can't point anywhere else.
+  *
+  * \return The path, or NULL if the name isn't a plain file name.
+  */
+static const char *GamestateBenchPath(const char *name)
+{
+	static char path[MAX_WADPATH];
+	char file[256];
+
+	if (!FIL_IsPlainFileName(name))
+	{
+		CONS_Alert(CONS_ERROR, M_GetText("%s is not a valid file name\n"), name);
+		return NULL;
+	}
+
+	strlcpy(file, name, sizeof file - 4);
+	FIL_ForceExtension(file, ".sav");
+	snprintf(path, sizeof path, "%s"PATHSEP"%s", srb2home, file);
+	return path;
+}
+
+/** Compresses a game state with every method, to compare their speed and size.
+  * The game state is either the current one, or one saved earlier with
+  * "gamestatebench save", so that real game states can be gathered in
+  * netgames and compared offline.
+  */
+static void Command_GamestateBench(void)
+{
+	static const struct
+	{
+		UINT8 method;
+		INT32 level;
+		const char *name;
+	} methods[] = {
+		{GSCOMPRESSION_LZF,  0, "LZF"},
+#ifdef HAVE_ZLIB
+		{GSCOMPRESSION_ZLIB, 1, "Zlib 1"},
+		{GSCOMPRESSION_ZLIB, 3, "Zlib 3"},
+		{GSCOMPRESSION_ZLIB, 6, "Zlib 6"},
+		{GSCOMPRESSION_ZLIB, 9, "Zlib 9"},
+#endif
+	};
+	const INT32 runs = 10;
+	UINT8 *state = NULL, *packed, *unpacked;
+	size_t length = 0, i;
+	boolean fromfile = false;
+	const char *path;
+
+	if (COM_Argc() > 1 && !strcmp(COM_Argv(1), "save"))
+	{
+		if (COM_Argc() < 3 || gamestate != GS_LEVEL)
+		{
+			CONS_Printf(M_GetText("gamestatebench save <file>: save the current game state, while in a level\n"));
+			return;
+		}
+
+		if ((path = GamestateBenchPath(COM_Argv(2))) == NULL)
+			return;
+
+		if ((state = SaveGamestateForBench(&length)) == NULL)
+		{
+			CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
+			return;
+		}
+
+		if (FIL_WriteFile(path, state, length))
+			CONS_Printf(M_GetText("Saved game state to %s (%s bytes)\n"), path, sizeu1(length));
+		else
+			CONS_Alert(CONS_ERROR, M_GetText("Can't write %s\n"), path);
+
+		free(state);
+		return;
+	}
+
+	if (COM_Argc() > 1)
+	{
+		if ((path = GamestateBenchPath(COM_Argv(1))) == NULL)
+			return;
+
+		if (!(length = FIL_ReadFile(path, &state)))
+		{
+			CONS_Alert(CONS_ERROR, M_GetText("Can't read %s\n"), path);
+			return;
+		}
+		fromfile = true;
+	}
+	else if (gamestate != GS_LEVEL)
+	{
+		CONS_Printf(M_GetText("gamestatebench [file]: compress the current game state, or a saved one, with each method\n"));
+		return;
+	}
+	else if ((state = SaveGamestateForBench(&length)) == NULL)
+	{
+		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
+		return;
+	}
+
+	packed = malloc(length);
+	unpacked = malloc(length);
+
+	if (packed && unpacked)
+	{
+		CONS_Printf(M_GetText("Game state of %s bytes, best of %d runs:\n"), sizeu1(length), runs);
+
+		for (i = 0; i < sizeof methods / sizeof *methods; i++)
+		{
+			precise_t packtime = 0, unpacktime = 0, t;
+			size_t packedlen = 0;
+			boolean ok = true;
+			INT32 run;
+
+			for (run = 0; run < runs && ok; run++)
+			{
+				t = I_GetPreciseTime();
+				packedlen = CompressGamestate(methods[i].method, methods[i].level, state, length, packed, length);
+				t = I_GetPreciseTime() - t;
+				if (!run || t < packtime)
+					packtime = t;
+
+				if (!packedlen)
+					break;
+
+				t = I_GetPreciseTime();
+				ok = DecompressGamestate(methods[i].method, packed, packedlen, unpacked, length)
+					&& !memcmp(state, unpacked, length);
+				t = I_GetPreciseTime() - t;
+				if (!run || t < unpacktime)
+					unpacktime = t;
+			}
+
+			if (!packedlen)
+				CONS_Printf("%-8s doesn't make it smaller\n", methods[i].name);
+			else if (!ok)
+				CONS_Alert(CONS_ERROR, "%s: the game state didn't survive a round trip\n", methods[i].name);
+			else
+				CONS_Printf("%-8s %8s bytes (%3d%%), compress %6d us, decompress %6d us\n",
+					methods[i].name, sizeu1(packedlen), (INT32)(packedlen * 100 / length),
+					I_PreciseToMicros(packtime), I_PreciseToMicros(unpacktime));
+		}
+	}
+	else
+		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
+
+	free(packed);
+	free(unpacked);
+	if (fromfile)
+		Z_Free(state);
+	else
+		free(state);
+}
+
 static boolean SV_ResendingSavegameToAnyone(void)
 {
 	INT32 i;
@@ -1438,8 +1695,9 @@ static void SV_SendSaveGame(INT32 node, boolean resending)
 		return;
 	}
 
-	// Attempt to compress it.
-	if((compressedlen = lzf_compress(savebuffer + sizeof(UINT32), length - sizeof(UINT32), compressedsave + sizeof(UINT32), length - sizeof(UINT32) - 1)))
+	// Attempt to compress it, the way the node was told in PT_SERVERCFG.
+	if((compressedlen = CompressGamestate(gamestatecompression[node], cv_gamestatecompressionlevel.value,
+		savebuffer + sizeof(UINT32), length - sizeof(UINT32), compressedsave + sizeof(UINT32), length - sizeof(UINT32) - 1)))
 	{
 		// Compressing succeeded; send compressed data
 
@@ -1539,7 +1797,8 @@ static void CL_LoadReceivedSavegame(boolean reloading)
 	if(decompressedlen > 0)
 	{
 		UINT8 *decompressedbuffer = Z_Malloc(decompressedlen, PU_STATIC, NULL);
-		lzf_decompress(save_p, length - sizeof(UINT32), decompressedbuffer, decompressedlen);
+		if (!DecompressGamestate(cl_gamestatecompression, save_p, length - sizeof(UINT32), decompressedbuffer, decompressedlen))
+			I_Error("Can't decompress savegame sent");
 		Z_Free(savebuffer);
 		save_p = savebuffer = decompressedbuffer;
 	}
@@ -3113,6 +3372,17 @@ static CV_PossibleValue_t resynchattempts_cons_t[] = {{1, "MIN"}, {20, "MAX"}, {
 consvar_t cv_resynchattempts = CVAR_INIT ("resynchattempts", "10", CV_SAVE|CV_NETVAR, resynchattempts_cons_t, NULL);
 consvar_t cv_blamecfail = CVAR_INIT ("blamecfail", "Off", CV_SAVE|CV_NETVAR, CV_OnOff, NULL);
 
+// How gamestates sent to joining players are compressed
+static CV_PossibleValue_t gamestatecompression_cons_t[] = {
+	{GSCOMPRESSION_LZF, "LZF"},
+#ifdef HAVE_ZLIB
+	{GSCOMPRESSION_ZLIB, "Zlib"},
+#endif
+	{0, NULL}};
+consvar_t cv_gamestatecompression = CVAR_INIT ("gamestatecompression", "LZF", CV_SAVE, gamestatecompression_cons_t, NULL);
+static CV_PossibleValue_t gamestatecompressionlevel_cons_t[] = {{1, "MIN"}, {9, "MAX"}, {0, NULL}};
+consvar_t cv_gamestatecompressionlevel = CVAR_INIT ("gamestatecompressionlevel", "6", CV_SAVE, gamestatecompressionlevel_cons_t, NULL);
+
 // max file size to send to a player (in kilobytes)
 static CV_PossibleValue_t maxsend_cons_t[] = {{0, "MIN"}, {51200, "MAX"}, {0, NULL}};
 consvar_t cv_maxsend = CVAR_INIT ("maxsend", "4096", CV_SAVE|CV_NETVAR, maxsend_cons_t, NULL);
@@ -3141,6 +3411,7 @@ void D_ClientServerInit(void)
 	COM_AddCommand("connect", Command_connect);
 	COM_AddCommand("nodes", Command_Nodes);
 	COM_AddCommand("resendgamestate", Command_ResendGamestate);
+	COM_AddCommand("gamestatebench", Command_GamestateBench);
 #ifdef PACKETDROP
 	COM_AddCommand("drop", Command_Drop);
 	COM_AddCommand("droprate", Command_Droprate);
@@ -3916,6 +4187,22 @@ static void HandlePacketFromAwayNode(SINT8 node)
 				G_SetGametype(netbuffer->u.servercfg.gametype);
 				modifiedgame = netbuffer->u.servercfg.modifiedgame;
 				memcpy(server_context, netbuffer->u.servercfg.server_context, 8);
+				cl_gamestatecompression = netbuffer->u.servercfg.gamestatecompression;
+
+#ifndef NONET
+				if (!GamestateCompressionSupported(cl_gamestatecompression))
+				{
+					D_QuitNetGame();
+					CL_Reset();
+					D_StartTitle();
+
+					M_StartMessage(M_GetText("The server compresses the game state\nin a way this build can't read.\n\nPress ESC\n"), NULL, MM_NOTHING);
+
+					// Will be reset by caller. Signals refusal.
+					cl_mode = CL_ABORTED;
+					break;
+				}
+#endif
 			}
 
 			nodeingame[(UINT8)servernode] = true;
@@ -4857,6 +5144,8 @@ void TryRunTics(tic_t realtics)
 
 				ps_tictime = I_GetPreciseTime() - ps_tictime;
 
+				Z_StatsTicker();
+
 				// Leave a certain amount of tics present in the net buffer as long as we've ran at least one tic this frame.
 				if (client && gamestate == GS_LEVEL && leveltime > 3 && neededtic <= gametic + cv_netticbuffer.value)
 					break;
@@ -26,7 +26,7 @@ The 'packet version' is used to distinguish packet formats.
 This version is independent of VERSION and SUBVERSION. Different
 applications may follow different packet versions.
 */
-#define PACKETVERSION 3
+#define PACKETVERSION 4
 
 // Network play related stuff.
 // There is a data struct that stores network
@@ -129,6 +129,15 @@ typedef struct
 #pragma warning(disable :  4200)
 #endif
 
+// Compression methods for the gamestates sent to joining clients.
+// The values go over the wire, so don't reorder them.
+typedef enum
+{
+	GSCOMPRESSION_LZF,  // fast
+	GSCOMPRESSION_ZLIB, // dense, needs HAVE_ZLIB
+	NUMGSCOMPRESSIONS
+} gamestatecompression_t;
+
 // Server to client packet
 // this packet is too large
 typedef struct
@@ -156,6 +165,8 @@ typedef struct
 	UINT8 modifiedgame;
 
 	char server_context[8]; // Unique context id, generated at server startup.
+
+	UINT8 gamestatecompression; // gamestatecompression_t of the gamestates sent to this client
 } ATTRPACK serverconfig_pak;
 
 typedef struct
@@ -377,6 +388,7 @@ extern tic_t servermaxping;
 extern consvar_t cv_netticbuffer, cv_allownewplayer, cv_joinnextround, cv_maxplayers, cv_joindelay, cv_rejointimeout;
 extern consvar_t cv_resynchattempts, cv_blamecfail;
 extern consvar_t cv_maxsend, cv_noticedownload, cv_downloadspeed;
+extern consvar_t cv_gamestatecompression, cv_gamestatecompressionlevel;
 
 // Used in d_net, the only dependence
 tic_t ExpandTics(INT32 low, INT32 node);
@@ -245,6 +245,8 @@ static void D_Display(void)
 	if (nodrawers)
 		return; // for comparative timing/profiling
 
+	ps_hudpatchdraws = ps_hudpatchreuses = 0;
+
 	// Lactozilla: Switching renderers works by checking
 	// if the game has to do it right when the frame
 	// needs to render. If so, five things will happen:
@@ -181,6 +181,7 @@ void D_ParseFileneeded(INT32 fileneedednum_parm, UINT8 *fileneededstr)
 		fileneeded[i].willsend = (UINT8)(filestatus >> 4);
 		fileneeded[i].totalsize = READUINT32(p); // The four next bytes are the file size
 		fileneeded[i].file = NULL; // The file isn't open yet
+		fileneeded[i].md5ctx = NULL;
 		READSTRINGN(p, fileneeded[i].filename, MAX_WADPATH); // The next bytes are the file name
 		READMEM(p, fileneeded[i].md5sum, 16); // The last 16 bytes are the file checksum
 	}
@@ -197,6 +198,7 @@ void CL_PrepareDownloadSaveGame(const char *tmpsave)
 	fileneeded[0].justdownloaded = false;
 	fileneeded[0].totalsize = UINT32_MAX;
 	fileneeded[0].file = NULL;
+	fileneeded[0].md5ctx = NULL;
 	memset(fileneeded[0].md5sum, 0, 16);
 	strcpy(fileneeded[0].filename, tmpsave);
 }
@@ -686,6 +688,7 @@ void CL_PrepareDownloadLuaFile(void)
 	fileneeded[0].justdownloaded = false;
 	fileneeded[0].totalsize = UINT32_MAX;
 	fileneeded[0].file = NULL;
+	fileneeded[0].md5ctx = NULL;
 	memset(fileneeded[0].md5sum, 0, 16);
 	strcpy(fileneeded[0].filename, luafiletransfers->realfilename);
 
@@ -1225,6 +1228,53 @@ void FileReceiveTicker(void)
 	}
 }
 
+#ifndef NOMD5
+/** Hashes a fragment of a download as it arrives, so that the file's MD5
+  * is ready when the last fragment is in. Fragments past a gap wait on disk
+  * until the gap is filled, and are then read back.
+  *
+  * \param file The file being downloaded.
+  * \param fragmentpos Position of the fragment in the file.
+  * \param data The fragment, as it came in the packet.
+  * \param size Size of the fragment.
+  */
+static void CL_HashFileFragment(fileneeded_t *file, UINT32 fragmentpos, const UINT8 *data, size_t size)
+{
+	UINT8 buffer[1024];
+
+	if (fragmentpos == file->md5position)
+	{
+		md5_process_bytes(data, size, file->md5ctx);
+		file->md5position += (UINT32)size;
+	}
+
+	// Catch up with fragments that arrived early, or before a resume
+	while (file->md5position < file->totalsize
+		&& file->receivedfragments[file->md5position / file->fragmentsize])
+	{
+		size_t len = min(file->fragmentsize, file->totalsize - file->md5position);
+
+		fseek(file->file, file->md5position, SEEK_SET);
+		while (len)
+		{
+			size_t chunk = min(len, sizeof buffer);
+
+			if (fread(buffer, 1, chunk, file->file) != chunk)
+			{
+				// Leave it to W_InitFile
+				free(file->md5ctx);
+				file->md5ctx = NULL;
+				return;
+			}
+
+			md5_process_bytes(buffer, chunk, file->md5ctx);
+			file->md5position += (UINT32)chunk;
+			len -= chunk;
+		}
+	}
+}
+#endif
+
 void PT_FileFragment(void)
 {
 	INT32 filenum = netbuffer->u.filetxpak.fileid;
@@ -1286,7 +1336,7 @@ void PT_FileFragment(void)
 		{
 			CL_AbortDownloadResume();
 
-			file->file = fopen(filename, "wb");
+			file->file = fopen(filename, "w+b"); // Readable, for CL_HashFileFragment
 			if (!file->file)
 				I_Error("Can't create file %s: %s", filename, strerror(errno));
 
@@ -1301,6 +1351,15 @@ void PT_FileFragment(void)
 				I_Error("FileSendTicker: No more memory\n");
 		}
 
+#ifndef NOMD5
+		// File 0 is the gamestate or a Lua file, which come without an MD5
+		if (filenum != 0 && fragmentsize && (file->md5ctx = malloc(sizeof (*file->md5ctx))) != NULL)
+		{
+			md5_init_ctx(file->md5ctx);
+			file->md5position = 0;
+		}
+#endif
+
 		lasttimeackpacketsent = I_GetTime();
 	}
 
@@ -1321,11 +1380,32 @@ void PT_FileFragment(void)
 				I_Error("Can't write to %s: %s\n",filename, M_FileError(file->file));
 			file->currentsize += boundedfragmentsize;
 
+#ifndef NOMD5
+			if (file->md5ctx)
+				CL_HashFileFragment(file, fragmentpos, netbuffer->u.filetxpak.data, boundedfragmentsize);
+#endif
+
 			AddFragmentToAckPacket(file->ackpacket, file->iteration, fragmentpos / fragmentsize, filenum);
 
 			// Finished?
 			if (file->currentsize == file->totalsize)
 			{
+#ifndef NOMD5
+				UINT8 md5sum[16];
+				boolean hashed = false;
+
+				if (file->md5ctx)
+				{
+					if (file->md5position == file->totalsize)
+					{
+						md5_finish_ctx(file->md5ctx, md5sum);
+						hashed = true;
+					}
+					free(file->md5ctx);
+					file->md5ctx = NULL;
+				}
+#endif
+
 				fclose(file->file);
 				file->file = NULL;
 				free(file->receivedfragments);
@@ -1335,6 +1415,30 @@ void PT_FileFragment(void)
 				CONS_Printf(M_GetText("Downloading %s...(done)\n"),
 					filename);
 
+#ifndef NOMD5
+				// Already hashed, so checking the download is free
+				if (hashed && memcmp(md5sum, file->md5sum, 16))
+				{
+					char name[MAX_WADPATH], message[MAX_WADPATH + 64];
+
+					CONS_Alert(CONS_ERROR, M_GetText("%s was corrupted during download\n"), filename);
+					remove(filename);
+					file->status = FS_MD5SUMBAD;
+
+					// It would only fail to load, so stop joining instead
+					strlcpy(name, filename, sizeof name);
+					nameonly(name);
+					snprintf(message, sizeof message, M_GetText("%s\nwas corrupted during download.\n\nPress ESC\n"), name);
+					D_QuitNetGame();
+					CL_Reset();
+					D_StartTitle();
+					M_StartMessage(message, NULL, MM_NOTHING);
+					return;
+				}
+				else if (hashed)
+					W_AddFileMD5(filename, md5sum);
+#endif
+
 				// Tell the server we have received the file
 				netbuffer->packettype = PT_FILERECEIVED;
 				netbuffer->u.filereceived = filenum;
@@ -1420,6 +1524,8 @@ void CloseNetFile(void)
 		{
 			fclose(fileneeded[i].file);
 			free(fileneeded[i].ackpacket);
+			free(fileneeded[i].md5ctx); // A resumed download is hashed from the start
+			fileneeded[i].md5ctx = NULL;
 
 			if (!pauseddownload && i != 0) // 0 is either srb2.srb or the gamestate...
 			{
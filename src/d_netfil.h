@@ -52,6 +52,8 @@ typedef struct
 	UINT32 currentsize;
 	UINT32 totalsize;
 	UINT32 ackresendposition; // Used when resuming downloads
+	struct md5_ctx *md5ctx; // MD5 of the fragments received so far, in order
+	UINT32 md5position; // Bytes hashed into md5ctx
 } fileneeded_t;
 
 extern INT32 fileneedednum;
@@ -260,8 +260,8 @@ size_t strlcpy(char *dst, const char *src, size_t siz);
 
 	#define FUNCNOINLINE __attribute__((noinline))
 
-	#if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 4) // >= GCC 4.4
-		#ifdef __i386__ // i386 only
+	#if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 4) || defined (__clang__) // >= GCC 4.4
+		#if defined (__i386__) || defined (__x86_64__) // x86 only
 			#define FUNCTARGET(X)  __attribute__ ((__target__ (X)))
 		#endif
 	#endif
@@ -273,9 +273,14 @@ size_t strlcpy(char *dst, const char *src, size_t siz);
 	#endif
 
 	#define ATTRUNUSED __attribute__((unused))
+
+	#ifndef __MINGW32__ // MinGW emulates thread-local storage through function calls
+		#define ATTRTHREADLOCAL __thread
+	#endif
 #elif defined (_MSC_VER)
 	#define ATTRNORETURN __declspec(noreturn)
 	#define ATTRINLINE __forceinline
+	#define ATTRTHREADLOCAL __declspec(thread)
 	#if _MSC_VER > 1200 // >= MSVC 6.0
 		#define ATTRNOINLINE __declspec(noinline)
 	#endif
@@ -11,6 +11,19 @@ UINT32 I_GetFreeMem(UINT32 *total)
 	return 0;
 }
 
+void *I_MapFile(FILE *handle, size_t size)
+{
+	(void)handle;
+	(void)size;
+	return NULL;
+}
+
+void I_UnmapFile(void *ptr, size_t size)
+{
+	(void)ptr;
+	(void)size;
+}
+
 tic_t I_GetTime(void)
 {
 	return 0;
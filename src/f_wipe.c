@@ -18,6 +18,7 @@
 
 #include "r_state.h" // fadecolormap
 #include "r_draw.h" // transtable
+#include "screen.h" // R_AVX2
 #include "p_pspr.h" // tr_transxxx
 #include "p_local.h"
 #include "st_stuff.h"
@@ -240,7 +241,7 @@ static void F_DoWipe(fademask_t *fademask)
 		// rectangle draw hints
 		UINT32 draw_linestart, draw_rowstart;
 		UINT32 draw_lineend,   draw_rowend;
-		UINT32 draw_linestogo, draw_rowstogo;
+		UINT32 draw_linestogo;
 
 		// rectangle coordinates, etc.
 		UINT16* scrxpos = (UINT16*)malloc((fademask->width + 1)  * sizeof(UINT16));
@@ -298,14 +299,7 @@ static void F_DoWipe(fademask_t *fademask)
 				// DRAWING LOOP
 				while (draw_linestogo--)
 				{
-					w = w_base + relativepos;
-					s = s_base + relativepos;
-					e = e_base + relativepos;
-					draw_rowstogo = draw_rowend - draw_rowstart;
-
-					while (draw_rowstogo--)
-						*w++ = transtbl[ ( *e++ << 8 ) + *s++ ];
-
+					V_BlendBytes(w_base+relativepos, e_base+relativepos, s_base+relativepos, draw_rowend-draw_rowstart, transtbl);
 					relativepos += vid.width;
 				}
 				// END DRAWING LOOP
@@ -342,7 +336,7 @@ static void F_DoColormapWipe(fademask_t *fademask, UINT8 *colormap)
 		// rectangle draw hints
 		UINT32 draw_linestart, draw_rowstart;
 		UINT32 draw_lineend,   draw_rowend;
-		UINT32 draw_linestogo, draw_rowstogo;
+		UINT32 draw_linestogo;
 
 		// rectangle coordinates, etc.
 		UINT16* scrxpos = (UINT16*)malloc((fademask->width + 1)  * sizeof(UINT16));
@@ -403,14 +397,7 @@ static void F_DoColormapWipe(fademask_t *fademask, UINT8 *colormap)
 				// DRAWING LOOP
 				while (draw_linestogo--)
 				{
-					w = w_base + relativepos;
-					s = s_base + relativepos;
-					e = e_base + relativepos;
-					draw_rowstogo = draw_rowend - draw_rowstart;
-
-					while (draw_rowstogo--)
-						*w++ = transtbl[*e++];
-
+					V_MapBytes(w_base+relativepos, e_base+relativepos, draw_rowend-draw_rowstart, transtbl);
 					relativepos += vid.width;
 				}
 				// END DRAWING LOOP
@@ -665,3 +652,220 @@ boolean F_WipeExists(UINT8 wipetype)
 	return !(lumpnum == LUMPERROR);
 #endif
 }
+
+#ifndef NOWIPE
+#define WIPEBENCHRUNS 5
+
+// Size of the synthetic screens when there is no video mode,
+// such as on a dedicated server
+#define WIPEBENCHWIDTH 1280
+#define WIPEBENCHHEIGHT 800
+
+// Every version of the byte passes the wipes and fades are drawn with
+static const struct
+{
+	const char *name;
+	void (*mapbytes)(UINT8 *dest, const UINT8 *src, size_t count, const UINT8 *table);
+	void (*blendbytes)(UINT8 *dest, const UINT8 *fg, const UINT8 *bg, size_t count, const UINT8 *transtable);
+} wipebenchversions[] = {
+	{"C", V_MapBytes_C, V_BlendBytes_C},
+#ifdef SIMDSPANS
+	{"AVX2", V_MapBytes_AVX2, V_BlendBytes_AVX2},
+#endif
+};
+
+// What is timed
+enum
+{
+	WIPEBENCH_MASK, // F_DoWipe
+	WIPEBENCH_COLORMAP, // F_DoColormapWipe
+	WIPEBENCH_FADE, // V_DrawFadeScreen
+	NUMWIPEBENCHES
+};
+
+static const char *wipebenchnames[NUMWIPEBENCHES] = {"Mask wipe", "Colormap wipe", "Screen fade"};
+
+static UINT32 wipebenchseed;
+static INT32 wipebenchwidth, wipebenchheight;
+
+static UINT32 F_WipeBenchRandom(void)
+{
+	wipebenchseed = wipebenchseed * 1103515245 + 12345;
+	return wipebenchseed >> 8;
+}
+
+// Draws every frame of a wipe or fade over the synthetic screens,
+// and returns how long it took, or a checksum of every frame it drew.
+static UINT32 F_RunWipeBench(INT32 bench, fademask_t *fm, const UINT8 *ramp, INT32 frames, boolean checksum)
+{
+	const size_t screensize = (size_t)wipebenchwidth * wipebenchheight;
+	const INT32 width = vid.width, height = vid.height;
+	precise_t time;
+	UINT32 sum = 2166136261u;
+	INT32 frame;
+	size_t i;
+
+	// The wipes draw at the size of the video mode
+	vid.width = wipebenchwidth;
+	vid.height = wipebenchheight;
+
+	// The fade works on what is already on the screen,
+	// so every run has to start from the same picture
+	M_Memcpy(wipe_scr, wipe_scr_start, screensize);
+
+	time = I_GetPreciseTime();
+
+	for (frame = 0; frame < frames; frame++)
+	{
+		if (bench == WIPEBENCH_FADE)
+			V_MapBytes(wipe_scr, wipe_scr, screensize, colormaps + (frame % 32) * 256);
+		else
+		{
+			// Sweep the mask across the screen, so that each frame
+			// has some rectangles copied and some blended
+			const UINT8 maskrange = (bench == WIPEBENCH_COLORMAP) ? FADECOLORMAPROWS+1 : 11;
+			for (i = 0; i < fm->size; i++)
+				fm->mask[i] = (UINT8)((ramp[i] + frame) % maskrange);
+
+			if (bench == WIPEBENCH_COLORMAP)
+				F_DoColormapWipe(fm, fadecolormap);
+			else
+				F_DoWipe(fm);
+		}
+
+		if (checksum)
+		{
+			for (i = 0; i < screensize; i++)
+				sum = (sum ^ wipe_scr[i]) * 16777619u;
+		}
+	}
+
+	time = I_GetPreciseTime() - time;
+
+	vid.width = width;
+	vid.height = height;
+
+	return checksum ? sum : (UINT32)I_PreciseToMicros(time);
+}
+#endif
+
+/**	\brief Times every version of the byte passes on the wipes and the
+	full-screen fade, drawn into synthetic screens instead of the real one,
+	and checks that they all draw the same pixels as the C versions.
+*/
+void Command_Wipebench_f(void)
+{
+#ifdef NOWIPE
+	CONS_Printf(M_GetText("Screen wipes are not available in this build.\n"));
+#else
+	void (*mapbytes)(UINT8 *, const UINT8 *, size_t, const UINT8 *) = V_MapBytes;
+	void (*blendbytes)(UINT8 *, const UINT8 *, const UINT8 *, size_t, const UINT8 *) = V_BlendBytes;
+	UINT8 *scr = wipe_scr, *scrstart = wipe_scr_start, *scrend = wipe_scr_end;
+	wipestyleflags_t flags = wipestyleflags;
+	fademask_t fm;
+	UINT8 *ramp;
+	size_t screensize, i, v;
+	INT32 frames, bench, run;
+
+	if (!fadecolormap || !colormaps)
+	{
+		CONS_Printf(M_GetText("wipebench [frames]: compare how long each version of the Software renderer's wipes and fades takes to draw the same frames\n"));
+		return;
+	}
+
+	frames = (COM_Argc() > 1) ? atoi(COM_Argv(1)) : 100;
+	if (frames < 1)
+		frames = 1;
+
+	if (vid.width && vid.height)
+	{
+		wipebenchwidth = vid.width;
+		wipebenchheight = vid.height;
+	}
+	else
+	{
+		wipebenchwidth = WIPEBENCHWIDTH;
+		wipebenchheight = WIPEBENCHHEIGHT;
+	}
+
+	screensize = (size_t)wipebenchwidth * wipebenchheight;
+	wipe_scr = Z_Malloc(screensize, PU_STATIC, NULL);
+	wipe_scr_start = Z_Malloc(screensize, PU_STATIC, NULL);
+	wipe_scr_end = Z_Malloc(screensize, PU_STATIC, NULL);
+
+	// Noisy screens, so that the table lookups go everywhere
+	wipebenchseed = 1;
+	for (i = 0; i < screensize; i++)
+	{
+		wipe_scr_start[i] = (UINT8)F_WipeBenchRandom();
+		wipe_scr_end[i] = (UINT8)F_WipeBenchRandom();
+	}
+
+	// The same 160x100 mask size the stock wipes use
+	fm.width = 160;
+	fm.height = 100;
+	fm.size = fm.width * fm.height;
+	fm.mask = Z_Malloc(fm.size, PU_STATIC, NULL);
+	fm.xscale = FixedDiv(wipebenchwidth<<FRACBITS, fm.width<<FRACBITS);
+	fm.yscale = FixedDiv(wipebenchheight<<FRACBITS, fm.height<<FRACBITS);
+
+	ramp = Z_Malloc(fm.size, PU_STATIC, NULL);
+	for (i = 0; i < fm.size; i++)
+		ramp[i] = (UINT8)((i % fm.width) / 4 + (i / fm.width) / 4 + (F_WipeBenchRandom() & 3));
+
+	wipestyleflags = WSF_FADEOUT;
+
+	CONS_Printf(M_GetText("Drawing times of %d frames at %dx%d, best of %d runs (* is in use):\n"), frames, wipebenchwidth, wipebenchheight, WIPEBENCHRUNS);
+	for (bench = 0; bench < NUMWIPEBENCHES; bench++)
+	{
+		char line[256];
+		size_t len;
+		UINT32 reference = 0;
+
+		len = snprintf(line, sizeof line, "%s:", wipebenchnames[bench]);
+
+		for (v = 0; v < sizeof wipebenchversions / sizeof *wipebenchversions; v++)
+		{
+			UINT32 time = UINT32_MAX, sum;
+
+#ifdef SIMDSPANS
+			if (wipebenchversions[v].mapbytes == V_MapBytes_AVX2 && !R_AVX2)
+				continue;
+#endif
+			if (len >= sizeof line)
+				continue;
+
+			V_MapBytes = wipebenchversions[v].mapbytes;
+			V_BlendBytes = wipebenchversions[v].blendbytes;
+
+			// Keep the best of a few runs, to leave out whatever else the system was doing
+			for (run = 0; run < WIPEBENCHRUNS; run++)
+				time = min(time, F_RunWipeBench(bench, &fm, ramp, frames, false));
+			sum = F_RunWipeBench(bench, &fm, ramp, frames, true);
+
+			if (v == 0)
+				reference = sum;
+
+			len += snprintf(line + len, sizeof line - len, " %s%s %u us%s", wipebenchversions[v].name,
+				(wipebenchversions[v].mapbytes == mapbytes) ? "*" : "", time,
+				(sum == reference) ? "" : M_GetText(" \x85(differs from C!)\x80"));
+		}
+
+		CONS_Printf("%s\n", line);
+	}
+
+	V_MapBytes = mapbytes;
+	V_BlendBytes = blendbytes;
+	wipestyleflags = flags;
+
+	Z_Free(ramp);
+	Z_Free(fm.mask);
+	Z_Free(wipe_scr_end);
+	Z_Free(wipe_scr_start);
+	Z_Free(wipe_scr);
+
+	wipe_scr = scr;
+	wipe_scr_start = scrstart;
+	wipe_scr_end = scrend;
+#endif
+}
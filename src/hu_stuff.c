@@ -184,6 +184,8 @@ void HU_LoadGraphics(void)
 	char buffer[9];
 	INT32 i, j;
 
+	V_InvalidateHUDElements();
+
 	if (dedicated)
 		return;
 
@@ -2290,11 +2292,86 @@ void HU_drawPing(INT32 x, INT32 y, UINT32 ping, boolean notext, INT32 flags)
 //
 // HU_DrawTabRankings
 //
+// What a row of the rankings is drawn from
+typedef struct
+{
+	INT32 x, y;
+	INT32 nameflags; // -1 while the name blinks out
+	UINT32 ping;
+	INT32 drawping;
+	INT32 emeralds; // -1 for none
+	INT32 greycheck;
+	INT32 facetrans; // The super face is never translucent
+	patch_t *face;
+	UINT8 *colormap; // NULL for the plain face
+	INT32 skin, color;
+	INT32 lives; // INT32_MIN if not shown
+	INT32 tagit, exiting;
+	INT32 countflags;
+	char count[16];
+	const char *name;
+} tabrow_t;
+
+// Each row of the rankings is only drawn again when it changes
+static hudelement_t tabrowelements[9];
+
+static void HU_DrawTabRankingsRow(void *userdata)
+{
+	const tabrow_t *row = userdata;
+	INT32 x = row->x, y = row->y;
+
+	if (row->drawping)
+		HU_drawPing(x + 253, y, row->ping, false, 0);
+
+	if (row->nameflags != -1)
+		V_DrawString(x + 20, y, row->nameflags, row->name);
+
+	// Draw emeralds
+	if (row->emeralds != -1)
+		HU_DrawEmeralds(x-12,y+2,row->emeralds);
+
+	if (row->greycheck)
+		V_DrawSmallTranslucentPatch (x, y-4, V_80TRANS, livesback);
+	else
+		V_DrawSmallScaledPatch (x, y-4, 0, livesback);
+
+	if (row->colormap)
+	{
+		if (row->facetrans)
+			V_DrawSmallTranslucentMappedPatch (x, y-4, V_80TRANS, row->face, row->colormap);
+		else
+			V_DrawSmallMappedPatch (x, y-4, 0, row->face, row->colormap);
+	}
+	else
+	{
+		if (row->facetrans)
+			V_DrawSmallTranslucentPatch(x, y-4, V_80TRANS, row->face);
+		else
+			V_DrawSmallScaledPatch(x, y-4, 0, row->face);
+	}
+
+	if (row->lives != INT32_MIN) //show lives
+		V_DrawRightAlignedString(x, y+4, V_ALLOWLOWERCASE|(row->greycheck ? V_60TRANS : 0), va("%dx", row->lives));
+	else if (row->tagit)
+	{
+		if (row->greycheck)
+			V_DrawSmallTranslucentPatch(x-32, y-4, V_60TRANS, tagico);
+		else
+			V_DrawSmallScaledPatch(x-32, y-4, 0, tagico);
+	}
+
+	if (row->exiting)
+		V_DrawSmallScaledPatch(x - exiticon->width/2 - 1, y-3, 0, exiticon);
+
+	V_DrawRightAlignedString(x+240, y, row->countflags, row->count);
+}
+
 void HU_DrawTabRankings(INT32 x, INT32 y, playersort_t *tab, INT32 scorelines, INT32 whiteplayer)
 {
 	INT32 i;
-	const UINT8 *colormap;
 	boolean greycheck, supercheck;
+	tabrow_t row;
+	UINT32 key;
 
 	//this function is designed for 9 or less score lines only
 	I_Assert(scorelines <= 9);
@@ -2309,91 +2386,84 @@ void HU_DrawTabRankings(INT32 x, INT32 y, playersort_t *tab, INT32 scorelines, I
 		greycheck = greycheckdef;
 		supercheck = supercheckdef;
 
+		memset(&row, 0, sizeof(row));
+		row.x = x;
+		row.y = y;
+		row.name = tab[i].name;
+		row.greycheck = greycheck;
+
 		if (!splitscreen) // don't draw it on splitscreen,
 		{
 			if (tab[i].num != serverplayer)
-				HU_drawPing(x + 253, y, players[tab[i].num].quittime ? UINT32_MAX : playerpingtable[tab[i].num], false, 0);
+			{
+				row.drawping = true;
+				row.ping = players[tab[i].num].quittime ? UINT32_MAX : playerpingtable[tab[i].num];
+			}
 			//else
 			//	V_DrawSmallString(x+ 246, y+4, V_YELLOWMAP, "SERVER");
 		}
 
 		if (!players[tab[i].num].quittime || (leveltime / (TICRATE/2) & 1))
-			V_DrawString(x + 20, y,
-		                 ((tab[i].num == whiteplayer) ? V_YELLOWMAP : 0)
-		                 | (greycheck ? V_60TRANS : 0)
-		                 | V_ALLOWLOWERCASE, tab[i].name);
+			row.nameflags = ((tab[i].num == whiteplayer) ? V_YELLOWMAP : 0)
+		                  | (greycheck ? V_60TRANS : 0)
+		                  | V_ALLOWLOWERCASE;
+		else
+			row.nameflags = -1;
 
-		// Draw emeralds
 		if (players[tab[i].num].powers[pw_invulnerability] && (players[tab[i].num].powers[pw_invulnerability] == players[tab[i].num].powers[pw_sneakers]) && ((leveltime/7) & 1))
-			HU_DrawEmeralds(x-12,y+2,255);
+			row.emeralds = 255;
 		else if (!players[tab[i].num].powers[pw_super]
 			|| ((leveltime/7) & 1))
-		{
-			HU_DrawEmeralds(x-12,y+2,tab[i].emeralds);
-		}
-
-		if (greycheck)
-			V_DrawSmallTranslucentPatch (x, y-4, V_80TRANS, livesback);
+			row.emeralds = tab[i].emeralds;
 		else
-			V_DrawSmallScaledPatch (x, y-4, 0, livesback);
+			row.emeralds = -1;
 
-		if (tab[i].color == 0)
-		{
-			colormap = colormaps;
-			if (supercheck)
-				V_DrawSmallScaledPatch(x, y-4, 0, superprefix[players[tab[i].num].skin]);
-			else
-			{
-				if (greycheck)
-					V_DrawSmallTranslucentPatch(x, y-4, V_80TRANS, faceprefix[players[tab[i].num].skin]);
-				else
-					V_DrawSmallScaledPatch(x, y-4, 0, faceprefix[players[tab[i].num].skin]);
-			}
-		}
-		else
+		row.skin = players[tab[i].num].skin;
+		row.face = (supercheck ? superprefix : faceprefix)[row.skin];
+		row.facetrans = (greycheck && !supercheck);
+
+		if (tab[i].color != 0)
 		{
 			if (supercheck)
-			{
-				colormap = R_GetTranslationColormap(players[tab[i].num].skin, players[tab[i].num].mo->color, GTC_CACHE);
-				V_DrawSmallMappedPatch (x, y-4, 0, superprefix[players[tab[i].num].skin], colormap);
-			}
+				row.color = players[tab[i].num].mo->color;
 			else
-			{
-				colormap = R_GetTranslationColormap(players[tab[i].num].skin, players[tab[i].num].mo ? players[tab[i].num].mo->color : tab[i].color, GTC_CACHE);
-				if (greycheck)
-					V_DrawSmallTranslucentMappedPatch (x, y-4, V_80TRANS, faceprefix[players[tab[i].num].skin], colormap);
-				else
-					V_DrawSmallMappedPatch (x, y-4, 0, faceprefix[players[tab[i].num].skin], colormap);
-			}
+				row.color = players[tab[i].num].mo ? players[tab[i].num].mo->color : tab[i].color;
+			row.colormap = R_GetTranslationColormap(row.skin, row.color, GTC_CACHE);
 		}
 
 		if (G_GametypeUsesLives() && !(G_GametypeUsesCoopLives() && (cv_cooplives.value == 0 || cv_cooplives.value == 3)) && (players[tab[i].num].lives != INFLIVES)) //show lives
-			V_DrawRightAlignedString(x, y+4, V_ALLOWLOWERCASE|(greycheck ? V_60TRANS : 0), va("%dx", players[tab[i].num].lives));
-		else if (G_TagGametype() && players[tab[i].num].pflags & PF_TAGIT)
+			row.lives = players[tab[i].num].lives;
+		else
 		{
-			if (greycheck)
-				V_DrawSmallTranslucentPatch(x-32, y-4, V_60TRANS, tagico);
-			else
-				V_DrawSmallScaledPatch(x-32, y-4, 0, tagico);
+			row.lives = INT32_MIN;
+			row.tagit = (G_TagGametype() && players[tab[i].num].pflags & PF_TAGIT);
 		}
 
-		if (players[tab[i].num].exiting || (players[tab[i].num].pflags & PF_FINISHED))
-			V_DrawSmallScaledPatch(x - exiticon->width/2 - 1, y-3, 0, exiticon);
+		row.exiting = (players[tab[i].num].exiting || (players[tab[i].num].pflags & PF_FINISHED));
 
+		row.countflags = (greycheck ? V_60TRANS : 0);
 		if (gametyperankings[gametype] == GT_RACE)
 		{
 			if (circuitmap)
 			{
 				if (players[tab[i].num].exiting)
-					V_DrawRightAlignedString(x+240, y, 0, va("%i:%02i.%02i", G_TicsToMinutes(players[tab[i].num].realtime,true), G_TicsToSeconds(players[tab[i].num].realtime), G_TicsToCentiseconds(players[tab[i].num].realtime)));
+				{
+					row.countflags = 0;
+					snprintf(row.count, sizeof(row.count), "%i:%02i.%02i", G_TicsToMinutes(players[tab[i].num].realtime,true), G_TicsToSeconds(players[tab[i].num].realtime), G_TicsToCentiseconds(players[tab[i].num].realtime));
+				}
 				else
-					V_DrawRightAlignedString(x+240, y, (greycheck ? V_60TRANS : 0), va("%u", tab[i].count));
+					snprintf(row.count, sizeof(row.count), "%u", tab[i].count);
 			}
 			else
-				V_DrawRightAlignedString(x+240, y, (greycheck ? V_60TRANS : 0), va("%i:%02i.%02i", G_TicsToMinutes(tab[i].count,true), G_TicsToSeconds(tab[i].count), G_TicsToCentiseconds(tab[i].count)));
+				snprintf(row.count, sizeof(row.count), "%i:%02i.%02i", G_TicsToMinutes(tab[i].count,true), G_TicsToSeconds(tab[i].count), G_TicsToCentiseconds(tab[i].count));
 		}
 		else
-			V_DrawRightAlignedString(x+240, y, (greycheck ? V_60TRANS : 0), va("%u", tab[i].count));
+			snprintf(row.count, sizeof(row.count), "%u", tab[i].count);
+
+		key = V_HashHUDKey(0, &row, offsetof(tabrow_t, name));
+		key = V_HashHUDKey(key, row.name, strlen(row.name));
+
+		V_DrawHUDElement(&tabrowelements[i], key, HU_DrawTabRankingsRow, &row);
 
 		y += 16;
 	}
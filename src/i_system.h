@@ -42,6 +42,19 @@ extern UINT8 keyboard_started;
 */
 UINT32 I_GetFreeMem(UINT32 *total);
 
+/**	\brief	Maps a file in memory, read-only
+
+	\param	handle	the open file
+	\param	size	size of the file
+
+	\return	the start of the mapping, or NULL if the file can't be mapped
+*/
+void *I_MapFile(FILE *handle, size_t size);
+
+/**	\brief	Unmaps a file mapped by I_MapFile
+*/
+void I_UnmapFile(void *ptr, size_t size);
+
 /**	\brief  Called by D_SRB2Loop, returns current time in tics.
 */
 tic_t I_GetTime(void);
@@ -270,6 +283,7 @@ typedef struct {
 	int PPCMM64    : 1; ///< PowerPC Movemem 64bit ok?
 	int ALPHAbyte  : 1; ///< ?
 	int PAE        : 1; ///< Physical Address Extension
+	int AVX2       : 1; ///< AVX2 features
 	int CPUs       : 8;
 } CPUInfoFlags;
 
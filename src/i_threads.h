@@ -24,6 +24,9 @@ void      I_stop_threads  (void);
 
 void      I_spawn_thread (const char *name, I_thread_fn, void *userdata);
 
+/* number of logical CPU cores */
+int       I_cpu_count (void);
+
 /* check in your thread whether to return early */
 int       I_thread_is_stopped (void);
 
@@ -676,9 +676,11 @@ static int sector_set(lua_State *L)
 	}
 	case sector_floorpic:
 		sector->floorpic = P_AddLevelFlatRuntime(luaL_checkstring(L, 3));
+		geometrychanges++;
 		break;
 	case sector_ceilingpic:
 		sector->ceilingpic = P_AddLevelFlatRuntime(luaL_checkstring(L, 3));
+		geometrychanges++;
 		break;
 	case sector_lightlevel:
 		sector->lightlevel = (INT16)luaL_checkinteger(L, 3);
@@ -1030,9 +1032,11 @@ static int side_set(lua_State *L)
 		break;
 	case side_toptexture:
 		side->toptexture = luaL_checkinteger(L, 3);
+		geometrychanges++;
 		break;
 	case side_bottomtexture:
 		side->bottomtexture = luaL_checkinteger(L, 3);
+		geometrychanges++;
 		break;
 	case side_midtexture:
 		side->midtexture = luaL_checkinteger(L, 3);
@@ -2020,6 +2024,7 @@ static int slope_set(lua_State *L)
 		P_CalculateSlopeNormal(slope);
 		break;
 	}
+	geometrychanges++;
 	return 0;
 }
 
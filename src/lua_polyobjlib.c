@@ -14,6 +14,7 @@
 #include "fastcmp.h"
 #include "p_local.h"
 #include "p_polyobj.h"
+#include "r_state.h" // geometrychanges
 #include "lua_script.h"
 #include "lua_libs.h"
 #include "lua_hud.h" // hud_running errors
@@ -353,6 +354,7 @@ static int polyobj_set(lua_State *L)
 		break;
 	case polyobj_flags:
 		polyobj->flags = luaL_checkinteger(L, 3);
+		geometrychanges++;
 		break;
 	case polyobj_translucency:
 		polyobj->translucency = luaL_checkinteger(L, 3);
@@ -805,6 +805,45 @@ void LUA_InvalidateUserdata(void *data)
 	lua_pop(gL, 1); // pop LREG_VALID
 }
 
+// Invalidate every userdata for which func returns true,
+// for memory that is about to be freed in bulk.
+void LUA_InvalidateUserdataIf(boolean (*func)(void *data))
+{
+	void **userdata;
+	if (!gL)
+		return;
+
+	lua_getfield(gL, LUA_REGISTRYINDEX, LREG_VALID);
+	I_Assert(lua_istable(gL, -1));
+	lua_getfield(gL, LUA_REGISTRYINDEX, LREG_EXTVARS);
+	I_Assert(lua_istable(gL, -1));
+
+	lua_pushnil(gL);
+	while (lua_next(gL, -3))
+	{
+		// key (the data's pointer) at -2, userdata at -1
+		if (func(lua_touserdata(gL, -2)))
+		{
+			// invalidate the userdata
+			userdata = lua_touserdata(gL, -1);
+			*userdata = NULL;
+
+			// nullify any additional data
+			lua_pushvalue(gL, -2);
+			lua_pushnil(gL);
+			lua_rawset(gL, -5); // LREG_EXTVARS
+
+			// remove it from the registry (clearing fields is fine while traversing)
+			lua_pushvalue(gL, -2);
+			lua_pushnil(gL);
+			lua_rawset(gL, -6); // LREG_VALID
+		}
+		lua_pop(gL, 1); // pop the userdata, keep the key for lua_next
+	}
+
+	lua_pop(gL, 2); // pop LREG_EXTVARS and LREG_VALID
+}
+
 // Invalidate level data arrays
 void LUA_InvalidateLevel(void)
 {
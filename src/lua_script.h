@@ -91,6 +91,7 @@ void LUA_PushUserdata(lua_State *L, void *data, const char *meta);
 lpushed_t LUA_RawPushUserdata(lua_State *L, void *data);
 
 void LUA_InvalidateUserdata(void *data);
+void LUA_InvalidateUserdataIf(boolean (*func)(void *data));
 
 void LUA_InvalidateLevel(void);
 void LUA_InvalidateMapthings(void);
@@ -426,6 +426,18 @@ void FIL_ForceExtension(char *path, const char *extension)
 	strcat(path, extension);
 }
 
+/** Checks that a file name given to a command can't
+  * reach outside of the folder it is put in.
+  *
+  * \param name File name to check.
+  * \return False if it is empty, or has a path separator,
+  *         a drive letter or "..", otherwise true.
+  */
+boolean FIL_IsPlainFileName(const char *name)
+{
+	return (*name && !strpbrk(name, "/\\:") && !strstr(name, ".."));
+}
+
 /** Checks if a filename extension is found.
   * Lump names do not contain dots.
   *
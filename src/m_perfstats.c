@@ -52,6 +52,8 @@ precise_t ps_thlist_times[NUM_THINKERLISTS];
 
 int ps_checkposition_calls = 0;
 
+int ps_checksight_calls = 0;
+
 precise_t ps_lua_thinkframe_time = 0;
 int ps_lua_mobjhooks = 0;
 
@@ -147,6 +149,79 @@ static void M_DrawPerfCount(perfstatcol_t *col)
 	M_DrawPerfString(col, PERF_COUNT);
 }
 
+// Copies rows after the first count rows of dest, up to their terminator,
+// and returns how many rows dest has now.
+static INT32 M_AppendRows(perfstatrow_t *dest, INT32 count, const perfstatrow_t *rows)
+{
+	for (; rows->lores_label; rows++)
+		dest[count++] = *rows;
+
+	dest[count].lores_label = NULL;
+	return count;
+}
+
+// Fills the rows showing how long each drawing thread took,
+// and how many commands it drew.
+static void M_SetDrawThreadRows(perfstatcol_t *time_col, perfstatcol_t *cmds_col)
+{
+	static char labels[MAXDRAWTHREADS][2][16];
+	INT32 i;
+
+	for (i = 0; i < ps_sw_numdrawthreads; i++)
+	{
+		snprintf(labels[i][0], sizeof labels[i][0], "thrd%-3d", i + 1);
+		snprintf(labels[i][1], sizeof labels[i][1], "%-13s", va("Thread %d:", i + 1));
+
+		time_col->rows[i].lores_label = cmds_col->rows[i + 1].lores_label = labels[i][0];
+		time_col->rows[i].hires_label = cmds_col->rows[i + 1].hires_label = labels[i][1];
+		time_col->rows[i].value = &ps_sw_drawthreadtime[i];
+		cmds_col->rows[i + 1].value = &ps_sw_drawthreadcmds[i];
+	}
+
+	time_col->rows[i].lores_label = cmds_col->rows[i + 1].lores_label = NULL;
+
+	cmds_col->rows[0].lores_label = "drwcmds";
+	cmds_col->rows[0].hires_label = "Commands:   ";
+	cmds_col->rows[0].value = &ps_sw_numdrawcmds;
+}
+
+// Fills the rows showing how long the BSP traversal and sprite clipping
+// of each portal took, and how many pixels could be seen through it.
+// Its planes and masked drawing are counted with the rest of the view's.
+static void M_SetPortalRows(perfstatcol_t *time_col, perfstatcol_t *area_col)
+{
+	static char labels[MAXPORTALSTATS][4][16];
+	INT32 i, numportals = min(ps_sw_numportals, MAXPORTALSTATS);
+
+	for (i = 0; i < numportals; i++)
+	{
+		snprintf(labels[i][0], sizeof labels[i][0], "pbsp%-3d", i + 1);
+		snprintf(labels[i][1], sizeof labels[i][1], "%-13s", va("P%d BSP:", i + 1));
+		snprintf(labels[i][2], sizeof labels[i][2], "area%-3d", i + 1);
+		snprintf(labels[i][3], sizeof labels[i][3], "%-12s", va("P%d pixels:", i + 1));
+
+		time_col->rows[i].lores_label = labels[i][0];
+		time_col->rows[i].hires_label = labels[i][1];
+		time_col->rows[i].value = &ps_sw_portalbsptime[i];
+
+		area_col->rows[i + 3].lores_label = labels[i][2];
+		area_col->rows[i + 3].hires_label = labels[i][3];
+		area_col->rows[i + 3].value = &ps_sw_portalviewarea[i];
+	}
+
+	time_col->rows[i].lores_label = area_col->rows[i + 3].lores_label = NULL;
+
+	area_col->rows[0].lores_label = "portals";
+	area_col->rows[0].hires_label = "Portals:    ";
+	area_col->rows[0].value = &ps_sw_numportals;
+	area_col->rows[1].lores_label = "prtcull";
+	area_col->rows[1].hires_label = "Culled:     "; // Never rendered: nothing could be seen through them, or past portalbudget
+	area_col->rows[1].value = &ps_sw_portalsculled;
+	area_col->rows[2].lores_label = "prtmrge";
+	area_col->rows[2].hires_label = "Merged:     "; // Rendered along with another portal with the same viewpoint
+	area_col->rows[2].value = &ps_sw_portalsmerged;
+}
+
 static void M_DrawRenderStats(void)
 {
 	const boolean hires = M_HighResolution();
@@ -155,6 +230,8 @@ static void M_DrawRenderStats(void)
 
 	precise_t extrarendertime;
 
+	INT32 time_row, count_row = 10;
+
 	perfstatrow_t frametime_row[] = {
 		{"frmtime", "Frame time:    ", &ps_frametime},
 		{0}
@@ -182,10 +259,19 @@ static void M_DrawRenderStats(void)
 		{"portals", "Portals+Skybox:", &ps_sw_portaltime},
 		{"planes ", "R_DrawPlanes:  ", &ps_sw_planetime},
 		{"masked ", "R_DrawMasked:  ", &ps_sw_maskedtime},
+		{"sprsort", "  Sprite sort: ", &ps_sw_spritesorttime},
+		{"drwsort", "Draw sort:     ", &ps_sw_drawsorttime},
+		{"drwcmds", "Deferred draw: ", &ps_sw_drawtime},
 		{"other  ", "Other:         ", &extrarendertime},
 		{0}
 	};
 
+	perfstatrow_t drawthreadtime_row[MAXDRAWTHREADS+1];
+	perfstatrow_t drawthreadcmds_row[MAXDRAWTHREADS+2];
+
+	perfstatrow_t portaltime_row[MAXPORTALSTATS+1];
+	perfstatrow_t portalarea_row[MAXPORTALSTATS+4];
+
 	perfstatrow_t uiswaptime_row[] = {
 		{"ui     ", "UI render:     ", &ps_uitime},
 		{"finupdt", "I_FinishUpdate:", &ps_swaptime},
@@ -197,7 +283,7 @@ static void M_DrawRenderStats(void)
 		{0}
 	};
 
-	perfstatrow_t rendercalls_row[] = {
+	perfstatrow_t commoncalls_row[] = {
 		{"bspcall", "BSP calls:   ", &ps_numbspcalls},
 		{"sprites", "Sprites:     ", &ps_numsprites},
 		{"drwnode", "Drawnodes:   ", &ps_numdrawnodes},
@@ -205,6 +291,27 @@ static void M_DrawRenderStats(void)
 		{0}
 	};
 
+	perfstatrow_t softwarecalls_row[] = {
+		{"dsvisit", "Seg visits:  ", &ps_sw_drawsegvisits}, // Drawsegs looked at while clipping sprites
+		{"visplns", "Visplanes:   ", &ps_sw_numvisplanes},
+		{"plfinds", "Plane finds: ", &ps_sw_planefinds},
+		{"plprobe", "Plane probes:", &ps_sw_planeprobes}, // Visplanes R_FindPlane compared against
+		{"texgens", "Tex. builds: ", &ps_texturegens}, // Textures generated, or generated again after being freed
+		{0}
+	};
+
+	perfstatrow_t cachecalls_row[] = {
+		{"tranhit", "Trans. hits: ", &ps_translationhits}, // Translation colormaps found in the cache
+		{"tranmis", "Trans. miss: ", &ps_translationmisses},
+		{"hudpats", "HUD patches: ", &ps_hudpatchdraws}, // Patches rasterized by the HUD
+		{"hudreus", "HUD reused:  ", &ps_hudpatchreuses}, // Patches put back from cached HUD elements
+		{0}
+	};
+
+	perfstatrow_t rendercalls_row[sizeof commoncalls_row / sizeof *commoncalls_row
+		+ sizeof softwarecalls_row / sizeof *softwarecalls_row
+		+ sizeof cachecalls_row / sizeof *cachecalls_row];
+
 	perfstatrow_t batchtime_row[] = {
 		{"batsort", "Batch sort:  ", &ps_hw_batchsorttime},
 		{"batdraw", "Batch render:", &ps_hw_batchdrawtime},
@@ -242,6 +349,12 @@ static void M_DrawRenderStats(void)
 	perfstatcol_t     batchcount_col = {155, 200, V_PURPLEMAP,     batchcount_row};
 	perfstatcol_t     batchcalls_col = {220, 200, V_PURPLEMAP,     batchcalls_row};
 
+	perfstatcol_t drawthreadtime_col =  {90, 115, V_REDMAP,     drawthreadtime_row};
+	perfstatcol_t drawthreadcmds_col = {155, 200, V_PURPLEMAP,  drawthreadcmds_row};
+
+	perfstatcol_t     portaltime_col =  {90, 115, V_REDMAP,         portaltime_row};
+	perfstatcol_t     portalarea_col = {155, 200, V_PURPLEMAP,      portalarea_row};
+
 
 	boolean rendering = (
 			gamestate == GS_LEVEL ||
@@ -284,7 +397,9 @@ static void M_DrawRenderStats(void)
 				ps_sw_spritecliptime +
 				ps_sw_portaltime +
 				ps_sw_planetime +
-				ps_sw_maskedtime;
+				ps_sw_maskedtime +
+				ps_sw_drawsorttime +
+				ps_sw_drawtime;
 
 			M_DrawPerfTiming(&softwaretime_col);
 		}
@@ -297,8 +412,14 @@ static void M_DrawRenderStats(void)
 
 	if (rendering)
 	{
+		INT32 numcalls = M_AppendRows(rendercalls_row, 0, commoncalls_row);
+		if (rendermode == render_soft)
+			numcalls = M_AppendRows(rendercalls_row, numcalls, softwarecalls_row);
+		M_AppendRows(rendercalls_row, numcalls, cachecalls_row);
+
 		draw_row = 10;
 		M_DrawPerfCount(&rendercalls_col);
+		time_row = draw_row;
 
 #ifdef HWRENDER
 		if (rendermode == render_opengl && cv_glbatching.value)
@@ -317,6 +438,30 @@ static void M_DrawRenderStats(void)
 			M_DrawPerfCount(&batchcalls_col);
 		}
 #endif
+
+		if (rendermode == render_soft && ps_sw_numdrawthreads > 1)
+		{
+			M_SetDrawThreadRows(&drawthreadtime_col, &drawthreadcmds_col);
+
+			draw_row += half_row;
+			M_DrawPerfTiming(&drawthreadtime_col);
+			time_row = draw_row;
+
+			draw_row = 10;
+			M_DrawPerfCount(&drawthreadcmds_col);
+			count_row = draw_row + half_row;
+		}
+
+		if (rendermode == render_soft && (ps_sw_numportals || ps_sw_portalsculled))
+		{
+			M_SetPortalRows(&portaltime_col, &portalarea_col);
+
+			draw_row = time_row + half_row;
+			M_DrawPerfTiming(&portaltime_col);
+
+			draw_row = count_row;
+			M_DrawPerfCount(&portalarea_col);
+		}
 	}
 }
 
@@ -400,6 +545,7 @@ static void M_DrawTickStats(void)
 	perfstatrow_t misc_calls_row[] = {
 		{"lmhook", "Lua mobj hooks: ", &ps_lua_mobjhooks},
 		{"chkpos", "P_CheckPosition:", &ps_checkposition_calls},
+		{"chksgt", "P_CheckSight:   ", &ps_checksight_calls},
 		{0}
 	};
 
@@ -477,6 +623,107 @@ static void M_DrawTickStats(void)
 	M_DrawPerfCount(&misc_calls_col);
 }
 
+static void M_SumTagStats(INT32 lowtag, INT32 hightag, int *livekb, int *ticbytes)
+{
+	size_t live = 0, tic = 0;
+	INT32 tag;
+
+	hightag = min(hightag, ZNUMTAGSTATS - 1);
+
+	for (tag = lowtag; tag <= hightag; tag++)
+	{
+		const zstats_t *st = Z_GetTagStats(tag);
+		live += st->live;
+		tic += st->lastticbytes;
+	}
+
+	*livekb = (int)(live>>10);
+	*ticbytes = (int)tic;
+}
+
+static void M_DrawMemoryStats(void)
+{
+	const boolean hires = M_HighResolution();
+	const INT32 draw_flags = V_MONOSPACE | V_ALLOWLOWERCASE;
+
+	int statickb, patchkb, cachekb, levelkb, levspeckb, purgekb, totalkb;
+	int staticb, patchb, cacheb, levelb, levspecb, purgeb, totalb;
+
+	const zstats_t *top[16];
+	size_t numtop, i;
+
+	perfstatrow_t livekb_row[] = {
+		{"static ", "Static KB:     ", &statickb},
+		{"patches", "Patches KB:    ", &patchkb},
+		{"cache  ", "Cache KB:      ", &cachekb},
+		{"level  ", "Level KB:      ", &levelkb},
+		{"levspec", "Lev. spec KB:  ", &levspeckb},
+		{"purge  ", "Purgable KB:   ", &purgekb},
+		{"total  ", "Total KB:      ", &totalkb},
+		{0}
+	};
+
+	perfstatrow_t ticbytes_row[] = {
+		{"static ", "Static B/tic:   ", &staticb},
+		{"patches", "Patches B/tic:  ", &patchb},
+		{"cache  ", "Cache B/tic:    ", &cacheb},
+		{"level  ", "Level B/tic:    ", &levelb},
+		{"levspec", "Lev. spec B/tic:", &levspecb},
+		{"purge  ", "Purgable B/tic: ", &purgeb},
+		{"total  ", "Total B/tic:    ", &totalb},
+		{0}
+	};
+
+	perfstatcol_t livekb_col   = {20,  20, V_YELLOWMAP, livekb_row};
+	perfstatcol_t ticbytes_col = {90, 115, V_BLUEMAP,   ticbytes_row};
+
+	M_SumTagStats(PU_STATIC, PU_LUA, &statickb, &staticb);
+	M_SumTagStats(PU_PATCH, PU_HUDGFX, &patchkb, &patchb);
+	M_SumTagStats(PU_HWRCACHE, PU_CACHE, &cachekb, &cacheb);
+	M_SumTagStats(PU_LEVEL, PU_LEVEL, &levelkb, &levelb);
+	M_SumTagStats(PU_LEVSPEC, PU_LEVSPEC, &levspeckb, &levspecb);
+	M_SumTagStats(PU_PURGELEVEL, INT32_MAX, &purgekb, &purgeb);
+	M_SumTagStats(0, INT32_MAX, &totalkb, &totalb);
+
+	draw_row = 10;
+	M_DrawPerfCount(&livekb_col);
+
+	draw_row = 10;
+	M_DrawPerfCount(&ticbytes_col);
+
+	// Call sites allocating the most, from the allocation profiler
+	draw_row += hires ? 5 : 8;
+
+	if (!Z_IsProfiling())
+	{
+		if (hires)
+			V_DrawSmallString(20, draw_row, draw_flags | V_GRAYMAP, "Type \"zprofile on\" to profile call sites.");
+		else
+			V_DrawThinString(20, draw_row, draw_flags | V_GRAYMAP, "\"zprofile on\" for call sites");
+		return;
+	}
+
+	numtop = Z_GetTopSites(top, hires ? 16 : 6);
+
+	for (i = 0; i < numtop; i++)
+	{
+		const char *filename = strrchr(top[i]->file, PATHSEP[0]);
+		const char *text = va("%s:%d %s B/tic %s KB", filename ? filename + 1 : top[i]->file, top[i]->line,
+			sizeu1(top[i]->lastticbytes), sizeu2(top[i]->live>>10));
+
+		if (hires)
+		{
+			V_DrawSmallString(20, draw_row, draw_flags | V_PURPLEMAP, text);
+			draw_row += 5;
+		}
+		else
+		{
+			V_DrawThinString(20, draw_row, draw_flags | V_PURPLEMAP, text);
+			draw_row += 8;
+		}
+	}
+}
+
 void M_DrawPerfStats(void)
 {
 	char s[100];
@@ -491,6 +738,10 @@ void M_DrawPerfStats(void)
 	{
 		M_DrawTickStats();
 	}
+	else if (cv_perfstats.value == 4) // memory
+	{
+		M_DrawMemoryStats();
+	}
 	else if (cv_perfstats.value == 3) // lua thinkframe
 	{
 		if (!(gamestate == GS_LEVEL || (gamestate == GS_TITLESCREEN && titlemapinaction)))
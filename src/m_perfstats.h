@@ -25,6 +25,8 @@ extern precise_t ps_thlist_times[];
 
 extern int       ps_checkposition_calls;
 
+extern int       ps_checksight_calls;
+
 extern precise_t ps_lua_thinkframe_time;
 extern int       ps_lua_mobjhooks;
 
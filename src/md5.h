@@ -72,11 +72,23 @@ typedef u_int32_t md5_uint32;
 #define	__P(x) ()
 #endif
 
+/* Structure to save state of computation between the single steps.  */
+struct md5_ctx
+{
+  md5_uint32 A;
+  md5_uint32 B;
+  md5_uint32 C;
+  md5_uint32 D;
+
+  md5_uint32 total[2];
+  md5_uint32 buflen;
+  char buffer[128];
+};
+
 /*
  * The following three functions are build up the low level used in
  * the functions `md5_stream' and `md5_buffer'.
  */
-#if 0
 /* Initialize structure containing state of computation.
    (RFC 1321, 3.3: Step 3)  */
 extern void md5_init_ctx __P ((struct md5_ctx *ctx));
@@ -113,8 +125,6 @@ extern void *md5_finish_ctx __P ((struct md5_ctx *ctx, void *resbuf));
    aligned for a 32 bits value.  */
 extern void *md5_read_ctx __P ((const struct md5_ctx *ctx, void *resbuf));
 
-#endif
-
 /* Compute MD5 message digest for bytes read from STREAM.  The
    resulting message digest number will be written into the 16 bytes
    beginning at RESBLOCK.  */
@@ -35,6 +35,7 @@ result_e T_MovePlane(sector_t *sector, fixed_t speed, fixed_t dest, boolean crus
 	fixed_t lastpos;
 	fixed_t destheight; // used to keep floors/ceilings from moving through each other
 	sector->moved = true;
+	geometrychanges++;
 
 	if (ceiling)
 	{
@@ -580,6 +581,7 @@ void T_ContinuousFalling(continuousfall_t *faller)
 	faller->sector->floorspeed = faller->speed*faller->direction;
 	faller->sector->ceilspeed = 42;
 	faller->sector->moved = true;
+	geometrychanges++;
 }
 
 //
@@ -654,6 +656,7 @@ void T_BounceCheese(bouncecheese_t *bouncer)
 	{
 		actionsector = &sectors[i];
 		actionsector->moved = true;
+		geometrychanges++;
 
 		sectorheight = abs(bouncer->sector->ceilingheight - bouncer->sector->floorheight);
 		halfheight = sectorheight/2;
@@ -694,6 +697,7 @@ void T_BounceCheese(bouncecheese_t *bouncer)
 			bouncer->sector->floorspeed = 0;
 			bouncer->sector->ceilspeed = 0;
 			bouncer->sector->moved = true;
+			geometrychanges++;
 			P_RemoveThinker(&bouncer->thinker); // remove bouncer from actives
 			return;
 		}
@@ -754,6 +758,7 @@ void T_BounceCheese(bouncecheese_t *bouncer)
 			bouncer->sector->floorspeed = 0;
 			bouncer->sector->ceilspeed = 0;
 			bouncer->sector->moved = true;
+			geometrychanges++;
 			P_RemoveThinker(&bouncer->thinker);    // remove bouncer from actives
 		}
 
@@ -929,6 +934,7 @@ void T_StartCrumble(crumble_t *crumble)
 		crumble->sector->ceilspeed = 0;
 		crumble->sector->floorspeed = 0;
 		crumble->sector->moved = true;
+		geometrychanges++;
 		P_RemoveThinker(&crumble->thinker);
 	}
 
@@ -4268,6 +4268,7 @@ boolean P_CheckSector(sector_t *sector, boolean crunch)
 
 	nofit = false;
 	crushchange = crunch;
+	geometrychanges++;
 
 	// killough 4/4/98: scan list front-to-back until empty or exhausted,
 	// restarting from beginning after each thing is processed. Avoids
@@ -1027,6 +1027,7 @@ boolean Polyobj_moveXY(polyobj_t *po, fixed_t x, fixed_t y, boolean checkmobjs)
 		Polyobj_removeFromSubsec(po);   // unlink it from its subsector
 		Polyobj_linkToBlockmap(po);     // relink to blockmap
 		Polyobj_attachToSubsec(po);     // relink to subsector
+		geometrychanges++;
 	}
 
 	return !(hitflags & 2);
@@ -1227,6 +1228,7 @@ boolean Polyobj_rotate(polyobj_t *po, angle_t delta, UINT8 turnthings, boolean c
 		Polyobj_removeFromSubsec(po);   // remove from subsector
 		Polyobj_linkToBlockmap(po);     // relink to blockmap
 		Polyobj_attachToSubsec(po);     // relink to subsector
+		geometrychanges++;
 	}
 
 	return !(hitflags & 2);
@@ -2500,6 +2502,7 @@ void T_PolyObjFade(polyfade_t *th)
 {
 	boolean stillfading = false;
 	polyobj_t *po = Polyobj_GetForNum(th->polyObjNum);
+	INT32 oldflags;
 
 	if (!po)
 #ifdef RANGECHECK
@@ -2541,6 +2544,8 @@ void T_PolyObjFade(polyfade_t *th)
 			po->translucency = min(max(po->translucency, th->sourcevalue + (INT16)FixedMul(delta, factor)), th->destvalue);
 	}
 
+	oldflags = po->flags;
+
 	if (!stillfading)
 	{
 		// set render flags
@@ -2589,6 +2594,9 @@ void T_PolyObjFade(polyfade_t *th)
 			}
 		}
 	}
+
+	if (po->flags != oldflags)
+		geometrychanges++;
 }
 
 boolean EV_DoPolyObjFade(polyfadedata_t *pfdata)
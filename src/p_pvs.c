@@ -0,0 +1,723 @@
+// SONIC ROBO BLAST 2
+//-----------------------------------------------------------------------------
+// Copyright (C) 1999-2021 by Sonic Team Junior.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  p_pvs.c
+/// \brief Potentially visible sets of sectors, built from the map's two-sided lines
+///
+///        A sector might see another if a straight line can leave the first
+///        through one of its two-sided lines and reach the second through more
+///        of them. Heights are ignored, so doors and lifts can move freely
+///        without the sets going stale. The sets only ever say too much, so
+///        anything they reject could not have been seen anyway.
+
+#include <math.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "byteptr.h"
+#include "d_main.h" // srb2home
+#include "i_system.h"
+#include "m_misc.h"
+#include "p_local.h"
+#include "p_pvs.h"
+#include "p_setup.h" // mapmd5
+#include "r_state.h"
+#include "w_wad.h" // CACHE_DIR
+#include "z_zone.h"
+
+static void PVS_OnChange(void);
+
+consvar_t cv_pvs = CVAR_INIT ("pvs", "On", CV_SAVE|CV_CALL|CV_NOINIT, CV_OnOff, PVS_OnChange);
+
+UINT8 *pvsmatrix = NULL;
+size_t pvsrowbytes = 0;
+
+#define PVSHEADER "SRB2PVS"
+#define PVSVERSION 2
+
+#define PVSMAXSECTORS 8192 // 8 megabytes of sets
+#define PVSMAXBASESIZE (96<<20) // Most memory the per-portal sets can take while building
+#define PVSMAXSTEPS (1<<12) // Portal visits before a sector settles for what its portals might see
+#define PVSEPSILON 1.0 // Map units of slack, so rounding only ever lets more through
+#define PVSMAXBUILDTIME 1000000 // Microseconds a build may take before the map goes without sets
+
+// A two-sided line, seen from one of its sectors.
+// The segment runs so that the sector it leads to is on its left.
+typedef struct
+{
+	double x1, y1, x2, y2;
+} pvsseg_t;
+
+typedef struct
+{
+	pvsseg_t seg;
+	size_t line;
+	size_t to;
+} pvsportal_t;
+
+static pvsportal_t *pvsportals;
+static size_t numpvsportals;
+static size_t *pvsportalstart; // [numsectors+1], the portals leading out of each sector
+static UINT8 *pvsleaky; // Sectors that aren't closed; anything could be behind them
+static UINT8 *pvsonpath; // Lines the current flow already went through
+
+// What each portal might see, from a rough flood through the portals in front of it.
+// A flow stops as soon as what it might still see holds nothing new.
+static UINT8 *pvsmightsee;
+static UINT8 *pvsmight; // What the flow might see at each depth
+static size_t pvsmightdepths;
+
+typedef struct
+{
+	UINT8 *row;
+	size_t steps;
+	boolean done;
+} pvsflow_t;
+
+static precise_t pvsbuildstart;
+static size_t pvschecks;
+static boolean pvsgaveup; // The build ran out of time
+
+// Checks every so often whether the build has taken too long.
+static boolean PVS_OutOfTime(void)
+{
+	if (!pvsgaveup && !(++pvschecks & 255)
+		&& I_PreciseToMicros(I_GetPreciseTime() - pvsbuildstart) > PVSMAXBUILDTIME)
+		pvsgaveup = true;
+	return pvsgaveup;
+}
+
+//
+// PVS_ClipSeg
+// Keeps the part of x on one side of the line from (ax, ay) to (bx, by),
+// the left side if side is positive, the right side if negative.
+// Returns false if nothing is left.
+//
+static boolean PVS_ClipSeg(pvsseg_t *x, double ax, double ay, double bx, double by, double side)
+{
+	double dx = bx - ax, dy = by - ay;
+	double len = sqrt(dx*dx + dy*dy);
+	double d1, d2, t;
+
+	if (len < 1e-6) // Not a line; nothing to clip against
+		return true;
+
+	d1 = side*(dx*(x->y1 - ay) - dy*(x->x1 - ax))/len + PVSEPSILON;
+	d2 = side*(dx*(x->y2 - ay) - dy*(x->x2 - ax))/len + PVSEPSILON;
+
+	if (d1 < 0 && d2 < 0)
+		return false;
+
+	if (d1 < 0)
+	{
+		t = d1/(d1 - d2);
+		x->x1 += (x->x2 - x->x1)*t;
+		x->y1 += (x->y2 - x->y1)*t;
+	}
+	else if (d2 < 0)
+	{
+		t = d2/(d2 - d1);
+		x->x2 += (x->x1 - x->x2)*t;
+		x->y2 += (x->y1 - x->y2)*t;
+	}
+
+	return true;
+}
+
+//
+// PVS_ClipToSeparators
+// Keeps the part of x that a straight line can reach
+// after going through src and then through pass.
+// Each line from an end of src to an end of pass that has the rest of src
+// on one side and the rest of pass on the other bounds where it can go.
+//
+static boolean PVS_ClipToSeparators(pvsseg_t *x, const pvsseg_t *src, const pvsseg_t *pass)
+{
+	const double sx[2] = {src->x1, src->x2}, sy[2] = {src->y1, src->y2};
+	const double px[2] = {pass->x1, pass->x2}, py[2] = {pass->y1, pass->y2};
+	double dx, dy, len, ds, dp;
+	INT32 j, k;
+
+	for (k = 0; k < 2; k++)
+		for (j = 0; j < 2; j++)
+		{
+			dx = px[j] - sx[k];
+			dy = py[j] - sy[k];
+			len = sqrt(dx*dx + dy*dy);
+			if (len < 1e-6)
+				continue;
+
+			ds = (dx*(sy[k^1] - sy[k]) - dy*(sx[k^1] - sx[k]))/len;
+			dp = (dx*(py[j^1] - sy[k]) - dy*(px[j^1] - sx[k]))/len;
+
+			if (ds < -PVSEPSILON && dp > PVSEPSILON)
+			{
+				if (!PVS_ClipSeg(x, sx[k], sy[k], px[j], py[j], 1.0))
+					return false;
+			}
+			else if (ds > PVSEPSILON && dp < -PVSEPSILON)
+			{
+				if (!PVS_ClipSeg(x, sx[k], sy[k], px[j], py[j], -1.0))
+					return false;
+			}
+		}
+
+	return true;
+}
+
+static void PVS_SeeAll(pvsflow_t *flow)
+{
+	memset(flow->row, 0xFF, pvsrowbytes);
+	flow->done = true;
+}
+
+static void PVS_See(pvsflow_t *flow, size_t secnum)
+{
+	flow->row[secnum>>3] |= 1<<(secnum&7);
+	if (pvsleaky[secnum])
+		PVS_SeeAll(flow);
+}
+
+// Returns the row of what the flow might see at the given depth.
+static UINT8 *PVS_Might(size_t depth)
+{
+	if (depth >= pvsmightdepths)
+	{
+		pvsmightdepths = depth + 64;
+		pvsmight = Z_Realloc(pvsmight, pvsmightdepths * pvsrowbytes, PU_STATIC, NULL);
+	}
+	return pvsmight + depth*pvsrowbytes;
+}
+
+// Narrows what the flow might see at the next depth down to what the portal might see.
+// Returns false if none of it is new.
+static boolean PVS_Narrow(pvsflow_t *flow, size_t depth, size_t portalnum)
+{
+	UINT8 *next = PVS_Might(depth + 1);
+	const UINT8 *might = pvsmight + depth*pvsrowbytes;
+	const UINT8 *mightsee = pvsmightsee + portalnum*pvsrowbytes;
+	UINT8 more = 0;
+	size_t i;
+
+	for (i = 0; i < pvsrowbytes; i++)
+	{
+		next[i] = might[i] & mightsee[i];
+		more |= next[i] & ~flow->row[i];
+	}
+
+	return (more != 0);
+}
+
+//
+// PVS_Flow
+// Follows the lines that went through src and then pass into the sector,
+// on through the sector's other two-sided lines.
+//
+static void PVS_Flow(pvsflow_t *flow, const pvsseg_t *src, const pvsseg_t *pass, size_t secnum, size_t depth)
+{
+	size_t i;
+
+	for (i = pvsportalstart[secnum]; i < pvsportalstart[secnum + 1] && !flow->done; i++)
+	{
+		const pvsportal_t *portal = &pvsportals[i];
+		pvsseg_t seg, newsrc;
+
+		if (pvsonpath[portal->line] || !PVS_Narrow(flow, depth, i))
+			continue;
+
+		if (++flow->steps > PVSMAXSTEPS || PVS_OutOfTime())
+		{
+			flow->done = true;
+			return;
+		}
+
+		// Past the pass, and inside the lines of sight through it.
+		seg = portal->seg;
+		if (!PVS_ClipSeg(&seg, pass->x1, pass->y1, pass->x2, pass->y2, 1.0)
+			|| !PVS_ClipToSeparators(&seg, src, pass))
+			continue;
+
+		PVS_See(flow, portal->to);
+
+		// Only the part of the source that can see this far matters from here on.
+		newsrc = *src;
+		if (!PVS_ClipToSeparators(&newsrc, &seg, pass))
+			continue;
+
+		pvsonpath[portal->line] = 1;
+		PVS_Flow(flow, &newsrc, &seg, portal->to, depth + 1);
+		pvsonpath[portal->line] = 0;
+	}
+}
+
+//
+// PVS_BuildSector
+// Finds every sector that the given one might see.
+//
+static void PVS_BuildSector(size_t secnum, UINT8 *row)
+{
+	pvsflow_t flow;
+	size_t i, j;
+
+	flow.row = row;
+	flow.steps = 0;
+	flow.done = false;
+
+	PVS_See(&flow, secnum);
+
+	for (i = pvsportalstart[secnum]; i < pvsportalstart[secnum + 1] && !flow.done; i++)
+	{
+		const pvsportal_t *src = &pvsportals[i];
+		size_t next = src->to;
+
+		// Everything in the next sector is past the source.
+		PVS_See(&flow, next);
+		pvsonpath[src->line] = 1;
+		M_Memcpy(PVS_Might(0), pvsmightsee + i*pvsrowbytes, pvsrowbytes);
+
+		for (j = pvsportalstart[next]; j < pvsportalstart[next + 1] && !flow.done; j++)
+		{
+			const pvsportal_t *pass = &pvsportals[j];
+			pvsseg_t seg, newsrc;
+
+			if (pvsonpath[pass->line] || !PVS_Narrow(&flow, 0, j))
+				continue;
+
+			seg = pass->seg;
+			if (!PVS_ClipSeg(&seg, src->seg.x1, src->seg.y1, src->seg.x2, src->seg.y2, 1.0))
+				continue;
+
+			PVS_See(&flow, pass->to);
+
+			newsrc = src->seg;
+			if (!PVS_ClipSeg(&newsrc, seg.x1, seg.y1, seg.x2, seg.y2, -1.0))
+				continue;
+
+			pvsonpath[pass->line] = 1;
+			PVS_Flow(&flow, &newsrc, &seg, pass->to, 1);
+			pvsonpath[pass->line] = 0;
+		}
+
+		pvsonpath[src->line] = 0;
+	}
+
+	// Too many ways through to follow them all.
+	if (flow.steps > PVSMAXSTEPS)
+		for (i = pvsportalstart[secnum]; i < pvsportalstart[secnum + 1]; i++)
+			for (j = 0; j < pvsrowbytes; j++)
+				row[j] |= pvsmightsee[i*pvsrowbytes + j];
+}
+
+static void PVS_SetLeaky(const sector_t *sector)
+{
+	if (sector)
+		pvsleaky[sector - sectors] = 1;
+}
+
+//
+// PVS_FindLeaks
+// Marks the sectors that a line of sight could leave without crossing one of
+// their lines: sectors whose lines don't close up, sectors whose subsectors
+// hold another sector's lines, and sectors touching a polyobject.
+//
+static void PVS_FindLeaks(void)
+{
+	UINT16 *ends = Z_Calloc(numvertexes * sizeof (*ends), PU_STATIC, NULL);
+	size_t i, j;
+
+	for (i = 0; i < numsectors; i++)
+	{
+		sector_t *sector = &sectors[i];
+
+		// Every corner of a closed sector joins an even number of its sides.
+		for (j = 0; j < sector->linecount; j++)
+		{
+			line_t *ld = sector->lines[j];
+			UINT16 linesides = (ld->frontsector == sector) + (ld->backsector == sector);
+			ends[ld->v1 - vertexes] += linesides;
+			ends[ld->v2 - vertexes] += linesides;
+		}
+
+		for (j = 0; j < sector->linecount; j++)
+		{
+			line_t *ld = sector->lines[j];
+			if ((ends[ld->v1 - vertexes] | ends[ld->v2 - vertexes]) & 1)
+				pvsleaky[i] = 1;
+		}
+
+		for (j = 0; j < sector->linecount; j++)
+		{
+			line_t *ld = sector->lines[j];
+			ends[ld->v1 - vertexes] = ends[ld->v2 - vertexes] = 0;
+		}
+	}
+
+	for (i = 0; i < numlines; i++)
+	{
+		if (lines[i].polyobj || !lines[i].frontsector || (lines[i].sidenum[1] != 0xffff && !lines[i].backsector))
+		{
+			PVS_SetLeaky(lines[i].frontsector);
+			PVS_SetLeaky(lines[i].backsector);
+		}
+	}
+
+	for (i = 0; i < numsubsectors; i++)
+	{
+		seg_t *seg = &segs[subsectors[i].firstline];
+
+		for (j = 0; j < (size_t)subsectors[i].numlines; j++, seg++)
+		{
+			if (seg->glseg || seg->polyseg || seg->frontsector == subsectors[i].sector)
+				continue;
+			PVS_SetLeaky(seg->frontsector);
+			PVS_SetLeaky(subsectors[i].sector);
+		}
+	}
+
+	Z_Free(ends);
+}
+
+//
+// PVS_InFront
+// Checks if a line of sight through the portal could go on through the other.
+//
+static boolean PVS_InFront(const pvsportal_t *portal, const pvsportal_t *other)
+{
+	pvsseg_t seg;
+
+	if (other->line == portal->line)
+		return false;
+
+	seg = other->seg;
+	if (!PVS_ClipSeg(&seg, portal->seg.x1, portal->seg.y1, portal->seg.x2, portal->seg.y2, 1.0))
+		return false;
+
+	seg = portal->seg;
+	return PVS_ClipSeg(&seg, other->seg.x1, other->seg.y1, other->seg.x2, other->seg.y2, -1.0);
+}
+
+//
+// PVS_BasePortalVis
+// Floods out of every portal through the portals in front of it,
+// to find what it might see.
+//
+static void PVS_BasePortalVis(void)
+{
+	size_t *stack = Z_Malloc(numsectors * sizeof (*stack), PU_STATIC, NULL);
+	size_t p, i, top;
+
+	for (p = 0; p < numpvsportals && !PVS_OutOfTime(); p++)
+	{
+		const pvsportal_t *portal = &pvsportals[p];
+		UINT8 *might = pvsmightsee + p*pvsrowbytes;
+
+		might[portal->to>>3] |= 1<<(portal->to&7);
+		stack[0] = portal->to;
+		top = 1;
+
+		while (top)
+		{
+			size_t secnum = stack[--top];
+
+			if (pvsleaky[secnum])
+			{
+				memset(might, 0xFF, pvsrowbytes);
+				break;
+			}
+
+			for (i = pvsportalstart[secnum]; i < pvsportalstart[secnum + 1]; i++)
+			{
+				const pvsportal_t *other = &pvsportals[i];
+
+				if (PVS_CANSEE(might, other->to) || !PVS_InFront(portal, other))
+					continue;
+
+				might[other->to>>3] |= 1<<(other->to&7);
+				stack[top++] = other->to;
+			}
+		}
+	}
+
+	Z_Free(stack);
+}
+
+//
+// PVS_Build
+// Builds the sets from scratch.
+// Returns false if the map is too big to build them for,
+// or building them takes longer than PVSMAXBUILDTIME.
+//
+static boolean PVS_Build(void)
+{
+	size_t *count;
+	size_t i, j;
+
+	pvsbuildstart = I_GetPreciseTime();
+	pvschecks = 0;
+	pvsgaveup = false;
+
+	// Two portals for every two-sided line, one leading each way.
+	numpvsportals = 0;
+	for (i = 0; i < numlines; i++)
+	{
+		line_t *ld = &lines[i];
+		if (!ld->polyobj && ld->frontsector && ld->backsector && (ld->dx || ld->dy))
+			numpvsportals += 2;
+	}
+
+	if (numpvsportals * pvsrowbytes > PVSMAXBASESIZE)
+		return false;
+
+	count = Z_Calloc((numsectors + 1) * sizeof (*count), PU_STATIC, NULL);
+	pvsleaky = Z_Calloc(numsectors, PU_STATIC, NULL);
+	pvsonpath = Z_Calloc(numlines, PU_STATIC, NULL);
+	pvsportalstart = Z_Malloc((numsectors + 1) * sizeof (*pvsportalstart), PU_STATIC, NULL);
+	pvsportals = Z_Malloc((numpvsportals + 1) * sizeof (*pvsportals), PU_STATIC, NULL);
+	pvsmightsee = Z_Calloc((numpvsportals + 1) * pvsrowbytes, PU_STATIC, NULL);
+	pvsmight = NULL;
+	pvsmightdepths = 0;
+
+	PVS_FindLeaks();
+
+	for (i = 0; i < numlines; i++)
+	{
+		line_t *ld = &lines[i];
+		if (!ld->polyobj && ld->frontsector && ld->backsector && (ld->dx || ld->dy))
+		{
+			count[ld->frontsector - sectors]++;
+			count[ld->backsector - sectors]++;
+		}
+	}
+
+	for (i = 0, j = 0; i <= numsectors; i++)
+	{
+		pvsportalstart[i] = j;
+		j += count[i];
+		count[i] = pvsportalstart[i];
+	}
+
+	for (i = 0; i < numlines; i++)
+	{
+		line_t *ld = &lines[i];
+		double x1, y1, x2, y2;
+		pvsportal_t *portal;
+
+		if (ld->polyobj || !ld->frontsector || !ld->backsector || !(ld->dx || ld->dy))
+			continue;
+
+		x1 = (double)ld->v1->x / FRACUNIT;
+		y1 = (double)ld->v1->y / FRACUNIT;
+		x2 = (double)ld->v2->x / FRACUNIT;
+		y2 = (double)ld->v2->y / FRACUNIT;
+
+		// The back is on the left of a linedef.
+		portal = &pvsportals[count[ld->frontsector - sectors]++];
+		portal->seg.x1 = x1; portal->seg.y1 = y1;
+		portal->seg.x2 = x2; portal->seg.y2 = y2;
+		portal->line = i;
+		portal->to = ld->backsector - sectors;
+
+		portal = &pvsportals[count[ld->backsector - sectors]++];
+		portal->seg.x1 = x2; portal->seg.y1 = y2;
+		portal->seg.x2 = x1; portal->seg.y2 = y1;
+		portal->line = i;
+		portal->to = ld->frontsector - sectors;
+	}
+
+	PVS_BasePortalVis();
+
+	for (i = 0; i < numsectors && !PVS_OutOfTime(); i++)
+	{
+		if (pvsleaky[i])
+			memset(pvsmatrix + i*pvsrowbytes, 0xFF, pvsrowbytes);
+		else
+			PVS_BuildSector(i, pvsmatrix + i*pvsrowbytes);
+	}
+
+	// Lines of sight go both ways; make sure the sets agree.
+	if (!pvsgaveup)
+		for (i = 0; i < numsectors; i++)
+			for (j = 0; j < numsectors; j++)
+				if (PVS_CANSEE(pvsmatrix + i*pvsrowbytes, j))
+					pvsmatrix[j*pvsrowbytes + (i>>3)] |= 1<<(i&7);
+
+	Z_Free(count);
+	Z_Free(pvsleaky);
+	Z_Free(pvsonpath);
+	Z_Free(pvsportalstart);
+	Z_Free(pvsportals);
+	Z_Free(pvsmightsee);
+	Z_Free(pvsmight);
+	return !pvsgaveup;
+}
+
+// Sums up the parts of the map the sets depend on,
+// for geometry that the map's MD5 doesn't cover.
+static UINT32 PVS_MapChecksum(void)
+{
+	UINT32 sum = 0;
+	size_t i;
+
+	for (i = 0; i < numlines; i++)
+	{
+		if (lines[i].polyobj)
+			continue;
+		sum = (sum ^ (UINT32)lines[i].v1->x) * 0x01000193;
+		sum = (sum ^ (UINT32)lines[i].v1->y) * 0x01000193;
+		sum = (sum ^ (UINT32)lines[i].v2->x) * 0x01000193;
+		sum = (sum ^ (UINT32)lines[i].v2->y) * 0x01000193;
+		sum = (sum ^ (UINT32)(lines[i].frontsector ? lines[i].frontsector - sectors : -1)) * 0x01000193;
+		sum = (sum ^ (UINT32)(lines[i].backsector ? lines[i].backsector - sectors : -1)) * 0x01000193;
+	}
+
+	return sum;
+}
+
+// The sets are cached by the map's MD5, in the cache folder.
+static void PVS_CachePath(char *path, size_t size)
+{
+	char md5[33];
+	size_t i;
+
+	for (i = 0; i < 16; i++)
+		sprintf(&md5[i*2], "%02x", mapmd5[i]);
+
+	snprintf(path, size, "%s"PATHSEP CACHE_DIR PATHSEP"%s.pvs", srb2home, md5);
+	path[size - 1] = '\0';
+}
+
+#define PVSHEADERSIZE (sizeof (PVSHEADER) + 5*4)
+
+// What a cache file can hold for a map.
+enum
+{
+	PVSCACHE_NONE, // Nothing usable; build the sets
+	PVSCACHE_SETS, // The sets
+	PVSCACHE_GAVEUP // Building the sets took too long last time
+};
+
+static INT32 PVS_ReadCache(const char *path, UINT32 checksum)
+{
+	UINT8 *buffer = NULL, *p;
+	size_t length = FIL_ReadFile(path, &buffer);
+	INT32 result = PVSCACHE_NONE;
+	boolean valid;
+
+	if (!length)
+		return PVSCACHE_NONE;
+
+	p = buffer;
+	if (length >= PVSHEADERSIZE && !memcmp(p, PVSHEADER, sizeof (PVSHEADER)))
+	{
+		p += sizeof (PVSHEADER);
+		valid = (READUINT32(p) == PVSVERSION);
+		valid = (READUINT32(p) == numsectors) && valid;
+		valid = (READUINT32(p) == numlines) && valid;
+		valid = (READUINT32(p) == checksum) && valid;
+
+		if (valid && !READUINT32(p))
+			result = PVSCACHE_GAVEUP;
+		else if (valid && length == PVSHEADERSIZE + numsectors*pvsrowbytes)
+		{
+			M_Memcpy(pvsmatrix, p, numsectors*pvsrowbytes);
+			result = PVSCACHE_SETS;
+		}
+	}
+
+	Z_Free(buffer);
+	return result;
+}
+
+// Writes the sets to the cache, or if there are none,
+// a note that building them isn't worth trying again.
+static void PVS_WriteCache(const char *path, UINT32 checksum, boolean built)
+{
+	size_t length = PVSHEADERSIZE + (built ? numsectors*pvsrowbytes : 0);
+	UINT8 *buffer = Z_Malloc(length, PU_STATIC, NULL);
+	UINT8 *p = buffer;
+
+	M_Memcpy(p, PVSHEADER, sizeof (PVSHEADER));
+	p += sizeof (PVSHEADER);
+	WRITEUINT32(p, PVSVERSION);
+	WRITEUINT32(p, numsectors);
+	WRITEUINT32(p, numlines);
+	WRITEUINT32(p, checksum);
+	WRITEUINT32(p, built);
+	if (built)
+		M_Memcpy(p, pvsmatrix, numsectors*pvsrowbytes);
+
+	I_mkdir(va("%s"PATHSEP CACHE_DIR, srb2home), 0755);
+	if (!FIL_WriteFile(path, buffer, length))
+		CONS_Debug(DBG_SETUP, "PVS_WriteCache: couldn't write %s\n", path);
+
+	Z_Free(buffer);
+}
+
+//
+// P_LoadPVS
+// Reads the sets for the current map from the cache,
+// or builds them and caches them.
+// A map whose sets take too long to build goes without.
+//
+void P_LoadPVS(void)
+{
+	char path[MAX_WADPATH];
+	UINT32 checksum;
+	INT32 cached;
+	boolean built;
+
+	if (pvsmatrix)
+		Z_Free(pvsmatrix);
+
+	if (!cv_pvs.value || !numsectors || numsectors > PVSMAXSECTORS)
+		return;
+
+	pvsrowbytes = (numsectors + 7) >> 3;
+	Z_Malloc(numsectors*pvsrowbytes, PU_LEVEL, &pvsmatrix);
+	memset(pvsmatrix, 0, numsectors*pvsrowbytes);
+
+	checksum = PVS_MapChecksum();
+	PVS_CachePath(path, sizeof path);
+
+	cached = PVS_ReadCache(path, checksum);
+	if (cached == PVSCACHE_SETS)
+		return;
+
+	if (cached == PVSCACHE_NONE)
+	{
+		built = PVS_Build();
+		CONS_Debug(DBG_SETUP, "PVS for %s sectors %s after %d ms\n", sizeu1(numsectors),
+			built ? "built" : "given up", I_PreciseToMicros(I_GetPreciseTime() - pvsbuildstart)/1000);
+
+		PVS_WriteCache(path, checksum, built);
+		if (built)
+			return;
+	}
+
+	Z_Free(pvsmatrix);
+}
+
+//
+// P_GetPVSRow
+// Returns the set of sectors the given sector might see,
+// or NULL if there is nothing to go by.
+// Only the renderer may use this: the sets depend on a local
+// setting, so nothing the game simulates can depend on them.
+//
+UINT8 *P_GetPVSRow(const sector_t *sector)
+{
+	if (!pvsmatrix || !cv_pvs.value || !sector)
+		return NULL;
+	return pvsmatrix + (sector - sectors)*pvsrowbytes;
+}
+
+static void PVS_OnChange(void)
+{
+	if (cv_pvs.value && !pvsmatrix && gamestate == GS_LEVEL)
+		P_LoadPVS();
+}
@@ -0,0 +1,29 @@
+// SONIC ROBO BLAST 2
+//-----------------------------------------------------------------------------
+// Copyright (C) 1999-2021 by Sonic Team Junior.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  p_pvs.h
+/// \brief Potentially visible sets of sectors
+
+#ifndef __P_PVS__
+#define __P_PVS__
+
+#include "command.h"
+#include "r_defs.h"
+
+extern consvar_t cv_pvs;
+
+// One row of bits per sector, one bit per sector it might see.
+extern UINT8 *pvsmatrix;
+extern size_t pvsrowbytes;
+
+#define PVS_CANSEE(row, secnum) ((row)[(secnum)>>3] & (1<<((secnum)&7)))
+
+void P_LoadPVS(void);
+UINT8 *P_GetPVSRow(const sector_t *sector);
+
+#endif
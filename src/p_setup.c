@@ -33,6 +33,7 @@
 #include "r_picformats.h"
 #include "r_sky.h"
 #include "r_draw.h"
+#include "r_bsp.h" // R_ClearBSPCache
 
 #include "s_sound.h"
 #include "st_stuff.h"
@@ -80,6 +81,7 @@
 #endif
 
 #include "p_slopes.h"
+#include "p_pvs.h"
 
 #include "fastcmp.h" // textmap parsing
 
@@ -106,6 +108,11 @@ node_t *nodes;
 line_t *lines;
 side_t *sides;
 mapthing_t *mapthings;
+
+// Bumped by everything that changes what can block the view:
+// sector heights, flats and slopes, upper and lower textures,
+// and polyobjects. The Software renderer's BSP cache checks it.
+UINT32 geometrychanges = 0;
 sector_t *spawnsectors;
 line_t *spawnlines;
 side_t *spawnsides;
@@ -3984,6 +3991,7 @@ boolean P_LoadLevel(boolean fromnetsave, boolean reloadinggamestate)
 	// Map header should always be in place at this point
 	INT32 i, ranspecialwipe = 0;
 	sector_t *ss;
+	precise_t freetime;
 	levelloading = true;
 
 	// This is needed. Don't touch.
@@ -4132,6 +4140,7 @@ boolean P_LoadLevel(boolean fromnetsave, boolean reloadinggamestate)
 
 	// Clear pointers that would be left dangling by the purge
 	R_FlushTranslationColormapCache();
+	R_ClearBSPCache();
 
 #ifdef HWRENDER
 	// Free GPU textures before freeing patches.
@@ -4141,7 +4150,11 @@ boolean P_LoadLevel(boolean fromnetsave, boolean reloadinggamestate)
 
 	Patch_FreeTag(PU_PATCH_LOWPRIORITY);
 	Patch_FreeTag(PU_PATCH_ROTATED);
+
+	// Time this, to compare the level arena against -nolevelarena
+	freetime = I_GetPreciseTime();
 	Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+	CONS_Debug(DBG_SETUP, "Freed the previous level in %d us\n", I_PreciseToMicros(I_GetPreciseTime() - freetime));
 
 	P_InitThinkers();
 	P_InitCachedActions();
@@ -4179,6 +4192,9 @@ boolean P_LoadLevel(boolean fromnetsave, boolean reloadinggamestate)
 	if (!P_LoadMapFromFile())
 		return false;
 
+	// Read the level's graphics and sounds while we set up the rest
+	R_PrefetchLevel();
+
 	// init anything that P_SpawnSlopes/P_LoadThings needs to know
 	P_InitSpecials();
 
@@ -4195,6 +4211,9 @@ boolean P_LoadLevel(boolean fromnetsave, boolean reloadinggamestate)
 	// set up world state
 	P_SpawnSpecials(fromnetsave);
 
+	// Now that the polyobjects are known
+	P_LoadPVS();
+
 	if (!fromnetsave) //  ugly hack for P_NetUnArchiveMisc (and P_LoadNetGame)
 		P_SpawnPrecipitation();
 
@@ -4236,6 +4255,9 @@ boolean P_LoadLevel(boolean fromnetsave, boolean reloadinggamestate)
 	if (precache || dedicated)
 		R_PrecacheLevel();
 
+	// Nothing should be left reading by the first frame
+	W_FinishPrefetch();
+
 	nextmapoverride = 0;
 	skipstats = 0;
 
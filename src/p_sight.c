@@ -17,6 +17,7 @@
 #include "p_slopes.h"
 #include "r_main.h"
 #include "r_state.h"
+#include "m_perfstats.h" // ps_checksight_calls
 
 //
 // P_CheckSight
@@ -383,6 +384,8 @@ boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
 	size_t pnum;
 	los_t los;
 
+	ps_checksight_calls++;
+
 	// First check for trivial rejection.
 	if (!t1 || !t2)
 		return false;
@@ -96,7 +96,7 @@ void T_DynamicSlopeLine (dynplanethink_t* th)
 	pslope_t* slope = th->slope;
 	line_t* srcline = th->sourceline;
 
-	fixed_t zdelta;
+	fixed_t zdelta, oldz = slope->o.z;
 
 	switch(th->type) {
 	case DP_FRONTFLOOR:
@@ -127,7 +127,10 @@ void T_DynamicSlopeLine (dynplanethink_t* th)
 		slope->zdelta = FixedDiv(zdelta, th->extent);
 		slope->zangle = R_PointToAngle2(0, 0, th->extent, -zdelta);
 		P_CalculateSlopeNormal(slope);
+		geometrychanges++;
 	}
+	else if (slope->o.z != oldz)
+		geometrychanges++;
 }
 
 /// Mapthing-defined
@@ -137,17 +140,24 @@ void T_DynamicSlopeVert (dynplanethink_t* th)
 
 	size_t i;
 	INT32 l;
+	boolean changed = false;
 
 	for (i = 0; i < 3; i++) {
+		fixed_t z = 0;
 		l = Tag_FindLineSpecial(799, th->tags[i]);
 		if (l != -1) {
-			th->vex[i].z = lines[l].frontsector->floorheight;
+			z = lines[l].frontsector->floorheight;
+		}
+
+		if (th->vex[i].z != z) {
+			th->vex[i].z = z;
+			changed = true;
 		}
-		else
-			th->vex[i].z = 0;
 	}
 
 	ReconfigureViaVertexes(slope, th->vex[0], th->vex[1], th->vex[2]);
+	if (changed)
+		geometrychanges++;
 }
 
 static inline void P_AddDynSlopeThinker (pslope_t* slope, dynplanetype_t type, line_t* sourceline, fixed_t extent, const INT16 tags[3], const vector3_t vx[3])
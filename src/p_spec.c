@@ -1062,6 +1062,7 @@ static void PolyInvisible(line_t *line)
 
 	po->flags |= POF_NOSPECIALS;
 	po->flags &= ~POF_RENDERALL;
+	geometrychanges++;
 }
 
 // Makes a polyobject visible and tangible
@@ -1086,6 +1087,7 @@ static void PolyVisible(line_t *line)
 
 	po->flags &= ~POF_NOSPECIALS;
 	po->flags |= (po->spawnflags & POF_RENDERALL);
+	geometrychanges++;
 }
 
 
@@ -3063,6 +3065,8 @@ static void P_ProcessLineSpecial(line_t *line, mobj_t *mo, sector_t *callsec)
 					if (always || this->midtexture) this->midtexture = set->midtexture;
 					if (always || this->bottomtexture) this->bottomtexture = set->bottomtexture;
 				}
+
+				geometrychanges++;
 			}
 			break;
 
@@ -655,6 +655,7 @@ void P_Ticker(boolean run)
 
 		ps_lua_mobjhooks = 0;
 		ps_checkposition_calls = 0;
+		ps_checksight_calls = 0;
 
 		LUAh_PreThinkFrame();
 
@@ -20,6 +20,7 @@
 #include "r_splats.h"
 #include "p_local.h" // camera
 #include "p_slopes.h"
+#include "p_pvs.h"
 #include "z_zone.h" // Check R_Prep3DFloors
 #include "taglist.h"
 
@@ -39,6 +40,31 @@ drawseg_t *ds_p = NULL;
 // indicates doors closed wrt automap bugfix:
 INT32 doorclosed;
 
+// The subsectors the last traversal of a view reached, in order.
+// If nothing that decides which walls clip solid has changed since,
+// the next traversal from the same spot reaches the same subsectors.
+typedef struct
+{
+	boolean valid; // The list below was recorded from this view
+	fixed_t viewx, viewy, viewz;
+	angle_t viewangle, clipangle;
+	INT32 viewwidth, clipstart, clipend, maxportals;
+	fixed_t mox, moy;
+	UINT8 *pvsrow;
+	UINT32 geometry; // geometrychanges when the list was recorded
+	size_t *subsectors;
+	size_t numsubsectors, maxsubsectors;
+} bspcache_t;
+
+static bspcache_t bspcache[2];
+static bspcache_t *bsprecord = NULL; // Set while a traversal is recorded
+
+// The sectors the view's sector might see, and the nodes that hold any of them.
+// Only set for the main view, not for portals.
+static UINT8 *pvsrow = NULL;
+static UINT8 *pvsnodes = NULL;
+static sector_t *pvsnodesector = NULL;
+
 //
 // R_ClearDrawSegs
 //
@@ -204,6 +230,82 @@ void R_PortalClearClipSegs(INT32 start, INT32 end)
 	newend = solidsegs + 2;
 }
 
+//
+// R_PortalClipClosedColumns
+// Marks the columns of a portal's window that are closed from top to bottom
+// as solid, so its traversal doesn't walk what can only be seen through them.
+// Call once the window is in ceilingclip/floorclip, after R_PortalClearClipSegs.
+//
+void R_PortalClipClosedColumns(INT32 start, INT32 end)
+{
+	cliprange_t after = solidsegs[1];
+	INT32 x = start, first;
+
+	newend = solidsegs + 1;
+
+	while (x < end)
+	{
+		if (floorclip[x] - ceilingclip[x] > 1)
+		{
+			x++;
+			continue;
+		}
+
+		first = x;
+		while (x < end && floorclip[x] - ceilingclip[x] <= 1)
+			x++;
+
+		if (first == (newend-1)->last + 1)
+			(newend-1)->last = x - 1;
+		else if (newend - solidsegs < MAXSEGS/2)
+		{
+			newend->first = first;
+			newend->last = x - 1;
+			newend++;
+		}
+		else // Leave room for the walls; the rest stays open
+			break;
+	}
+
+	if ((newend-1)->last + 1 >= after.first)
+		(newend-1)->last = after.last;
+	else
+		*newend++ = after;
+}
+
+//
+// R_TrimToOpenClipRange
+// Narrows the columns from *first to *last down to the ones
+// that aren't behind a solid wall yet.
+// Returns false if every one of them is.
+//
+boolean R_TrimToOpenClipRange(INT32 *first, INT32 *last)
+{
+	cliprange_t *range;
+
+	for (range = solidsegs; range < newend; range++)
+	{
+		if (range->last < *first)
+			continue;
+		if (range->first > *first)
+			break;
+		if (range->last >= *last)
+			return false;
+		*first = range->last + 1;
+	}
+
+	for (range = newend - 1; range >= solidsegs; range--)
+	{
+		if (range->first > *last)
+			continue;
+		if (range->last < *last)
+			break;
+		*last = range->first - 1;
+	}
+
+	return (*first <= *last);
+}
+
 
 // R_DoorClosed
 //
@@ -1243,6 +1345,10 @@ void R_RenderBSPNode(INT32 bspnum)
 
 	while (!(bspnum & NF_SUBSECTOR))  // Found a subsector?
 	{
+		// Nothing down here can be seen from the view's sector.
+		if (pvsrow && !PVS_CANSEE(pvsnodes, (size_t)bspnum))
+			return;
+
 		bsp = &nodes[bspnum];
 
 		// Decide which side the view point is on.
@@ -1266,5 +1372,162 @@ void R_RenderBSPNode(INT32 bspnum)
 		portalcullsector = NULL;
 	}
 
-	R_Subsector(bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR);
+	bspnum = (bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR);
+
+	if (pvsrow && (size_t)bspnum < numsubsectors
+		&& !PVS_CANSEE(pvsrow, (size_t)(subsectors[bspnum].sector - sectors)))
+		return;
+
+	if (bsprecord)
+	{
+		if (bsprecord->numsubsectors >= bsprecord->maxsubsectors)
+		{
+			bsprecord->maxsubsectors = bsprecord->maxsubsectors ? bsprecord->maxsubsectors * 2 : 256;
+			bsprecord->subsectors = Z_Realloc(bsprecord->subsectors, bsprecord->maxsubsectors * sizeof (*bsprecord->subsectors), PU_STATIC, NULL);
+		}
+		bsprecord->subsectors[bsprecord->numsubsectors++] = (size_t)bspnum;
+	}
+
+	R_Subsector(bspnum);
+}
+
+// Marks the nodes that hold a subsector in a sector the view's sector might see.
+static boolean R_MarkPVSNodes(INT32 bspnum)
+{
+	boolean visible;
+
+	if (bspnum & NF_SUBSECTOR)
+	{
+		bspnum = (bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR);
+		return ((size_t)bspnum < numsubsectors && PVS_CANSEE(pvsrow, (size_t)(subsectors[bspnum].sector - sectors)));
+	}
+
+	visible = R_MarkPVSNodes(nodes[bspnum].children[0]);
+	visible = R_MarkPVSNodes(nodes[bspnum].children[1]) || visible;
+
+	if (visible)
+		pvsnodes[bspnum>>3] |= 1<<(bspnum&7);
+	else
+		pvsnodes[bspnum>>3] &= ~(1<<(bspnum&7));
+
+	return visible;
+}
+
+// Sets up the potentially visible set for the main view.
+// If the view isn't really inside the sector its subsector belongs to,
+// nothing is culled this frame.
+static void R_SetupPVS(void)
+{
+	sector_t *sector = R_PointInSubsector(viewx, viewy)->sector;
+
+	pvsrow = NULL;
+	if (!R_IsPointInSector(sector, viewx, viewy))
+		return;
+
+	pvsrow = P_GetPVSRow(sector);
+	if (!pvsrow)
+		return;
+
+	if (!pvsnodes)
+	{
+		Z_Malloc((numnodes + 7) >> 3, PU_LEVEL, &pvsnodes);
+		pvsnodesector = NULL;
+	}
+
+	if (sector != pvsnodesector)
+	{
+		R_MarkPVSNodes((INT32)numnodes - 1);
+		pvsnodesector = sector;
+	}
+}
+
+//
+// R_ClearBSPCache
+// Forgets every recorded traversal, since they hold subsector numbers
+// of the level that was loaded at the time.
+//
+void R_ClearBSPCache(void)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof bspcache / sizeof *bspcache; i++)
+		bspcache[i].valid = false;
+}
+
+//
+// R_TraverseBSPView
+// With bspcache on, a view that hasn't moved over a map that hasn't changed
+// reuses the subsectors the last traversal reached, instead of walking the
+// nodes and checking their bounding boxes again.
+// A view is only recorded once it has stayed put for a frame,
+// so moving cameras don't pay for recording.
+//
+static void R_TraverseBSPView(bspcache_t *cache)
+{
+	mobj_t *viewmobj = viewplayer ? viewplayer->mo : NULL;
+	fixed_t mox = viewmobj ? viewmobj->x : 0, moy = viewmobj ? viewmobj->y : 0;
+	size_t i;
+
+	if (!cv_bspcache.value)
+	{
+		cache->valid = false;
+		R_RenderBSPNode((INT32)numnodes - 1);
+		return;
+	}
+
+	if (!(cache->viewx == viewx && cache->viewy == viewy && cache->viewz == viewz
+		&& cache->viewangle == viewangle && cache->clipangle == clipangle
+		&& cache->viewwidth == viewwidth
+		&& cache->clipstart == portalclipstart && cache->clipend == portalclipend
+		&& cache->maxportals == cv_maxportals.value
+		&& cache->mox == mox && cache->moy == moy // For R_FakeFlat
+		&& cache->pvsrow == pvsrow))
+	{
+		// The view moved; remember where it is now, and traverse normally.
+		cache->valid = false;
+		R_RenderBSPNode((INT32)numnodes - 1);
+	}
+	else
+	{
+		if (cache->valid && cache->geometry == geometrychanges)
+		{
+			for (i = 0; i < cache->numsubsectors; i++)
+				R_Subsector(cache->subsectors[i]);
+			return;
+		}
+
+		cache->numsubsectors = 0;
+
+		bsprecord = cache;
+		R_RenderBSPNode((INT32)numnodes - 1);
+		bsprecord = NULL;
+
+		cache->geometry = geometrychanges;
+		cache->valid = true;
+	}
+
+	cache->viewx = viewx;
+	cache->viewy = viewy;
+	cache->viewz = viewz;
+	cache->viewangle = viewangle;
+	cache->clipangle = clipangle;
+	cache->viewwidth = viewwidth;
+	cache->clipstart = portalclipstart;
+	cache->clipend = portalclipend;
+	cache->maxportals = cv_maxportals.value;
+	cache->mox = mox;
+	cache->moy = moy;
+	cache->pvsrow = pvsrow;
+}
+
+//
+// R_RenderBSPView
+// Renders the BSP from the main viewpoint,
+// skipping what the view's sector can't possibly see.
+//
+void R_RenderBSPView(INT32 viewnum)
+{
+	R_SetupPVS();
+	R_TraverseBSPView(&bspcache[viewnum]);
+	pvsrow = NULL;
 }
@@ -37,8 +37,12 @@ extern INT32 doorclosed;
 // BSP?
 void R_ClearClipSegs(void);
 void R_PortalClearClipSegs(INT32 start, INT32 end);
+void R_PortalClipClosedColumns(INT32 start, INT32 end);
+boolean R_TrimToOpenClipRange(INT32 *first, INT32 *last);
 void R_ClearDrawSegs(void);
 void R_RenderBSPNode(INT32 bspnum);
+void R_RenderBSPView(INT32 viewnum);
+void R_ClearBSPCache(void);
 
 void R_SortPolyObjects(subsector_t *sub);
 
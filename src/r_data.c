@@ -29,6 +29,8 @@
 #include "f_finale.h" // wipes
 #include "byteptr.h"
 #include "dehacked.h"
+#include "r_skins.h" // skins
+#include "s_sound.h" // S_GetSfxLumpNum
 
 //
 // Graphics.
@@ -1222,6 +1224,131 @@ void R_InitData(void)
 	R_InitColormaps();
 }
 
+// Lumps the level is about to read, for W_PrefetchLumps
+static lumpnum_t *precachelumps = NULL;
+static size_t numprecachelumps = 0, maxprecachelumps = 0;
+
+static void R_AddPrecacheLump(lumpnum_t lump)
+{
+	if (numprecachelumps == maxprecachelumps)
+	{
+		maxprecachelumps = maxprecachelumps ? maxprecachelumps * 2 : 256;
+		precachelumps = Z_Realloc(precachelumps, maxprecachelumps * sizeof (*precachelumps), PU_STATIC, NULL);
+	}
+	precachelumps[numprecachelumps++] = lump;
+}
+
+static void R_AddPrecacheTexture(INT32 texnum)
+{
+	INT32 i;
+
+	if (texnum < 0 || texnum >= numtextures)
+		return;
+
+	for (i = 0; i < textures[texnum]->patchcount; i++)
+		R_AddPrecacheLump((textures[texnum]->patches[i].wad<<16) + textures[texnum]->patches[i].lump);
+}
+
+static void R_AddPrecacheSprite(spritedef_t *sprdef)
+{
+	size_t i, j;
+
+	for (i = 0; i < sprdef->numframes; i++)
+	{
+		spriteframe_t *sf = &sprdef->spriteframes[i];
+
+		// see R_InitSprites for more about lumppat,lumpid
+		if (sf->rotate == SRF_SINGLE)
+			R_AddPrecacheLump(sf->lumppat[0]);
+		else if (sf->rotate == SRF_2D)
+		{
+			R_AddPrecacheLump(sf->lumppat[2]);
+			R_AddPrecacheLump(sf->lumppat[6]);
+		}
+		else
+		{
+			for (j = 0; j < (sf->rotate & SRF_3DGE ? 16 : 8); j++)
+				R_AddPrecacheLump(sf->lumppat[j]);
+		}
+	}
+}
+
+static void R_AddPrecacheSound(sfxenum_t sound)
+{
+	if (sound > sfx_None && sound < NUMSFX && S_sfx[sound].name)
+		R_AddPrecacheLump(S_GetSfxLumpNum(&S_sfx[sound]));
+}
+
+//
+// R_PrefetchLevel
+//
+// Starts pulling the graphics and sounds the level will need into memory
+// in the background, while the rest of the level loads.
+// Must be called once the map data is loaded; W_FinishPrefetch waits for it.
+//
+void R_PrefetchLevel(void)
+{
+	UINT8 *typepresent;
+	size_t i;
+	INT32 j;
+
+	if (rendermode == render_none)
+		return;
+
+	numprecachelumps = 0;
+
+	for (i = 0; i < numlevelflats; i++)
+		if (levelflats[i].type == LEVELFLAT_FLAT)
+			R_AddPrecacheLump(levelflats[i].u.flat.lumpnum);
+
+	for (i = 0; i < numsides; i++)
+	{
+		R_AddPrecacheTexture(sides[i].toptexture);
+		R_AddPrecacheTexture(sides[i].midtexture);
+		R_AddPrecacheTexture(sides[i].bottomtexture);
+	}
+	R_AddPrecacheTexture(skytexture);
+
+	// The things aren't spawned yet; go by the states and sounds of their types
+	typepresent = calloc(NUMMOBJTYPES, sizeof (*typepresent));
+	if (typepresent == NULL) I_Error("%s: Out of memory looking up things", "R_PrefetchLevel");
+
+	for (i = 0; i < nummapthings; i++)
+	{
+		mobjtype_t type = P_GetMobjtype(mapthings[i].type);
+		mobjinfo_t *info = &mobjinfo[type];
+		spritenum_t sprite = states[info->spawnstate].sprite;
+
+		if (type == MT_UNKNOWN || typepresent[type])
+			continue;
+		typepresent[type] = 1;
+
+		if (sprite != SPR_PLAY && sprite < numsprites)
+			R_AddPrecacheSprite(&sprites[sprite]);
+
+		if (!sound_disabled)
+		{
+			R_AddPrecacheSound(info->seesound);
+			R_AddPrecacheSound(info->attacksound);
+			R_AddPrecacheSound(info->painsound);
+			R_AddPrecacheSound(info->deathsound);
+			R_AddPrecacheSound(info->activesound);
+		}
+	}
+	free(typepresent);
+
+	// And the skins of everyone in the game
+	for (i = 0; i < MAXPLAYERS; i++)
+	{
+		if (!playeringame[i] || players[i].skin < 0 || players[i].skin >= numskins)
+			continue;
+		for (j = 0; j < NUMPLAYERSPRITES*2; j++)
+			R_AddPrecacheSprite(&skins[players[i].skin].sprites[j]);
+	}
+
+	W_PrefetchLumps(precachelumps, numprecachelumps);
+}
+
 //
 // R_PrecacheLevel
 //
@@ -1236,6 +1363,9 @@ void R_PrecacheLevel(void)
 	thinker_t *th;
 	spriteframe_t *sf;
 
+	// Whatever R_PrefetchLevel read is in by now
+	W_FinishPrefetch();
+
 	if (demoplayback)
 		return;
 
@@ -1243,12 +1373,6 @@ void R_PrecacheLevel(void)
 	if (rendermode != render_soft)
 		return;
 
-	// Precache flats.
-	flatmemory = P_PrecacheLevelFlats();
-
-	//
-	// Precache textures.
-	//
 	// no need to precache all software textures in 3D mode
 	// (note they are still used with the reference software view)
 	texturepresent = calloc(numtextures, sizeof (*texturepresent));
@@ -1270,6 +1394,39 @@ void R_PrecacheLevel(void)
 	// while the sky texture is stored like a wall texture, with a skynum dependent name.
 	texturepresent[skytexture] = 1;
 
+	spritepresent = calloc(numsprites, sizeof (*spritepresent));
+	if (spritepresent == NULL) I_Error("%s: Out of memory looking up sprites", "R_PrecacheLevel");
+
+	for (th = thlist[THINK_MOBJ].next; th != &thlist[THINK_MOBJ]; th = th->next)
+		if (th->function.acp1 != (actionf_p1)P_RemoveThinkerDelayed)
+			spritepresent[((mobj_t *)th)->sprite] = 1;
+
+	//
+	// Decompress everything below in one parallel batch,
+	// rather than one lump at a time as it gets cached.
+	//
+	numprecachelumps = 0;
+
+	for (i = 0; i < numlevelflats; i++)
+		if (levelflats[i].type == LEVELFLAT_FLAT)
+			R_AddPrecacheLump(levelflats[i].u.flat.lumpnum);
+
+	for (j = 0; j < (unsigned)numtextures; j++)
+		if (texturepresent[j] && !texturecache[j])
+			R_AddPrecacheTexture(j);
+
+	for (i = 0; i < numsprites; i++)
+		if (spritepresent[i])
+			R_AddPrecacheSprite(&sprites[i]);
+
+	W_InflateLumps(precachelumps, numprecachelumps);
+
+	// Precache flats.
+	flatmemory = P_PrecacheLevelFlats();
+
+	//
+	// Precache textures.
+	//
 	texturememory = 0;
 	for (j = 0; j < (unsigned)numtextures; j++)
 	{
@@ -1286,13 +1443,6 @@ void R_PrecacheLevel(void)
 	//
 	// Precache sprites.
 	//
-	spritepresent = calloc(numsprites, sizeof (*spritepresent));
-	if (spritepresent == NULL) I_Error("%s: Out of memory looking up sprites", "R_PrecacheLevel");
-
-	for (th = thlist[THINK_MOBJ].next; th != &thlist[THINK_MOBJ]; th = th->next)
-		if (th->function.acp1 != (actionf_p1)P_RemoveThinkerDelayed)
-			spritepresent[((mobj_t *)th)->sprite] = 1;
-
 	spritememory = 0;
 	for (i = 0; i < numsprites; i++)
 	{
@@ -46,6 +46,7 @@ extern CV_PossibleValue_t Color_cons_t[];
 
 // I/O, setting up the stuff.
 void R_InitData(void);
+void R_PrefetchLevel(void);
 void R_PrecacheLevel(void);
 
 extern size_t flatmemory, spritememory, texturememory;
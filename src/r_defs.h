@@ -30,6 +30,15 @@
 
 #include "taglist.h"
 
+// The Software renderer can draw on several threads when
+// each thread gets its own copy of the drawer state.
+#if defined (HAVE_THREADS) && defined (ATTRTHREADLOCAL)
+#define RENDERTHREADS
+#define DRAWLOCAL ATTRTHREADLOCAL
+#else
+#define DRAWLOCAL
+#endif
+
 //
 // ClipWallSegment
 // Clips the given range of columns
@@ -25,6 +25,15 @@
 #include "w_wad.h"
 #include "z_zone.h"
 #include "console.h" // Until buffering gets finished
+#include "i_system.h"
+
+#ifdef HAVE_THREADS
+#include "i_threads.h"
+#endif
+
+#ifdef SIMDSPANS
+#include <immintrin.h>
+#endif
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -61,13 +70,13 @@ UINT8 *topleft;
 //                      COLUMN DRAWING CODE STUFF
 // =========================================================================
 
-lighttable_t *dc_colormap;
-INT32 dc_x = 0, dc_yl = 0, dc_yh = 0;
+DRAWLOCAL lighttable_t *dc_colormap;
+DRAWLOCAL INT32 dc_x = 0, dc_yl = 0, dc_yh = 0;
 
-fixed_t dc_iscale, dc_texturemid;
-UINT8 dc_hires; // under MSVC boolean is a byte, while on other systems, it a bit,
-               // soo lets make it a byte on all system for the ASM code
-UINT8 *dc_source;
+DRAWLOCAL fixed_t dc_iscale, dc_texturemid;
+DRAWLOCAL UINT8 dc_hires; // under MSVC boolean is a byte, while on other systems, it a bit,
+                         // soo lets make it a byte on all system for the ASM code
+DRAWLOCAL UINT8 *dc_source;
 
 // -----------------------
 // translucency stuff here
@@ -79,7 +88,7 @@ UINT8 *blendtables[NUMBLENDMAPS];
 
 /**	\brief R_DrawTransColumn uses this
 */
-UINT8 *dc_transmap; // one of the translucency tables
+DRAWLOCAL UINT8 *dc_transmap; // one of the translucency tables
 
 // ----------------------
 // translation stuff here
@@ -88,37 +97,57 @@ UINT8 *dc_transmap; // one of the translucency tables
 
 /**	\brief R_DrawTranslatedColumn uses this
 */
-UINT8 *dc_translation;
+DRAWLOCAL UINT8 *dc_translation;
 
 struct r_lightlist_s *dc_lightlist = NULL;
-INT32 dc_numlights = 0, dc_maxlights, dc_texheight;
+INT32 dc_numlights = 0, dc_maxlights;
+DRAWLOCAL INT32 dc_texheight;
 
 // =========================================================================
 //                      SPAN DRAWING CODE STUFF
 // =========================================================================
 
-INT32 ds_y, ds_x1, ds_x2;
-lighttable_t *ds_colormap;
-lighttable_t *ds_translation; // Lactozilla: Sprite splat drawer
+DRAWLOCAL INT32 ds_y, ds_x1, ds_x2;
+DRAWLOCAL lighttable_t *ds_colormap;
+DRAWLOCAL lighttable_t *ds_translation; // Lactozilla: Sprite splat drawer
 
-fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
-INT32 ds_waterofs, ds_bgofs;
+DRAWLOCAL fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
+DRAWLOCAL INT32 ds_waterofs, ds_bgofs;
 
-UINT16 ds_flatwidth, ds_flatheight;
-boolean ds_powersoftwo;
+DRAWLOCAL UINT16 ds_flatwidth, ds_flatheight;
+DRAWLOCAL boolean ds_powersoftwo;
 
-UINT8 *ds_source; // points to the start of a flat
-UINT8 *ds_transmap; // one of the translucency tables
+DRAWLOCAL UINT8 *ds_source; // points to the start of a flat
+DRAWLOCAL UINT8 *ds_transmap; // one of the translucency tables
 
 // Vectors for Software's tilted slope drawers
 floatv3_t *ds_su, *ds_sv, *ds_sz;
-floatv3_t *ds_sup, *ds_svp, *ds_szp;
-float focallengthf, zeroheight;
+DRAWLOCAL floatv3_t *ds_sup, *ds_svp, *ds_szp;
+float focallengthf;
+DRAWLOCAL float zeroheight;
 
 /**	\brief Variable flat sizes
 */
 
-UINT32 nflatxshift, nflatyshift, nflatshiftup, nflatmask;
+DRAWLOCAL UINT32 nflatxshift, nflatyshift, nflatshiftup, nflatmask;
+
+// The view as the drawers see it. The drawers read this instead of the
+// view globals, so that every drawing thread can have its own copy.
+typedef struct
+{
+	fixed_t viewx, viewy;
+	INT32 centerx, centery;
+	fixed_t centeryfrac;
+	lighttable_t **planezlight;
+
+	// Scratch space of the tilted drawers: the light level of each pixel,
+	// and where the colormap of each light level starts
+	INT32 tiltlighting[MAXVIDWIDTH];
+	INT32 tiltlightoffsets[MAXLIGHTSCALE];
+} drawview_t;
+
+static drawview_t maindrawview;
+static DRAWLOCAL drawview_t *drawview = &maindrawview;
 
 // =========================================================================
 //                   TRANSLATION COLORMAP CODE
@@ -134,7 +163,25 @@ UINT32 nflatxshift, nflatyshift, nflatshiftup, nflatmask;
 #define DEFAULT_STARTTRANSCOLOR 96
 #define NUM_PALETTE_ENTRIES 256
 
-static UINT8 **translationtablecache[MAXSKINS + 7] = {NULL};
+#define NUM_TT_CACHE_INDEXES (MAXSKINS + 7)
+
+// Cached colormaps are indexed by cache index and color, so there is at most one table for
+// each pair, and a table never moves or gets reused once it's generated. The tables of a skin
+// are packed into banks, instead of being allocated one by one. Banks are freed when PU_LEVEL
+// blocks are purged.
+#define TT_BANK_TABLES 32
+
+typedef struct ttbank_s
+{
+	UINT8 tables[TT_BANK_TABLES][NUM_PALETTE_ENTRIES];
+	struct ttbank_s *prev;
+} ttbank_t;
+
+static ttbank_t *translationbanks[NUM_TT_CACHE_INDEXES];
+static UINT8 translationbankused[NUM_TT_CACHE_INDEXES];
+
+static UINT8 **translationtablecache[NUM_TT_CACHE_INDEXES] = {NULL};
+
 UINT8 skincolor_modified[MAXSKINCOLORS];
 
 static INT32 SkinToCacheIndex(INT32 skinnum)
@@ -568,6 +615,40 @@ static void R_GenerateTranslationColormap(UINT8 *dest_colormap, INT32 skinnum, U
 }
 
 
+/**	\brief	Takes the next free table out of a skin's banks.
+
+	\param	index	translation cache index of the skin
+
+	\return	Table to generate the colormap into
+*/
+static UINT8 *R_AllocTranslationTable(INT32 index)
+{
+	if (!translationbanks[index] || translationbankused[index] == TT_BANK_TABLES)
+	{
+		ttbank_t *bank = Z_MallocAlign(sizeof(ttbank_t), PU_LEVEL, NULL, 8);
+		bank->prev = translationbanks[index];
+		translationbanks[index] = bank;
+		translationbankused[index] = 0;
+	}
+
+	return translationbanks[index]->tables[translationbankused[index]++];
+}
+
+/**	\brief	Regenerates every cached colormap of a color that was redefined.
+
+	\param	color	translation color
+*/
+static void R_RegenerateTranslationColormaps(UINT16 color)
+{
+	INT32 i;
+
+	for (i = 0; i < NUM_TT_CACHE_INDEXES; i++)
+		if (translationtablecache[i] && translationtablecache[i][color])
+			R_GenerateTranslationColormap(translationtablecache[i][color], CacheIndexToSkin(i), color);
+
+	skincolor_modified[color] = false;
+}
+
 /**	\brief	Retrieves a translation colormap from the cache.
 
 	\param	skinnum	number of skin, TC_DEFAULT or TC_BOSS
@@ -579,41 +660,38 @@ static void R_GenerateTranslationColormap(UINT8 *dest_colormap, INT32 skinnum, U
 UINT8* R_GetTranslationColormap(INT32 skinnum, skincolornum_t color, UINT8 flags)
 {
 	UINT8* ret;
-	INT32 skintableindex = SkinToCacheIndex(skinnum); // Adjust if we want the default colormap
-	INT32 i;
+	INT32 skintableindex;
 
-	if (flags & GTC_CACHE)
+	if (!(flags & GTC_CACHE))
 	{
-		// Allocate table for skin if necessary
-		if (!translationtablecache[skintableindex])
-			translationtablecache[skintableindex] = Z_Calloc(MAXSKINCOLORS * sizeof(UINT8**), PU_STATIC, NULL);
+		ret = Z_MallocAlign(NUM_PALETTE_ENTRIES, PU_STATIC, NULL, 8);
+		R_GenerateTranslationColormap(ret, skinnum, color);
+		return ret;
+	}
 
-		// Get colormap
-		ret = translationtablecache[skintableindex][color];
+	// Rebuild the cache if necessary
+	if (skincolor_modified[color])
+		R_RegenerateTranslationColormaps(color);
 
-		// Rebuild the cache if necessary
-		if (skincolor_modified[color])
-		{
-			for (i = 0; i < (INT32)(sizeof(translationtablecache) / sizeof(translationtablecache[0])); i++)
-				if (translationtablecache[i] && translationtablecache[i][color])
-					R_GenerateTranslationColormap(translationtablecache[i][color], CacheIndexToSkin(i), color);
+	skintableindex = SkinToCacheIndex(skinnum); // Adjust if we want the default colormap
 
-			skincolor_modified[color] = false;
-		}
-	}
-	else ret = NULL;
+	// Allocate table for skin if necessary
+	if (!translationtablecache[skintableindex])
+		translationtablecache[skintableindex] = Z_Calloc(MAXSKINCOLORS * sizeof(UINT8**), PU_STATIC, NULL);
 
-	// Generate the colormap if necessary
-	if (!ret)
+	ret = translationtablecache[skintableindex][color];
+	if (ret)
 	{
-		ret = Z_MallocAlign(NUM_PALETTE_ENTRIES, (flags & GTC_CACHE) ? PU_LEVEL : PU_STATIC, NULL, 8);
-		R_GenerateTranslationColormap(ret, skinnum, color);
-
-		// Cache the colormap if desired
-		if (flags & GTC_CACHE)
-			translationtablecache[skintableindex][color] = ret;
+		ps_translationhits++;
+		return ret;
 	}
 
+	ps_translationmisses++;
+
+	ret = R_AllocTranslationTable(skintableindex);
+	R_GenerateTranslationColormap(ret, skinnum, color);
+	translationtablecache[skintableindex][color] = ret;
+
 	return ret;
 }
 
@@ -629,9 +707,12 @@ void R_FlushTranslationColormapCache(void)
 {
 	INT32 i;
 
-	for (i = 0; i < (INT32)(sizeof(translationtablecache) / sizeof(translationtablecache[0])); i++)
+	for (i = 0; i < NUM_TT_CACHE_INDEXES; i++)
 		if (translationtablecache[i])
 			memset(translationtablecache[i], 0, MAXSKINCOLORS * sizeof(UINT8**));
+
+	memset(translationbanks, 0, sizeof(translationbanks));
+	memset(translationbankused, 0, sizeof(translationbankused));
 }
 
 UINT16 R_GetColorByName(const char *name)
@@ -878,12 +959,942 @@ void R_DrawViewBorder(void)
 }
 #endif
 
+// ==========================================================================
+//                        DEFERRED DRAWING
+// ==========================================================================
+
+// While recording, the column and span drawers aren't called right away.
+// Each call is stored with the drawer state it reads, and the commands are
+// drawn afterwards, either here or by the drawing threads, each of them
+// drawing a band of rows. Rows are split instead of columns so that spans
+// never have to be cut, and what every thread draws is identical to the
+// single-threaded output.
+
+enum
+{
+	DRAWCMD_COLUMN,
+	DRAWCMD_SPAN
+};
+
+typedef struct
+{
+	UINT8 type;
+	UINT8 hires;
+	void (*func)(void);
+	lighttable_t *colormap;
+	UINT8 *source, *transmap, *translation;
+	fixed_t iscale, texturemid, centeryfrac;
+	INT32 x, yl, yh, texheight, centery;
+} columncmd_t;
+
+typedef struct
+{
+	UINT8 type;
+	boolean powersoftwo, tilted;
+	void (*func)(void);
+	lighttable_t *colormap, *translation, **planezlight;
+	UINT8 *source, *transmap;
+	fixed_t xfrac, yfrac, xstep, ystep;
+	INT32 y, x1, x2, waterofs, bgofs;
+	UINT32 nflatxshift, nflatyshift, nflatshiftup, nflatmask;
+	UINT16 flatwidth, flatheight;
+
+	// Read by the tilted drawers
+	floatv3_t su, sv, sz;
+	fixed_t viewx, viewy;
+	INT32 centerx, centery;
+	float zeroheight;
+} spancmd_t;
+
+static boolean drawrecording = false, drawsorting = false;
+
+static UINT8 *drawcmds = NULL;
+static size_t drawcmdsize = 0, drawcmdcapacity = 0;
+
+// Offsets of the commands, in the order they are drawn
+static size_t *drawcmdlist = NULL;
+static size_t numdrawcmds = 0, maxdrawcmds = 0, firstunsortedcmd = 0;
+
+// Memory the drawers may still read, freed once the commands are drawn
+static void **drawfrees = NULL;
+static size_t numdrawfrees = 0, maxdrawfrees = 0;
+
+static void *R_AllocDrawCommand(size_t size)
+{
+	if (drawcmdsize + size > drawcmdcapacity)
+	{
+		drawcmdcapacity = max(drawcmdcapacity * 2, 1<<16);
+		while (drawcmdsize + size > drawcmdcapacity)
+			drawcmdcapacity *= 2;
+		drawcmds = Z_Realloc(drawcmds, drawcmdcapacity, PU_STATIC, &drawcmds);
+	}
+
+	if (numdrawcmds == maxdrawcmds)
+	{
+		maxdrawcmds = max(maxdrawcmds * 2, 1024);
+		drawcmdlist = Z_Realloc(drawcmdlist, maxdrawcmds * sizeof (*drawcmdlist), PU_STATIC, &drawcmdlist);
+	}
+
+	drawcmdlist[numdrawcmds++] = drawcmdsize;
+	drawcmdsize += size;
+	return drawcmds + drawcmdlist[numdrawcmds - 1];
+}
+
+static void R_SaveColumnState(columncmd_t *cmd)
+{
+	cmd->hires = dc_hires;
+	cmd->colormap = dc_colormap;
+	cmd->source = dc_source;
+	cmd->transmap = dc_transmap;
+	cmd->translation = dc_translation;
+	cmd->iscale = dc_iscale;
+	cmd->texturemid = dc_texturemid;
+	cmd->centeryfrac = drawview->centeryfrac;
+	cmd->centery = drawview->centery;
+	cmd->x = dc_x;
+	cmd->yl = dc_yl;
+	cmd->yh = dc_yh;
+	cmd->texheight = dc_texheight;
+}
+
+static void R_LoadColumnState(const columncmd_t *cmd)
+{
+	dc_hires = cmd->hires;
+	dc_colormap = cmd->colormap;
+	dc_source = cmd->source;
+	dc_transmap = cmd->transmap;
+	dc_translation = cmd->translation;
+	dc_iscale = cmd->iscale;
+	dc_texturemid = cmd->texturemid;
+	drawview->centeryfrac = cmd->centeryfrac;
+	drawview->centery = cmd->centery;
+	dc_x = cmd->x;
+	dc_yl = cmd->yl;
+	dc_yh = cmd->yh;
+	dc_texheight = cmd->texheight;
+}
+
+static void R_SaveSpanState(spancmd_t *cmd)
+{
+	cmd->powersoftwo = ds_powersoftwo;
+	cmd->colormap = ds_colormap;
+	cmd->translation = ds_translation;
+	cmd->planezlight = drawview->planezlight;
+	cmd->source = ds_source;
+	cmd->transmap = ds_transmap;
+	cmd->xfrac = ds_xfrac;
+	cmd->yfrac = ds_yfrac;
+	cmd->xstep = ds_xstep;
+	cmd->ystep = ds_ystep;
+	cmd->y = ds_y;
+	cmd->x1 = ds_x1;
+	cmd->x2 = ds_x2;
+	cmd->waterofs = ds_waterofs;
+	cmd->bgofs = ds_bgofs;
+	cmd->nflatxshift = nflatxshift;
+	cmd->nflatyshift = nflatyshift;
+	cmd->nflatshiftup = nflatshiftup;
+	cmd->nflatmask = nflatmask;
+	cmd->flatwidth = ds_flatwidth;
+	cmd->flatheight = ds_flatheight;
+
+	cmd->tilted = (ds_sup && ds_svp && ds_szp);
+	if (cmd->tilted)
+	{
+		cmd->su = *ds_sup;
+		cmd->sv = *ds_svp;
+		cmd->sz = *ds_szp;
+	}
+	cmd->viewx = drawview->viewx;
+	cmd->viewy = drawview->viewy;
+	cmd->centerx = drawview->centerx;
+	cmd->centery = drawview->centery;
+	cmd->zeroheight = zeroheight;
+}
+
+static void R_LoadSpanState(spancmd_t *cmd)
+{
+	ds_powersoftwo = cmd->powersoftwo;
+	ds_colormap = cmd->colormap;
+	ds_translation = cmd->translation;
+	drawview->planezlight = cmd->planezlight;
+	ds_source = cmd->source;
+	ds_transmap = cmd->transmap;
+	ds_xfrac = cmd->xfrac;
+	ds_yfrac = cmd->yfrac;
+	ds_xstep = cmd->xstep;
+	ds_ystep = cmd->ystep;
+	ds_y = cmd->y;
+	ds_x1 = cmd->x1;
+	ds_x2 = cmd->x2;
+	ds_waterofs = cmd->waterofs;
+	ds_bgofs = cmd->bgofs;
+	nflatxshift = cmd->nflatxshift;
+	nflatyshift = cmd->nflatyshift;
+	nflatshiftup = cmd->nflatshiftup;
+	nflatmask = cmd->nflatmask;
+	ds_flatwidth = cmd->flatwidth;
+	ds_flatheight = cmd->flatheight;
+
+	if (cmd->tilted)
+	{
+		ds_sup = &cmd->su;
+		ds_svp = &cmd->sv;
+		ds_szp = &cmd->sz;
+	}
+	else
+		ds_sup = ds_svp = ds_szp = NULL;
+	drawview->viewx = cmd->viewx;
+	drawview->viewy = cmd->viewy;
+	drawview->centerx = cmd->centerx;
+	drawview->centery = cmd->centery;
+	zeroheight = cmd->zeroheight;
+}
+
+// Copies the view the renderer is at into the drawer state of this thread.
+static void R_SetDrawView(void)
+{
+	drawview->viewx = viewx;
+	drawview->viewy = viewy;
+	drawview->centerx = centerx;
+	drawview->centery = centery;
+	drawview->centeryfrac = centeryfrac;
+	drawview->planezlight = planezlight;
+}
+
+/**	\brief Draws the column set up in the dc_ variables, or records it
+	while the drawing commands are being recorded.
+
+	\param	func	column drawer to use
+*/
+void R_CallColumnDrawer(void (*func)(void))
+{
+	columncmd_t *cmd;
+
+	R_SetDrawView();
+
+	// The shadowed drawer cuts the column up and calls back in here
+	// for each piece, which gets recorded as a plain column.
+	if (!drawrecording || func == colfuncs[COLDRAWFUNC_SHADOWED])
+	{
+		func();
+		return;
+	}
+
+	cmd = R_AllocDrawCommand(sizeof (*cmd));
+	cmd->type = DRAWCMD_COLUMN;
+	cmd->func = func;
+	R_SaveColumnState(cmd);
+}
+
+/**	\brief Draws the span set up in the ds_ variables, or records it
+	while the drawing commands are being recorded.
+
+	\param	func	span drawer to use
+*/
+void R_CallSpanDrawer(void (*func)(void))
+{
+	spancmd_t *cmd;
+
+	R_SetDrawView();
+
+	if (!drawrecording)
+	{
+		func();
+		return;
+	}
+
+	cmd = R_AllocDrawCommand(sizeof (*cmd));
+	cmd->type = DRAWCMD_SPAN;
+	cmd->func = func;
+	R_SaveSpanState(cmd);
+}
+
+/**	\brief Frees memory from the zone that a drawer may be reading,
+	once it is safe to do so.
+
+	\param	ptr	memory to free
+*/
+void R_FreeAfterDrawing(void *ptr)
+{
+	if (!drawrecording)
+	{
+		Z_Free(ptr);
+		return;
+	}
+
+	if (numdrawfrees == maxdrawfrees)
+	{
+		maxdrawfrees = max(maxdrawfrees * 2, 64);
+		drawfrees = Z_Realloc(drawfrees, maxdrawfrees * sizeof (*drawfrees), PU_STATIC, &drawfrees);
+	}
+	drawfrees[numdrawfrees++] = ptr;
+}
+
+static sortitem_t *drawsortitems = NULL;
+static size_t maxdrawsortitems = 0;
+
+// Columns sharing a colormap are drawn together, in the order their
+// texture data is laid out in memory. Spans are grouped by flat first,
+// then by colormap.
+static UINT64 R_DrawCommandSortKey(const UINT8 *p)
+{
+	const UINT64 addrmask = (UINT64_C(1) << 47) - 1;
+	UINT64 colormap, source;
+
+	if (*p == DRAWCMD_COLUMN)
+	{
+		const columncmd_t *cmd = (const columncmd_t *)p;
+		colormap = ((size_t)cmd->colormap >> 8) & 0xFFFF;
+		source = (size_t)cmd->source & addrmask;
+		return (colormap << 47) | source;
+	}
+	else
+	{
+		const spancmd_t *cmd = (const spancmd_t *)p;
+		colormap = ((size_t)cmd->colormap >> 8) & 0xFFFF;
+		source = (size_t)cmd->source & addrmask;
+		return (UINT64_C(1) << 63) | (source << 16) | colormap;
+	}
+}
+
+/**	\brief Sorts the commands recorded since the last sort or flush.
+	Only call this after drawing the solid walls and the planes,
+	which never overlap each other, so they can be drawn in any order.
+*/
+void R_SortDrawCommands(void)
+{
+	size_t count = numdrawcmds - firstunsortedcmd;
+
+	if (drawsorting && count > 1)
+	{
+		precise_t time = I_GetPreciseTime();
+		sortitem_t *sorted;
+		size_t i;
+
+		if (count * 2 > maxdrawsortitems)
+		{
+			maxdrawsortitems = count * 2;
+			drawsortitems = Z_Realloc(drawsortitems, maxdrawsortitems * sizeof (*drawsortitems), PU_STATIC, &drawsortitems);
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			drawsortitems[i].index = drawcmdlist[firstunsortedcmd + i];
+			drawsortitems[i].key = R_DrawCommandSortKey(drawcmds + drawsortitems[i].index);
+		}
+
+		// Equal keys keep their recording order
+		sorted = R_RadixSortItems(drawsortitems, drawsortitems + count, count);
+
+		for (i = 0; i < count; i++)
+			drawcmdlist[firstunsortedcmd + i] = sorted[i].index;
+
+		ps_sw_drawsorttime += I_GetPreciseTime() - time;
+	}
+
+	firstunsortedcmd = numdrawcmds;
+}
+
+// Draws every recorded command that touches the rows from top to bottom.
+static INT32 R_RunDrawCommands(INT32 top, INT32 bottom)
+{
+	INT32 count = 0;
+	size_t i;
+
+	for (i = 0; i < numdrawcmds; i++)
+	{
+		UINT8 *p = drawcmds + drawcmdlist[i];
+
+		if (*p == DRAWCMD_COLUMN)
+		{
+			const columncmd_t *cmd = (const columncmd_t *)p;
+
+			if (cmd->yh < top || cmd->yl > bottom)
+				continue;
+
+			// Starting the column further down gives the same
+			// texture coordinates as drawing all of it.
+			R_LoadColumnState(cmd);
+			dc_yl = max(cmd->yl, top);
+			dc_yh = min(cmd->yh, bottom);
+			cmd->func();
+		}
+		else
+		{
+			spancmd_t *cmd = (spancmd_t *)p;
+
+			if (cmd->y < top || cmd->y > bottom)
+				continue;
+
+			R_LoadSpanState(cmd);
+			cmd->func();
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+// Draws the commands on this thread, keeping the dc_ and ds_ state
+// of whoever is recording the rest of the view.
+static void R_RunDrawCommandsHere(void)
+{
+	floatv3_t *sup = ds_sup, *svp = ds_svp, *szp = ds_szp;
+	columncmd_t column;
+	spancmd_t span;
+
+	R_SaveColumnState(&column);
+	R_SaveSpanState(&span);
+
+	R_RunDrawCommands(INT32_MIN, INT32_MAX);
+
+	R_LoadColumnState(&column);
+	R_LoadSpanState(&span);
+	ds_sup = sup;
+	ds_svp = svp;
+	ds_szp = szp;
+}
+
+#ifdef RENDERTHREADS
+typedef struct
+{
+	INT32 top, bottom;
+	UINT32 generation;
+} drawthread_t;
+
+static drawthread_t drawthreads[MAXDRAWTHREADS];
+static drawview_t drawthreadviews[MAXDRAWTHREADS];
+static INT32 numdrawthreads = 0, numdrawthreadsdone = 0;
+static UINT32 drawgeneration = 0;
+static boolean drawquit = false;
+static boolean drawexitfunc = false;
+
+static I_mutex draw_mutex;
+static I_cond  draw_cond;
+static I_cond  draw_done_cond;
+#  define Lock_draw()   I_lock_mutex(&draw_mutex)
+#  define Unlock_draw() I_unlock_mutex(draw_mutex)
+
+// Waits for commands, and draws them in this thread's band of rows.
+static void R_DrawThread(void *userdata)
+{
+	INT32 id = (INT32)(size_t)userdata;
+	drawthread_t *thread = &drawthreads[id];
+	UINT32 generation = thread->generation;
+	boolean quit;
+
+	drawview = &drawthreadviews[id];
+
+	for (;;)
+	{
+		precise_t time;
+
+		Lock_draw();
+		{
+			while (drawgeneration == generation && !drawquit)
+				I_hold_cond(&draw_cond, draw_mutex);
+			generation = drawgeneration;
+			quit = drawquit;
+		}
+		Unlock_draw();
+
+		if (quit)
+			break;
+
+		time = I_GetPreciseTime();
+		ps_sw_drawthreadcmds[id] += R_RunDrawCommands(thread->top, thread->bottom);
+		ps_sw_drawthreadtime[id] += I_GetPreciseTime() - time;
+
+		Lock_draw();
+		{
+			if (++numdrawthreadsdone == numdrawthreads)
+				I_wake_all_cond(&draw_done_cond);
+		}
+		Unlock_draw();
+	}
+
+	Lock_draw();
+	{
+		numdrawthreadsdone++;
+		I_wake_all_cond(&draw_done_cond);
+	}
+	Unlock_draw();
+}
+
+/**	\brief Stops the drawing threads.
+*/
+void R_StopDrawThreads(void)
+{
+	if (!numdrawthreads)
+		return;
+
+	Lock_draw();
+	{
+		drawquit = true;
+		numdrawthreadsdone = 0;
+		I_wake_all_cond(&draw_cond);
+
+		while (numdrawthreadsdone < numdrawthreads)
+			I_hold_cond(&draw_done_cond, draw_mutex);
+
+		numdrawthreads = 0;
+		drawquit = false;
+	}
+	Unlock_draw();
+}
+
+static void R_SetDrawThreads(INT32 count)
+{
+	INT32 i;
+
+	if (count < 2)
+		count = 0;
+	count = min(count, MAXDRAWTHREADS);
+
+	if (count == numdrawthreads)
+		return;
+
+	R_StopDrawThreads();
+
+	if (!drawexitfunc)
+	{
+		I_AddExitFunc(R_StopDrawThreads);
+		drawexitfunc = true;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		drawthreads[i].generation = drawgeneration;
+		I_spawn_thread("draw-rows", R_DrawThread, (void *)(size_t)i);
+	}
+	numdrawthreads = count;
+}
+
+// Hands the commands to the drawing threads, and waits for them.
+static void R_RunDrawThreads(void)
+{
+	INT32 t;
+
+	Lock_draw();
+	{
+		for (t = 0; t < numdrawthreads; t++)
+		{
+			drawthreads[t].top = (t == 0) ? INT32_MIN : t * viewheight / numdrawthreads;
+			drawthreads[t].bottom = (t == numdrawthreads - 1) ? INT32_MAX : (t + 1) * viewheight / numdrawthreads - 1;
+		}
+
+		numdrawthreadsdone = 0;
+		drawgeneration++;
+		I_wake_all_cond(&draw_cond);
+
+		while (numdrawthreadsdone < numdrawthreads)
+			I_hold_cond(&draw_done_cond, draw_mutex);
+	}
+	Unlock_draw();
+}
+#endif
+
+// Frame times of each drawing mode, for drawbench
+static INT32 drawbenchframes = 0, drawbenchmode = 0;
+static INT32 drawbenchcount[NUMDEFERDRAWMODES];
+static precise_t drawbenchtime[NUMDEFERDRAWMODES], drawbenchbest[NUMDEFERDRAWMODES];
+static precise_t drawbenchstart;
+
+/**	\brief Starts recording the drawing commands of a view, if deferred
+	drawing is on or the view is going to be drawn on several threads.
+*/
+void R_StartDrawCommands(void)
+{
+	INT32 mode = cv_deferdraw.value;
+	boolean threads = true;
+#ifdef RENDERTHREADS
+	INT32 i;
+#endif
+
+	if (drawbenchframes)
+	{
+		// Go through the modes frame by frame, so they all see the same scenes
+		drawbenchmode = (drawbenchmode + 1) % NUMDEFERDRAWMODES;
+		mode = drawbenchmode;
+		threads = (mode != DEFERDRAW_OFF);
+		drawbenchstart = I_GetPreciseTime();
+	}
+
+	ps_sw_drawtime = 0;
+	ps_sw_drawsorttime = 0;
+	ps_sw_numdrawcmds = 0;
+
+#ifdef RENDERTHREADS
+	R_SetDrawThreads(cv_renderthreads.value);
+
+	for (i = 0; i < MAXDRAWTHREADS; i++)
+	{
+		ps_sw_drawthreadtime[i] = 0;
+		ps_sw_drawthreadcmds[i] = 0;
+	}
+	ps_sw_numdrawthreads = threads ? numdrawthreads : 0;
+
+	if (ps_sw_numdrawthreads && mode == DEFERDRAW_OFF)
+		mode = DEFERDRAW_ON;
+#else
+	(void)threads;
+#endif
+
+	drawrecording = (mode != DEFERDRAW_OFF);
+	drawsorting = (mode == DEFERDRAW_SORTED);
+}
+
+/**	\brief Draws all of the recorded commands. Anything that reads back
+	the screen must call this first. The time it takes counts towards
+	whatever the caller is timing, such as ps_sw_planetime.
+*/
+void R_FlushDrawCommands(void)
+{
+	size_t i;
+
+	if (!drawrecording)
+		return;
+
+	if (numdrawcmds)
+	{
+#ifdef RENDERTHREADS
+		if (ps_sw_numdrawthreads)
+			R_RunDrawThreads();
+		else
+#endif
+			R_RunDrawCommandsHere();
+
+		ps_sw_numdrawcmds += (int)numdrawcmds;
+	}
+
+	drawcmdsize = 0;
+	numdrawcmds = firstunsortedcmd = 0;
+
+	for (i = 0; i < numdrawfrees; i++)
+		Z_Free(drawfrees[i]);
+	numdrawfrees = 0;
+}
+
+/**	\brief Draws the recorded commands, and stops recording.
+*/
+void R_FinishDrawCommands(void)
+{
+	precise_t flushtime = I_GetPreciseTime();
+
+	R_FlushDrawCommands();
+	drawrecording = drawsorting = false;
+	ps_sw_drawtime += I_GetPreciseTime() - flushtime;
+
+	if (drawbenchframes)
+	{
+		precise_t time = I_GetPreciseTime() - drawbenchstart;
+
+		drawbenchtime[drawbenchmode] += time;
+		if (!drawbenchcount[drawbenchmode]++ || time < drawbenchbest[drawbenchmode])
+			drawbenchbest[drawbenchmode] = time;
+
+		if (drawbenchmode == NUMDEFERDRAWMODES - 1 && !--drawbenchframes)
+		{
+			const char *names[NUMDEFERDRAWMODES] = {"Immediate", "Deferred", "Sorted"};
+			INT32 i;
+
+			CONS_Printf(M_GetText("View drawing times over %d frames:\n"), drawbenchcount[0]);
+			for (i = 0; i < NUMDEFERDRAWMODES; i++)
+				CONS_Printf(M_GetText("%-10s average %6d us, best %6d us\n"), names[i],
+					I_PreciseToMicros(drawbenchtime[i] / drawbenchcount[i]),
+					I_PreciseToMicros(drawbenchbest[i]));
+		}
+	}
+}
+
+/**	\brief Times drawing the view without deferring, with deferring,
+	and with sorted deferring, alternating between them every frame.
+*/
+void Command_Drawbench_f(void)
+{
+	INT32 i;
+
+	if (rendermode != render_soft || gamestate != GS_LEVEL)
+	{
+		CONS_Printf(M_GetText("drawbench [frames]: compare how long the Software renderer takes to draw a level with and without deferred drawing\n"));
+		return;
+	}
+
+	drawbenchframes = (COM_Argc() > 1) ? atoi(COM_Argv(1)) : 100;
+	if (drawbenchframes < 1)
+		drawbenchframes = 1;
+	drawbenchmode = NUMDEFERDRAWMODES - 1;
+
+	for (i = 0; i < NUMDEFERDRAWMODES; i++)
+	{
+		drawbenchcount[i] = 0;
+		drawbenchtime[i] = drawbenchbest[i] = 0;
+	}
+
+	CONS_Printf(M_GetText("Timing the next %d frames in each drawing mode...\n"), drawbenchframes);
+}
+
+// ==========================================================================
+//                               SPAN BENCHMARK
+// ==========================================================================
+
+enum
+{
+	DRAWERISA_C,
+	DRAWERISA_SSE2,
+	DRAWERISA_AVX2,
+	NUMDRAWERISAS
+};
+
+static const char *drawerisanames[NUMDRAWERISAS] = {"C", "SSE2", "AVX2"};
+
+typedef struct
+{
+	const char *name;
+	boolean tilted;
+	void (**slot)(void); // Where the drawer in use is picked from
+	void (*drawers[NUMDRAWERISAS])(void);
+} benchdrawer_t;
+
+#ifdef SIMDSPANS
+#define SIMDSPANS_(sse2, avx2) sse2, avx2
+#else
+#define SIMDSPANS_(sse2, avx2) NULL, NULL
+#endif
+
+static benchdrawer_t benchdrawers[] = {
+	{"Flat", false, &spanfuncs[BASEDRAWFUNC],
+		{R_DrawSpan_8, SIMDSPANS_(R_DrawSpan_8_SSE2, R_DrawSpan_8_AVX2)}},
+	{"Sloped", true, &spanfuncs[SPANDRAWFUNC_TILTED],
+		{R_DrawTiltedSpan_8, SIMDSPANS_(R_DrawTiltedSpan_8_SSE2, R_DrawTiltedSpan_8_AVX2)}},
+	{"Translucent flat", false, &spanfuncs[SPANDRAWFUNC_TRANS],
+		{R_DrawTranslucentSpan_8, SIMDSPANS_(R_DrawTranslucentSpan_8_SSE2, R_DrawTranslucentSpan_8_AVX2)}},
+	{"Translucent sloped", true, &spanfuncs[SPANDRAWFUNC_TILTEDTRANS],
+		{R_DrawTiltedTranslucentSpan_8, SIMDSPANS_(R_DrawTiltedTranslucentSpan_8_SSE2, R_DrawTiltedTranslucentSpan_8_AVX2)}},
+	{"Water", false, &spanfuncs[SPANDRAWFUNC_WATER],
+		{R_DrawTranslucentWaterSpan_8, SIMDSPANS_(R_DrawTranslucentWaterSpan_8_SSE2, R_DrawTranslucentWaterSpan_8_AVX2)}},
+	{"Sloped water", true, &spanfuncs[SPANDRAWFUNC_TILTEDWATER],
+		{R_DrawTiltedTranslucentWaterSpan_8, SIMDSPANS_(R_DrawTiltedTranslucentWaterSpan_8_SSE2, R_DrawTiltedTranslucentWaterSpan_8_AVX2)}},
+};
+
+#undef SIMDSPANS_
+
+#define NUMBENCHDRAWERS (sizeof (benchdrawers) / sizeof (*benchdrawers))
+#define SPANBENCHRUNS 5
+
+typedef struct
+{
+	INT32 y, x1, x2;
+	fixed_t xfrac, yfrac, xstep, ystep, waterofs;
+	lighttable_t *colormap, **planezlight;
+	UINT8 *transmap;
+	floatv3_t su, sv, sz;
+} benchspan_t;
+
+static UINT32 spanbenchseed;
+
+static UINT32 R_SpanBenchRandom(void)
+{
+	spanbenchseed = spanbenchseed * 1103515245 + 12345;
+	return spanbenchseed >> 8;
+}
+
+static float R_SpanBenchRandomFloat(float range)
+{
+	return ((float)(R_SpanBenchRandom() & 0xFFFF) / 32768.0f - 1.0f) * range;
+}
+
+static boolean R_DrawerISAAvailable(INT32 isa)
+{
+	switch (isa)
+	{
+		case DRAWERISA_SSE2:
+			return R_SSE2;
+		case DRAWERISA_AVX2:
+			return R_AVX2;
+		default:
+			return true;
+	}
+}
+
+// Draws every span with the given drawer,
+// and returns how long it took, or a checksum of what it drew.
+static UINT32 R_RunSpanBench(const benchspan_t *spans, INT32 numspans, const benchdrawer_t *bench, void (*drawer)(void), boolean checksum)
+{
+	precise_t time;
+	UINT32 sum = 2166136261u;
+	floatv3_t su, sv, sz;
+	INT32 i, x;
+
+	// The translucent drawers blend with what is already there,
+	// so every checksum has to start from the same picture
+	if (checksum)
+	{
+		for (i = 0; i < viewheight; i++)
+			for (x = 0; x < viewwidth; x++)
+				ylookup[i][columnofs[x]] = (UINT8)(i*7 + x);
+	}
+
+	time = I_GetPreciseTime();
+
+	for (i = 0; i < numspans; i++)
+	{
+		const benchspan_t *span = &spans[i];
+
+		ds_y = span->y;
+		ds_x1 = span->x1;
+		ds_x2 = span->x2;
+		ds_xfrac = span->xfrac;
+		ds_yfrac = span->yfrac;
+		ds_xstep = span->xstep;
+		ds_ystep = span->ystep;
+		ds_waterofs = span->waterofs;
+		ds_colormap = bench->tilted ? colormaps : span->colormap;
+		ds_transmap = span->transmap;
+		drawview->planezlight = span->planezlight;
+		if (bench->tilted)
+		{
+			su = span->su;
+			sv = span->sv;
+			sz = span->sz;
+			ds_sup = &su;
+			ds_svp = &sv;
+			ds_szp = &sz;
+		}
+
+		drawer();
+
+		if (checksum)
+		{
+			const UINT8 *dest = ylookup[span->y] + columnofs[span->x1];
+			for (x = span->x1; x <= span->x2; x++)
+				sum = (sum ^ *dest++) * 16777619u;
+		}
+	}
+
+	return checksum ? sum : (UINT32)I_PreciseToMicros(I_GetPreciseTime() - time);
+}
+
+/**	\brief Times every version of the flat span drawers on the same random
+	spans, and checks that they all draw the same pixels as the C drawers.
+*/
+void Command_Spanbench_f(void)
+{
+	spancmd_t saved;
+	floatv3_t *sup = ds_sup, *svp = ds_svp, *szp = ds_szp;
+	lighttable_t *lightcolormap = zlight[LIGHTLEVELS/2][MAXLIGHTZ/2];
+	benchspan_t *spans;
+	UINT8 *flat;
+	INT32 numspans, i, isa;
+	size_t b;
+
+	if (rendermode != render_soft || !viewwidth || !viewheight)
+	{
+		CONS_Printf(M_GetText("spanbench [spans]: compare how long each version of the Software renderer's flat drawers takes to draw the same spans\n"));
+		return;
+	}
+
+	numspans = (COM_Argc() > 1) ? atoi(COM_Argv(1)) : 20000;
+	if (numspans < 1)
+		numspans = 1;
+
+	R_SaveSpanState(&saved);
+
+	spanbenchseed = 1;
+	flat = Z_Malloc(64*64, PU_STATIC, NULL);
+	for (i = 0; i < 64*64; i++)
+		flat[i] = (UINT8)R_SpanBenchRandom();
+
+	spans = Z_Malloc(numspans * sizeof (*spans), PU_STATIC, NULL);
+	for (i = 0; i < numspans; i++)
+	{
+		benchspan_t *span = &spans[i];
+		INT32 x1 = R_SpanBenchRandom() % viewwidth, x2 = R_SpanBenchRandom() % viewwidth;
+
+		span->y = R_SpanBenchRandom() % viewheight;
+		span->x1 = min(x1, x2);
+		span->x2 = max(x1, x2);
+		span->xfrac = R_SpanBenchRandom();
+		span->yfrac = R_SpanBenchRandom();
+		span->xstep = (INT32)(R_SpanBenchRandom() & 0x3FFFF) - 0x20000;
+		span->ystep = (INT32)(R_SpanBenchRandom() & 0x3FFFF) - 0x20000;
+		span->waterofs = R_SpanBenchRandom();
+		span->colormap = lightcolormap;
+		span->planezlight = scalelight[R_SpanBenchRandom() % LIGHTLEVELS];
+		span->transmap = R_GetTranslucencyTable(1 + R_SpanBenchRandom() % (NUMTRANSMAPS - 1));
+
+		// A plane somewhere in front of the view
+		span->sz.x = R_SpanBenchRandomFloat(0.001f);
+		span->sz.y = R_SpanBenchRandomFloat(0.001f);
+		span->sz.z = 1.0f + R_SpanBenchRandomFloat(0.5f);
+		span->su.x = R_SpanBenchRandomFloat(4096.0f);
+		span->su.y = R_SpanBenchRandomFloat(4096.0f);
+		span->su.z = R_SpanBenchRandomFloat(1048576.0f);
+		span->sv.x = R_SpanBenchRandomFloat(4096.0f);
+		span->sv.y = R_SpanBenchRandomFloat(4096.0f);
+		span->sv.z = R_SpanBenchRandomFloat(1048576.0f);
+	}
+
+	ds_source = flat;
+	ds_flatwidth = ds_flatheight = 64;
+	ds_powersoftwo = true;
+	ds_bgofs = 0;
+	R_CheckFlatLength(64*64);
+	R_SetDrawView();
+	zeroheight = FIXED_TO_FLOAT(viewz) + 64.0f;
+
+	CONS_Printf(M_GetText("Drawing times of %d spans, best of %d runs (* is in use):\n"), numspans, SPANBENCHRUNS);
+	for (b = 0; b < NUMBENCHDRAWERS; b++)
+	{
+		const benchdrawer_t *bench = &benchdrawers[b];
+		char line[256];
+		size_t len;
+		UINT32 reference = 0;
+
+		len = snprintf(line, sizeof line, "%s:", bench->name);
+
+		for (isa = 0; isa < NUMDRAWERISAS; isa++)
+		{
+			void (*drawer)(void) = bench->drawers[isa];
+			UINT32 time = UINT32_MAX, sum;
+
+			if (!drawer || !R_DrawerISAAvailable(isa) || len >= sizeof line)
+				continue;
+
+			// Keep the best of a few runs, to leave out whatever else the system was doing
+			for (i = 0; i < SPANBENCHRUNS; i++)
+				time = min(time, R_RunSpanBench(spans, numspans, bench, drawer, false));
+			sum = R_RunSpanBench(spans, numspans, bench, drawer, true);
+
+			if (isa == DRAWERISA_C)
+				reference = sum;
+
+			len += snprintf(line + len, sizeof line - len, " %s%s %u us%s", drawerisanames[isa],
+				(drawer == *bench->slot) ? "*" : "", time,
+				(sum == reference) ? "" : M_GetText(" \x85(differs from C!)\x80"));
+		}
+
+		CONS_Printf("%s\n", line);
+	}
+
+	Z_Free(spans);
+	Z_Free(flat);
+
+	R_LoadSpanState(&saved);
+	ds_sup = sup;
+	ds_svp = svp;
+	ds_szp = szp;
+}
+
 // ==========================================================================
 //                   INCLUDE 8bpp DRAWING CODE HERE
 // ==========================================================================
 
 #include "r_draw8.c"
 #include "r_draw8_npo2.c"
+#include "r_draw8_simd.c"
 
 // ==========================================================================
 //                   INCLUDE 16bpp DRAWING CODE HERE
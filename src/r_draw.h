@@ -29,42 +29,42 @@ extern UINT8 *topleft;
 // COLUMN DRAWING CODE STUFF
 // -------------------------
 
-extern lighttable_t *dc_colormap;
-extern INT32 dc_x, dc_yl, dc_yh;
-extern fixed_t dc_iscale, dc_texturemid;
-extern UINT8 dc_hires;
+extern DRAWLOCAL lighttable_t *dc_colormap;
+extern DRAWLOCAL INT32 dc_x, dc_yl, dc_yh;
+extern DRAWLOCAL fixed_t dc_iscale, dc_texturemid;
+extern DRAWLOCAL UINT8 dc_hires;
 
-extern UINT8 *dc_source; // first pixel in a column
+extern DRAWLOCAL UINT8 *dc_source; // first pixel in a column
 
 // translucency stuff here
-extern UINT8 *dc_transmap;
+extern DRAWLOCAL UINT8 *dc_transmap;
 
 // translation stuff here
 
-extern UINT8 *dc_translation;
+extern DRAWLOCAL UINT8 *dc_translation;
 
 extern struct r_lightlist_s *dc_lightlist;
 extern INT32 dc_numlights, dc_maxlights;
 
 //Fix TUTIFRUTI
-extern INT32 dc_texheight;
+extern DRAWLOCAL INT32 dc_texheight;
 
 // -----------------------
 // SPAN DRAWING CODE STUFF
 // -----------------------
 
-extern INT32 ds_y, ds_x1, ds_x2;
-extern lighttable_t *ds_colormap;
-extern lighttable_t *ds_translation;
+extern DRAWLOCAL INT32 ds_y, ds_x1, ds_x2;
+extern DRAWLOCAL lighttable_t *ds_colormap;
+extern DRAWLOCAL lighttable_t *ds_translation;
 
-extern fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
-extern INT32 ds_waterofs, ds_bgofs;
+extern DRAWLOCAL fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
+extern DRAWLOCAL INT32 ds_waterofs, ds_bgofs;
 
-extern UINT16 ds_flatwidth, ds_flatheight;
-extern boolean ds_powersoftwo;
+extern DRAWLOCAL UINT16 ds_flatwidth, ds_flatheight;
+extern DRAWLOCAL boolean ds_powersoftwo;
 
-extern UINT8 *ds_source;
-extern UINT8 *ds_transmap;
+extern DRAWLOCAL UINT8 *ds_source;
+extern DRAWLOCAL UINT8 *ds_transmap;
 
 typedef struct {
 	float x, y, z;
@@ -72,14 +72,15 @@ typedef struct {
 
 // Vectors for Software's tilted slope drawers
 extern floatv3_t *ds_su, *ds_sv, *ds_sz;
-extern floatv3_t *ds_sup, *ds_svp, *ds_szp;
-extern float focallengthf, zeroheight;
+extern DRAWLOCAL floatv3_t *ds_sup, *ds_svp, *ds_szp;
+extern float focallengthf;
+extern DRAWLOCAL float zeroheight;
 
 // Variable flat sizes
-extern UINT32 nflatxshift;
-extern UINT32 nflatyshift;
-extern UINT32 nflatshiftup;
-extern UINT32 nflatmask;
+extern DRAWLOCAL UINT32 nflatxshift;
+extern DRAWLOCAL UINT32 nflatyshift;
+extern DRAWLOCAL UINT32 nflatshiftup;
+extern DRAWLOCAL UINT32 nflatmask;
 
 /// \brief Top border
 #define BRDR_T 0
@@ -100,6 +101,33 @@ extern UINT32 nflatmask;
 
 extern lumpnum_t viewborderlump[8];
 
+// ---------------
+// DEFERRED DRAWING
+// ---------------
+
+typedef enum
+{
+	DEFERDRAW_OFF,
+	DEFERDRAW_ON,
+	DEFERDRAW_SORTED,
+	NUMDEFERDRAWMODES
+} deferdrawmode_t;
+
+void R_CallColumnDrawer(void (*func)(void));
+void R_CallSpanDrawer(void (*func)(void));
+void R_FreeAfterDrawing(void *ptr);
+
+void R_StartDrawCommands(void);
+void R_SortDrawCommands(void);
+void R_FlushDrawCommands(void);
+void R_FinishDrawCommands(void);
+#ifdef RENDERTHREADS
+void R_StopDrawThreads(void);
+#endif
+
+void Command_Drawbench_f(void);
+void Command_Spanbench_f(void);
+
 // ------------------------------------------------
 // r_draw.c COMMON ROUTINES FOR BOTH 8bpp and 16bpp
 // ------------------------------------------------
@@ -194,7 +222,6 @@ void R_DrawTiltedFloorSprite_8(void);
 void R_DrawTiltedTranslucentFloorSprite_8(void);
 
 void R_CalcTiltedLighting(fixed_t start, fixed_t end);
-extern INT32 tiltlighting[MAXVIDWIDTH];
 
 void R_DrawTranslucentWaterSpan_8(void);
 void R_DrawTiltedTranslucentWaterSpan_8(void);
@@ -219,6 +246,25 @@ void R_DrawTiltedTranslucentFloorSprite_NPO2_8(void);
 void R_DrawTranslucentWaterSpan_NPO2_8(void);
 void R_DrawTiltedTranslucentWaterSpan_NPO2_8(void);
 
+// SSE2 and AVX2 versions of the flat span drawers, picked at startup
+// depending on what the CPU supports. They draw exactly what the C
+// versions draw.
+#ifdef SIMDSPANS
+void R_DrawSpan_8_SSE2(void);
+void R_DrawTranslucentSpan_8_SSE2(void);
+void R_DrawTiltedSpan_8_SSE2(void);
+void R_DrawTiltedTranslucentSpan_8_SSE2(void);
+void R_DrawTranslucentWaterSpan_8_SSE2(void);
+void R_DrawTiltedTranslucentWaterSpan_8_SSE2(void);
+
+void R_DrawSpan_8_AVX2(void);
+void R_DrawTranslucentSpan_8_AVX2(void);
+void R_DrawTiltedSpan_8_AVX2(void);
+void R_DrawTiltedTranslucentSpan_8_AVX2(void);
+void R_DrawTranslucentWaterSpan_8_AVX2(void);
+void R_DrawTiltedTranslucentWaterSpan_8_AVX2(void);
+#endif
+
 #ifdef USEASM
 void ASMCALL R_DrawColumn_8_ASM(void);
 void ASMCALL R_DrawShadeColumn_8_ASM(void);
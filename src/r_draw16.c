@@ -45,7 +45,7 @@ void R_DrawColumn_16(void)
 
 	// Determine scaling, which is the only mapping to be done.
 	fracstep = dc_iscale;
-	frac = dc_texturemid + (dc_yl - centery)*fracstep;
+	frac = dc_texturemid + (dc_yl - drawview->centery)*fracstep;
 
 	// Inner loop that does the actual texture mapping, e.g. a DDA-like scaling.
 	// This is as fast as it gets.
@@ -84,7 +84,7 @@ void R_DrawWallColumn_16(void)
 	dest = (INT16 *)(void *)(ylookup[dc_yl] + columnofs[dc_x]);
 
 	fracstep = dc_iscale;
-	frac = dc_texturemid + (dc_yl - centery)*fracstep;
+	frac = dc_texturemid + (dc_yl - drawview->centery)*fracstep;
 
 	do
 	{
@@ -123,7 +123,7 @@ void R_DrawTranslucentColumn_16(void)
 
 	// Looks familiar.
 	fracstep = dc_iscale;
-	frac = dc_texturemid + (dc_yl - centery)*fracstep;
+	frac = dc_texturemid + (dc_yl - drawview->centery)*fracstep;
 
 	// Here we do an additional index re-mapping.
 	do
@@ -158,7 +158,7 @@ void R_DrawTranslatedColumn_16(void)
 
 	// Looks familiar.
 	fracstep = dc_iscale;
-	frac = dc_texturemid + (dc_yl - centery)*fracstep;
+	frac = dc_texturemid + (dc_yl - drawview->centery)*fracstep;
 
 	// Here we do an additional index re-mapping.
 	do
@@ -51,7 +51,7 @@ void R_DrawColumn_8(void)
 	// Determine scaling, which is the only mapping to be done.
 	fracstep = dc_iscale;
 	//frac = dc_texturemid + (dc_yl - centery)*fracstep;
-	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - centeryfrac, fracstep))*(!dc_hires);
+	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - drawview->centeryfrac, fracstep))*(!dc_hires);
 
 	// Inner loop that does the actual texture mapping, e.g. a DDA-like scaling.
 	// This is as fast as it gets.
@@ -134,7 +134,7 @@ void R_Draw2sMultiPatchColumn_8(void)
 	// Determine scaling, which is the only mapping to be done.
 	fracstep = dc_iscale;
 	//frac = dc_texturemid + (dc_yl - centery)*fracstep;
-	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - centeryfrac, fracstep))*(!dc_hires);
+	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - drawview->centeryfrac, fracstep))*(!dc_hires);
 
 	// Inner loop that does the actual texture mapping, e.g. a DDA-like scaling.
 	// This is as fast as it gets.
@@ -230,7 +230,7 @@ void R_Draw2sMultiPatchTranslucentColumn_8(void)
 	// Determine scaling, which is the only mapping to be done.
 	fracstep = dc_iscale;
 	//frac = dc_texturemid + (dc_yl - centery)*fracstep;
-	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - centeryfrac, fracstep))*(!dc_hires);
+	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - drawview->centeryfrac, fracstep))*(!dc_hires);
 
 	// Inner loop that does the actual texture mapping, e.g. a DDA-like scaling.
 	// This is as fast as it gets.
@@ -327,7 +327,7 @@ void R_DrawShadeColumn_8(void)
 	// Looks familiar.
 	fracstep = dc_iscale;
 	//frac = dc_texturemid + (dc_yl - centery)*fracstep;
-	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - centeryfrac, fracstep))*(!dc_hires);
+	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - drawview->centeryfrac, fracstep))*(!dc_hires);
 
 	// Here we do an additional index re-mapping.
 	do
@@ -366,7 +366,7 @@ void R_DrawTranslucentColumn_8(void)
 	// Looks familiar.
 	fracstep = dc_iscale;
 	//frac = dc_texturemid + (dc_yl - centery)*fracstep;
-	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - centeryfrac, fracstep))*(!dc_hires);
+	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - drawview->centeryfrac, fracstep))*(!dc_hires);
 
 	// Inner loop that does the actual texture mapping, e.g. a DDA-like scaling.
 	// This is as fast as it gets.
@@ -438,7 +438,7 @@ void R_DrawTranslatedTranslucentColumn_8(void)
 	// Looks familiar.
 	fracstep = dc_iscale;
 	//frac = dc_texturemid + (dc_yl - centery)*fracstep;
-	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - centeryfrac, fracstep))*(!dc_hires);
+	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - drawview->centeryfrac, fracstep))*(!dc_hires);
 
 	// Inner loop that does the actual texture mapping, e.g. a DDA-like scaling.
 	// This is as fast as it gets.
@@ -514,7 +514,7 @@ void R_DrawTranslatedColumn_8(void)
 	// Looks familiar.
 	fracstep = dc_iscale;
 	//frac = dc_texturemid + (dc_yl-centery)*fracstep;
-	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - centeryfrac, fracstep))*(!dc_hires);
+	frac = (dc_texturemid + FixedMul((dc_yl << FRACBITS) - drawview->centeryfrac, fracstep))*(!dc_hires);
 
 	// Here we do an additional index re-mapping.
 	do
@@ -625,7 +625,6 @@ void R_DrawSpan_8 (void)
 
 // R_CalcTiltedLighting
 // Exactly what it says on the tin. I wish I wasn't too lazy to explain things properly.
-INT32 tiltlighting[MAXVIDWIDTH];
 void R_CalcTiltedLighting(fixed_t start, fixed_t end)
 {
 	// ZDoom uses a different lighting setup to us, and I couldn't figure out how to adapt their version
@@ -638,11 +637,11 @@ void R_CalcTiltedLighting(fixed_t start, fixed_t end)
 	// but I'm too bad at coding to not crash the game trying to do that. I guess this is fast enough for now...
 
 	for (i = left; i <= right; i++) {
-		tiltlighting[i] = (start += step) >> FRACBITS;
-		if (tiltlighting[i] < 0)
-			tiltlighting[i] = 0;
-		else if (tiltlighting[i] >= MAXLIGHTSCALE)
-			tiltlighting[i] = MAXLIGHTSCALE-1;
+		drawview->tiltlighting[i] = (start += step) >> FRACBITS;
+		if (drawview->tiltlighting[i] < 0)
+			drawview->tiltlighting[i] = 0;
+		else if (drawview->tiltlighting[i] >= MAXLIGHTSCALE)
+			drawview->tiltlighting[i] = MAXLIGHTSCALE-1;
 	}
 }
 
@@ -666,7 +665,7 @@ void R_DrawTiltedSpan_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -680,8 +679,8 @@ void R_DrawTiltedSpan_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = ds_source;
@@ -693,10 +692,10 @@ void R_DrawTiltedSpan_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 
 		*dest = colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]];
 		dest++;
@@ -726,12 +725,12 @@ void R_DrawTiltedSpan_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			*dest = colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]];
 			dest++;
 			u += stepu;
@@ -747,7 +746,7 @@ void R_DrawTiltedSpan_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			*dest = colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]];
 		}
 		else
@@ -763,12 +762,12 @@ void R_DrawTiltedSpan_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				*dest = colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]];
 				dest++;
 				u += stepu;
@@ -799,7 +798,7 @@ void R_DrawTiltedTranslucentSpan_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -813,8 +812,8 @@ void R_DrawTiltedTranslucentSpan_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = ds_source;
@@ -826,10 +825,10 @@ void R_DrawTiltedTranslucentSpan_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 		*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dest);
 		dest++;
 		iz += ds_szp->x;
@@ -858,12 +857,12 @@ void R_DrawTiltedTranslucentSpan_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dest);
 			dest++;
 			u += stepu;
@@ -879,7 +878,7 @@ void R_DrawTiltedTranslucentSpan_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dest);
 		}
 		else
@@ -895,12 +894,12 @@ void R_DrawTiltedTranslucentSpan_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dest);
 				dest++;
 				u += stepu;
@@ -932,7 +931,7 @@ void R_DrawTiltedTranslucentWaterSpan_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -946,8 +945,8 @@ void R_DrawTiltedTranslucentWaterSpan_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	dsrc = screens[1] + (ds_y+ds_bgofs)*vid.width + ds_x1;
@@ -960,10 +959,10 @@ void R_DrawTiltedTranslucentWaterSpan_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 		*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dsrc++);
 		dest++;
 		iz += ds_szp->x;
@@ -992,12 +991,12 @@ void R_DrawTiltedTranslucentWaterSpan_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dsrc++);
 			dest++;
 			u += stepu;
@@ -1013,7 +1012,7 @@ void R_DrawTiltedTranslucentWaterSpan_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dsrc++);
 		}
 		else
@@ -1029,12 +1028,12 @@ void R_DrawTiltedTranslucentWaterSpan_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				*dest = *(ds_transmap + (colormap[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]] << 8) + *dsrc++);
 				dest++;
 				u += stepu;
@@ -1064,7 +1063,7 @@ void R_DrawTiltedSplat_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -1078,8 +1077,8 @@ void R_DrawTiltedSplat_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = ds_source;
@@ -1091,10 +1090,10 @@ void R_DrawTiltedSplat_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 
 		val = source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)];
 		if (val != TRANSPARENTPIXEL)
@@ -1127,12 +1126,12 @@ void R_DrawTiltedSplat_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			val = source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)];
 			if (val != TRANSPARENTPIXEL)
 				*dest = colormap[val];
@@ -1150,7 +1149,7 @@ void R_DrawTiltedSplat_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			val = source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)];
 			if (val != TRANSPARENTPIXEL)
 				*dest = colormap[val];
@@ -1168,12 +1167,12 @@ void R_DrawTiltedSplat_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				val = source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)];
 				if (val != TRANSPARENTPIXEL)
 					*dest = colormap[val];
@@ -1642,9 +1641,9 @@ void R_DrawTiltedFloorSprite_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = (UINT16 *)ds_source;
@@ -1672,8 +1671,8 @@ void R_DrawTiltedFloorSprite_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
@@ -1712,8 +1711,8 @@ void R_DrawTiltedFloorSprite_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
@@ -1751,9 +1750,9 @@ void R_DrawTiltedTranslucentFloorSprite_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = (UINT16 *)ds_source;
@@ -1781,8 +1780,8 @@ void R_DrawTiltedTranslucentFloorSprite_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
@@ -1821,8 +1820,8 @@ void R_DrawTiltedTranslucentFloorSprite_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
@@ -2123,7 +2122,7 @@ void R_DrawColumnShadowed_8(void)
 
 		if (dc_yh > realyh)
 			dc_yh = realyh;
-		(colfuncs[BASEDRAWFUNC])();		// R_DrawColumn_8 for the appropriate architecture
+		R_CallColumnDrawer(colfuncs[BASEDRAWFUNC]);		// R_DrawColumn_8 for the appropriate architecture
 		if (solid)
 			dc_yl = bheight;
 		else
@@ -2133,5 +2132,5 @@ void R_DrawColumnShadowed_8(void)
 	}
 	dc_yh = realyh;
 	if (dc_yl <= realyh)
-		(colfuncs[BASEDRAWFUNC])();		// R_DrawWallColumn_8 for the appropriate architecture
+		R_CallColumnDrawer(colfuncs[BASEDRAWFUNC]);		// R_DrawWallColumn_8 for the appropriate architecture
 }
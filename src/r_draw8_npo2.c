@@ -106,7 +106,7 @@ void R_DrawTiltedSpan_NPO2_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -120,8 +120,8 @@ void R_DrawTiltedSpan_NPO2_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = ds_source;
@@ -133,15 +133,15 @@ void R_DrawTiltedSpan_NPO2_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 
 		// Lactozilla: Non-powers-of-two
 		{
-			fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-			fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+			fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+			fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 			// Carefully align all of my Friends.
 			if (x < 0)
@@ -181,16 +181,16 @@ void R_DrawTiltedSpan_NPO2_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -217,11 +217,11 @@ void R_DrawTiltedSpan_NPO2_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -248,16 +248,16 @@ void R_DrawTiltedSpan_NPO2_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				// Lactozilla: Non-powers-of-two
 				{
-					fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-					fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+					fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+					fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 					// Carefully align all of my Friends.
 					if (x < 0)
@@ -299,7 +299,7 @@ void R_DrawTiltedTranslucentSpan_NPO2_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -313,8 +313,8 @@ void R_DrawTiltedTranslucentSpan_NPO2_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = ds_source;
@@ -326,14 +326,14 @@ void R_DrawTiltedTranslucentSpan_NPO2_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 		// Lactozilla: Non-powers-of-two
 		{
-			fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-			fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+			fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+			fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 			// Carefully align all of my Friends.
 			if (x < 0)
@@ -373,16 +373,16 @@ void R_DrawTiltedTranslucentSpan_NPO2_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -409,11 +409,11 @@ void R_DrawTiltedTranslucentSpan_NPO2_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -440,16 +440,16 @@ void R_DrawTiltedTranslucentSpan_NPO2_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				// Lactozilla: Non-powers-of-two
 				{
-					fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-					fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+					fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+					fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 					// Carefully align all of my Friends.
 					if (x < 0)
@@ -490,7 +490,7 @@ void R_DrawTiltedSplat_NPO2_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -504,8 +504,8 @@ void R_DrawTiltedSplat_NPO2_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = ds_source;
@@ -517,15 +517,15 @@ void R_DrawTiltedSplat_NPO2_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 
 		// Lactozilla: Non-powers-of-two
 		{
-			fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-			fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+			fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+			fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 			// Carefully align all of my Friends.
 			if (x < 0)
@@ -569,16 +569,16 @@ void R_DrawTiltedSplat_NPO2_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -607,11 +607,11 @@ void R_DrawTiltedSplat_NPO2_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -640,17 +640,17 @@ void R_DrawTiltedSplat_NPO2_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				val = source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)];
 				// Lactozilla: Non-powers-of-two
 				{
-					fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-					fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+					fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+					fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 					// Carefully align all of my Friends.
 					if (x < 0)
@@ -972,9 +972,9 @@ void R_DrawTiltedFloorSprite_NPO2_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = (UINT16 *)ds_source;
@@ -1002,14 +1002,14 @@ void R_DrawTiltedFloorSprite_NPO2_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
 			// Lactozilla: Non-powers-of-two
-			fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-			fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+			fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+			fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 			// Carefully align all of my Friends.
 			if (x < 0)
@@ -1040,8 +1040,8 @@ void R_DrawTiltedFloorSprite_NPO2_8(void)
 			v = (INT64)(startv);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -1070,14 +1070,14 @@ void R_DrawTiltedFloorSprite_NPO2_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
 				// Lactozilla: Non-powers-of-two
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -1122,9 +1122,9 @@ void R_DrawTiltedTranslucentFloorSprite_NPO2_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	source = (UINT16 *)ds_source;
@@ -1152,14 +1152,14 @@ void R_DrawTiltedTranslucentFloorSprite_NPO2_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
 			// Lactozilla: Non-powers-of-two
-			fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-			fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+			fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+			fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 			// Carefully align all of my Friends.
 			if (x < 0)
@@ -1190,8 +1190,8 @@ void R_DrawTiltedTranslucentFloorSprite_NPO2_8(void)
 			v = (INT64)(startv);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -1220,14 +1220,14 @@ void R_DrawTiltedTranslucentFloorSprite_NPO2_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
 				// Lactozilla: Non-powers-of-two
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -1401,7 +1401,7 @@ void R_DrawTiltedTranslucentWaterSpan_NPO2_8(void)
 	double endz, endu, endv;
 	UINT32 stepu, stepv;
 
-	iz = ds_szp->z + ds_szp->y*(centery-ds_y) + ds_szp->x*(ds_x1-centerx);
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
 
 	// Lighting is simple. It's just linear interpolation from start to end
 	{
@@ -1415,8 +1415,8 @@ void R_DrawTiltedTranslucentWaterSpan_NPO2_8(void)
 		//CONS_Printf("tilted lighting %f to %f (foc %f)\n", lightstart, lightend, focallengthf);
 	}
 
-	uz = ds_sup->z + ds_sup->y*(centery-ds_y) + ds_sup->x*(ds_x1-centerx);
-	vz = ds_svp->z + ds_svp->y*(centery-ds_y) + ds_svp->x*(ds_x1-centerx);
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
 
 	dest = ylookup[ds_y] + columnofs[ds_x1];
 	dsrc = screens[1] + (ds_y+ds_bgofs)*vid.width + ds_x1;
@@ -1429,14 +1429,14 @@ void R_DrawTiltedTranslucentWaterSpan_NPO2_8(void)
 	do
 	{
 		double z = 1.f/iz;
-		u = (INT64)(uz*z) + viewx;
-		v = (INT64)(vz*z) + viewy;
+		u = (INT64)(uz*z) + drawview->viewx;
+		v = (INT64)(vz*z) + drawview->viewy;
 
-		colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+		colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 		// Lactozilla: Non-powers-of-two
 		{
-			fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-			fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+			fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+			fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 			// Carefully align all of my Friends.
 			if (x < 0)
@@ -1476,16 +1476,16 @@ void R_DrawTiltedTranslucentWaterSpan_NPO2_8(void)
 		endv = vz*endz;
 		stepu = (INT64)((endu - startu) * INVSPAN);
 		stepv = (INT64)((endv - startv) * INVSPAN);
-		u = (INT64)(startu) + viewx;
-		v = (INT64)(startv) + viewy;
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
 
 		for (i = SPANSIZE-1; i >= 0; i--)
 		{
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -1512,11 +1512,11 @@ void R_DrawTiltedTranslucentWaterSpan_NPO2_8(void)
 		{
 			u = (INT64)(startu);
 			v = (INT64)(startv);
-			colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+			colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 			// Lactozilla: Non-powers-of-two
 			{
-				fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-				fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+				fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+				fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 				// Carefully align all of my Friends.
 				if (x < 0)
@@ -1543,16 +1543,16 @@ void R_DrawTiltedTranslucentWaterSpan_NPO2_8(void)
 			left = 1.f/left;
 			stepu = (INT64)((endu - startu) * left);
 			stepv = (INT64)((endv - startv) * left);
-			u = (INT64)(startu) + viewx;
-			v = (INT64)(startv) + viewy;
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
 
 			for (; width != 0; width--)
 			{
-				colormap = planezlight[tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
+				colormap = drawview->planezlight[drawview->tiltlighting[ds_x1++]] + (ds_colormap - colormaps);
 				// Lactozilla: Non-powers-of-two
 				{
-					fixed_t x = (((fixed_t)u-viewx) >> FRACBITS);
-					fixed_t y = (((fixed_t)v-viewy) >> FRACBITS);
+					fixed_t x = (((fixed_t)u-drawview->viewx) >> FRACBITS);
+					fixed_t y = (((fixed_t)v-drawview->viewy) >> FRACBITS);
 
 					// Carefully align all of my Friends.
 					if (x < 0)
@@ -0,0 +1,632 @@
+// SONIC ROBO BLAST 2
+//-----------------------------------------------------------------------------
+// Copyright (C) 1998-2000 by DooM Legacy Team.
+// Copyright (C) 1999-2021 by Sonic Team Junior.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  r_draw8_simd.c
+/// \brief 8bpp span drawer functions, using SSE2 and AVX2
+/// \note  no includes because this is included as part of r_draw.c
+///        Every drawer here must draw exactly the same pixels as its
+///        C version in r_draw8.c.
+
+#ifdef SIMDSPANS
+
+// ==========================================================================
+// HELPERS
+// ==========================================================================
+
+/**	\brief Computes the flat offsets of four texture positions, the same way
+	R_DrawSpan_8 does for a single one.
+*/
+static inline __m128i R_FlatOffsets_SSE2(__m128i xpos, __m128i ypos, __m128i xshift, __m128i yshift, __m128i mask)
+{
+	return _mm_or_si128(_mm_and_si128(_mm_srl_epi32(ypos, yshift), mask), _mm_srl_epi32(xpos, xshift));
+}
+
+static FUNCTARGET("avx2") inline __m256i R_FlatOffsets_AVX2(__m256i xpos, __m256i ypos, __m128i xshift, __m128i yshift, __m256i mask)
+{
+	return _mm256_or_si256(_mm256_and_si256(_mm256_srl_epi32(ypos, yshift), mask), _mm256_srl_epi32(xpos, xshift));
+}
+
+/**	\brief Reads the bytes at eight offsets from base.
+	Each lane reads the dword that ends at its byte, or the first dword
+	for the first three bytes, so nothing past the wanted byte is read.
+	base must have at least four bytes, which flats, colormaps and
+	translucency tables all do.
+*/
+static FUNCTARGET("avx2") inline __m256i R_GatherBytes_AVX2(const UINT8 *base, __m256i offsets)
+{
+	__m256i addr = _mm256_max_epi32(_mm256_sub_epi32(offsets, _mm256_set1_epi32(3)), _mm256_setzero_si256());
+	__m256i dwords = _mm256_i32gather_epi32((const int *)(const void *)base, addr, 1);
+	__m256i shift = _mm256_slli_epi32(_mm256_sub_epi32(offsets, addr), 3);
+	return _mm256_and_si256(_mm256_srlv_epi32(dwords, shift), _mm256_set1_epi32(0xFF));
+}
+
+/**	\brief Writes eight bytes, one from each lane.
+*/
+static FUNCTARGET("avx2") inline void R_StoreBytes_AVX2(UINT8 *dest, __m256i bytes)
+{
+	__m128i words = _mm_packs_epi32(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1));
+	_mm_storel_epi64((__m128i *)(void *)dest, _mm_packus_epi16(words, words));
+}
+
+// ==========================================================================
+// SPANS
+// ==========================================================================
+
+// How a span's texels are put on the screen
+enum
+{
+	SPANBLEND_NONE, // R_DrawSpan_8
+	SPANBLEND_TRANSLUCENT, // R_DrawTranslucentSpan_8
+	SPANBLEND_WATER, // R_DrawTranslucentWaterSpan_8
+};
+
+/**	\brief Draws the flat span set up in the ds_ variables,
+	stepping through the texture four pixels at a time.
+	Checks the end of the screen exactly where the C drawer of each blend does.
+
+	\param	blend	one of the SPANBLEND_ modes
+*/
+ATTRINLINE static FUNCINLINE void R_DrawSpanBlend_SSE2(INT32 blend)
+{
+	UINT32 xposition, yposition;
+	UINT32 xstep, ystep;
+	UINT32 offsets[8];
+	size_t i;
+
+	UINT8 *source;
+	UINT8 *colormap;
+	UINT8 *dest;
+	UINT8 *dsrc = NULL;
+	const UINT8 *deststop = screens[0] + vid.rowbytes * vid.height;
+
+	size_t count = (ds_x2 - ds_x1 + 1);
+
+	xposition = (UINT32)ds_xfrac << nflatshiftup; yposition = (UINT32)ds_yfrac << nflatshiftup;
+	xstep = (UINT32)ds_xstep << nflatshiftup; ystep = (UINT32)ds_ystep << nflatshiftup;
+
+	source = ds_source;
+	colormap = ds_colormap;
+	dest = ylookup[ds_y] + columnofs[ds_x1];
+
+	if (blend == SPANBLEND_WATER)
+	{
+		yposition = (UINT32)(ds_yfrac + ds_waterofs) << nflatshiftup;
+		dsrc = screens[1] + (ds_y+ds_bgofs)*vid.width + ds_x1;
+	}
+	else if (blend == SPANBLEND_NONE && dest+8 > deststop)
+		return;
+
+	if (count >= 8)
+	{
+		const __m128i xshift = _mm_cvtsi32_si128(nflatxshift), yshift = _mm_cvtsi32_si128(nflatyshift);
+		const __m128i mask = _mm_set1_epi32(nflatmask);
+		const __m128i xstep4 = _mm_set1_epi32(xstep * 4), ystep4 = _mm_set1_epi32(ystep * 4);
+		__m128i xpos = _mm_setr_epi32(xposition, xposition + xstep, xposition + xstep * 2, xposition + xstep * 3);
+		__m128i ypos = _mm_setr_epi32(yposition, yposition + ystep, yposition + ystep * 2, yposition + ystep * 3);
+
+		while (count >= 8)
+		{
+			_mm_storeu_si128((__m128i *)(void *)offsets, R_FlatOffsets_SSE2(xpos, ypos, xshift, yshift, mask));
+			xpos = _mm_add_epi32(xpos, xstep4);
+			ypos = _mm_add_epi32(ypos, ystep4);
+			_mm_storeu_si128((__m128i *)(void *)(offsets + 4), R_FlatOffsets_SSE2(xpos, ypos, xshift, yshift, mask));
+			xpos = _mm_add_epi32(xpos, xstep4);
+			ypos = _mm_add_epi32(ypos, ystep4);
+
+			if (blend == SPANBLEND_WATER)
+			{
+				for (i = 0; i < 8; i++)
+					dest[i] = colormap[*(ds_transmap + (source[offsets[i]] << 8) + dsrc[i])];
+				dsrc += 8;
+			}
+			else if (blend == SPANBLEND_TRANSLUCENT)
+			{
+				for (i = 0; i < 8; i++)
+					dest[i] = *(ds_transmap + (colormap[source[offsets[i]]] << 8) + dest[i]);
+			}
+			else
+			{
+				for (i = 0; i < 8; i++)
+					dest[i] = colormap[source[offsets[i]]];
+			}
+
+			dest += 8;
+			count -= 8;
+		}
+
+		xposition = (UINT32)_mm_cvtsi128_si32(xpos);
+		yposition = (UINT32)_mm_cvtsi128_si32(ypos);
+	}
+	while (count-- && (blend == SPANBLEND_WATER || dest <= deststop))
+	{
+		UINT32 offset = ((yposition >> nflatyshift) & nflatmask) | (xposition >> nflatxshift);
+		if (blend == SPANBLEND_WATER)
+			*dest = colormap[*(ds_transmap + (source[offset] << 8) + *dsrc++)];
+		else if (blend == SPANBLEND_TRANSLUCENT)
+			*dest = *(ds_transmap + (colormap[source[offset]] << 8) + *dest);
+		else
+			*dest = colormap[source[offset]];
+		dest++;
+		xposition += xstep;
+		yposition += ystep;
+	}
+}
+
+/**	\brief Draws the flat span set up in the ds_ variables eight pixels at a time,
+	gathering the texels, the colormap entries and the blended colors.
+
+	\param	blend	one of the SPANBLEND_ modes
+*/
+ATTRINLINE static FUNCTARGET("avx2") FUNCINLINE void R_DrawSpanBlend_AVX2(INT32 blend)
+{
+	UINT32 xposition, yposition;
+	UINT32 xstep, ystep;
+
+	UINT8 *source;
+	UINT8 *colormap;
+	UINT8 *dest;
+	UINT8 *dsrc = NULL;
+	const UINT8 *deststop = screens[0] + vid.rowbytes * vid.height;
+
+	size_t count = (ds_x2 - ds_x1 + 1);
+
+	xposition = (UINT32)ds_xfrac << nflatshiftup; yposition = (UINT32)ds_yfrac << nflatshiftup;
+	xstep = (UINT32)ds_xstep << nflatshiftup; ystep = (UINT32)ds_ystep << nflatshiftup;
+
+	source = ds_source;
+	colormap = ds_colormap;
+	dest = ylookup[ds_y] + columnofs[ds_x1];
+
+	if (blend == SPANBLEND_WATER)
+	{
+		yposition = (UINT32)(ds_yfrac + ds_waterofs) << nflatshiftup;
+		dsrc = screens[1] + (ds_y+ds_bgofs)*vid.width + ds_x1;
+	}
+	else if (blend == SPANBLEND_NONE && dest+8 > deststop)
+		return;
+
+	if (count >= 8)
+	{
+		const __m128i xshift = _mm_cvtsi32_si128(nflatxshift), yshift = _mm_cvtsi32_si128(nflatyshift);
+		const __m256i mask = _mm256_set1_epi32(nflatmask);
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i xstep8 = _mm256_set1_epi32(xstep * 8), ystep8 = _mm256_set1_epi32(ystep * 8);
+		__m256i xpos = _mm256_add_epi32(_mm256_set1_epi32(xposition), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(xstep)));
+		__m256i ypos = _mm256_add_epi32(_mm256_set1_epi32(yposition), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(ystep)));
+
+		while (count >= 8)
+		{
+			__m256i texels = R_GatherBytes_AVX2(source, R_FlatOffsets_AVX2(xpos, ypos, xshift, yshift, mask));
+
+			if (blend == SPANBLEND_WATER)
+			{
+				__m256i backs = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)dsrc));
+				__m256i blended = R_GatherBytes_AVX2(ds_transmap, _mm256_add_epi32(_mm256_slli_epi32(texels, 8), backs));
+				R_StoreBytes_AVX2(dest, R_GatherBytes_AVX2(colormap, blended));
+				dsrc += 8;
+			}
+			else if (blend == SPANBLEND_TRANSLUCENT)
+			{
+				__m256i colors = R_GatherBytes_AVX2(colormap, texels);
+				__m256i backs = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)dest));
+				R_StoreBytes_AVX2(dest, R_GatherBytes_AVX2(ds_transmap, _mm256_add_epi32(_mm256_slli_epi32(colors, 8), backs)));
+			}
+			else
+				R_StoreBytes_AVX2(dest, R_GatherBytes_AVX2(colormap, texels));
+
+			xpos = _mm256_add_epi32(xpos, xstep8);
+			ypos = _mm256_add_epi32(ypos, ystep8);
+
+			dest += 8;
+			count -= 8;
+		}
+
+		xposition = (UINT32)_mm_cvtsi128_si32(_mm256_castsi256_si128(xpos));
+		yposition = (UINT32)_mm_cvtsi128_si32(_mm256_castsi256_si128(ypos));
+	}
+	while (count-- && (blend == SPANBLEND_WATER || dest <= deststop))
+	{
+		UINT32 offset = ((yposition >> nflatyshift) & nflatmask) | (xposition >> nflatxshift);
+		if (blend == SPANBLEND_WATER)
+			*dest = colormap[*(ds_transmap + (source[offset] << 8) + *dsrc++)];
+		else if (blend == SPANBLEND_TRANSLUCENT)
+			*dest = *(ds_transmap + (colormap[source[offset]] << 8) + *dest);
+		else
+			*dest = colormap[source[offset]];
+		dest++;
+		xposition += xstep;
+		yposition += ystep;
+	}
+}
+
+/**	\brief The R_DrawSpan_8_SSE2 function
+	Like R_DrawSpan_8, but steps through the texture four pixels at a time.
+*/
+void R_DrawSpan_8_SSE2(void)
+{
+	R_DrawSpanBlend_SSE2(SPANBLEND_NONE);
+}
+
+void R_DrawTranslucentSpan_8_SSE2(void)
+{
+	R_DrawSpanBlend_SSE2(SPANBLEND_TRANSLUCENT);
+}
+
+void R_DrawTranslucentWaterSpan_8_SSE2(void)
+{
+	R_DrawSpanBlend_SSE2(SPANBLEND_WATER);
+}
+
+/**	\brief The R_DrawSpan_8_AVX2 function
+	Like R_DrawSpan_8, but draws eight pixels at a time,
+	gathering the texels and the colormap entries.
+*/
+FUNCTARGET("avx2") void R_DrawSpan_8_AVX2(void)
+{
+	R_DrawSpanBlend_AVX2(SPANBLEND_NONE);
+}
+
+FUNCTARGET("avx2") void R_DrawTranslucentSpan_8_AVX2(void)
+{
+	R_DrawSpanBlend_AVX2(SPANBLEND_TRANSLUCENT);
+}
+
+FUNCTARGET("avx2") void R_DrawTranslucentWaterSpan_8_AVX2(void)
+{
+	R_DrawSpanBlend_AVX2(SPANBLEND_WATER);
+}
+
+/**	\brief Like R_CalcTiltedLighting, but fills in four pixels at a time.
+*/
+static void R_CalcTiltedLighting_SSE2(fixed_t start, fixed_t end)
+{
+	INT32 left = ds_x1, right = ds_x2;
+	fixed_t step = (end-start)/(ds_x2-ds_x1+1);
+	INT32 i = left;
+
+	if (right - left + 1 >= 4)
+	{
+		const __m128i step4 = _mm_set1_epi32((UINT32)step * 4);
+		const __m128i maxlight = _mm_set1_epi32(MAXLIGHTSCALE-1);
+		__m128i light = _mm_setr_epi32((UINT32)start + (UINT32)step, (UINT32)start + (UINT32)step * 2,
+			(UINT32)start + (UINT32)step * 3, (UINT32)start + (UINT32)step * 4);
+
+		for (; i + 3 <= right; i += 4)
+		{
+			__m128i level = _mm_srai_epi32(light, FRACBITS);
+			__m128i over = _mm_cmpgt_epi32(level, maxlight);
+			level = _mm_andnot_si128(_mm_srai_epi32(level, 31), level);
+			level = _mm_or_si128(_mm_and_si128(over, maxlight), _mm_andnot_si128(over, level));
+			_mm_storeu_si128((__m128i *)(void *)(drawview->tiltlighting + i), level);
+			light = _mm_add_epi32(light, step4);
+		}
+
+		start = (fixed_t)((UINT32)_mm_cvtsi128_si32(light) - (UINT32)step);
+	}
+
+	for (; i <= right; i++)
+	{
+		drawview->tiltlighting[i] = (start += step) >> FRACBITS;
+		if (drawview->tiltlighting[i] < 0)
+			drawview->tiltlighting[i] = 0;
+		else if (drawview->tiltlighting[i] >= MAXLIGHTSCALE)
+			drawview->tiltlighting[i] = MAXLIGHTSCALE-1;
+	}
+}
+
+// Draws count pixels of a sloped span, from screen column x onwards,
+// stepping linearly through the texture.
+typedef void (*tiltedspanrun_t)(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count);
+
+/**	\brief Draws the sloped span set up in the ds_ variables.
+	Does all of the perspective math exactly like R_DrawTiltedSpan_8,
+	and leaves the drawing of each piece in between to run.
+*/
+static void R_DrawTiltedSpanRuns(tiltedspanrun_t run)
+{
+	// x1, x2 = ds_x1, ds_x2
+	int width = ds_x2 - ds_x1;
+	double iz, uz, vz;
+	UINT32 u, v;
+
+	UINT8 *dest;
+
+	double startz, startu, startv;
+	double izstep, uzstep, vzstep;
+	double endz, endu, endv;
+	UINT32 stepu, stepv;
+
+	iz = ds_szp->z + ds_szp->y*(drawview->centery-ds_y) + ds_szp->x*(ds_x1-drawview->centerx);
+
+	// Lighting is simple. It's just linear interpolation from start to end
+	{
+		float planelightfloat = PLANELIGHTFLOAT;
+		float lightstart, lightend;
+
+		lightend = (iz + ds_szp->x*width) * planelightfloat;
+		lightstart = iz * planelightfloat;
+
+		R_CalcTiltedLighting_SSE2(FLOAT_TO_FIXED(lightstart), FLOAT_TO_FIXED(lightend));
+	}
+
+	uz = ds_sup->z + ds_sup->y*(drawview->centery-ds_y) + ds_sup->x*(ds_x1-drawview->centerx);
+	vz = ds_svp->z + ds_svp->y*(drawview->centery-ds_y) + ds_svp->x*(ds_x1-drawview->centerx);
+
+	dest = ylookup[ds_y] + columnofs[ds_x1];
+
+	startz = 1.f/iz;
+	startu = uz*startz;
+	startv = vz*startz;
+
+	izstep = ds_szp->x * SPANSIZE;
+	uzstep = ds_sup->x * SPANSIZE;
+	vzstep = ds_svp->x * SPANSIZE;
+	width++;
+
+	while (width >= SPANSIZE)
+	{
+		iz += izstep;
+		uz += uzstep;
+		vz += vzstep;
+
+		endz = 1.f/iz;
+		endu = uz*endz;
+		endv = vz*endz;
+		stepu = (INT64)((endu - startu) * INVSPAN);
+		stepv = (INT64)((endv - startv) * INVSPAN);
+		u = (INT64)(startu) + drawview->viewx;
+		v = (INT64)(startv) + drawview->viewy;
+
+		run(dest, ds_x1, u, v, stepu, stepv, SPANSIZE);
+		dest += SPANSIZE;
+		ds_x1 += SPANSIZE;
+
+		startu = endu;
+		startv = endv;
+		width -= SPANSIZE;
+	}
+	if (width > 0)
+	{
+		if (width == 1)
+		{
+			u = (INT64)(startu);
+			v = (INT64)(startv);
+			run(dest, ds_x1++, u, v, 0, 0, 1);
+		}
+		else
+		{
+			double left = width;
+			iz += ds_szp->x * left;
+			uz += ds_sup->x * left;
+			vz += ds_svp->x * left;
+
+			endz = 1.f/iz;
+			endu = uz*endz;
+			endv = vz*endz;
+			left = 1.f/left;
+			stepu = (INT64)((endu - startu) * left);
+			stepv = (INT64)((endv - startv) * left);
+			u = (INT64)(startu) + drawview->viewx;
+			v = (INT64)(startv) + drawview->viewy;
+
+			run(dest, ds_x1, u, v, stepu, stepv, width);
+			ds_x1 += width;
+		}
+	}
+}
+
+/**	\brief Draws count pixels of a sloped span four at a time.
+
+	\param	blend	one of the SPANBLEND_ modes
+*/
+ATTRINLINE static FUNCINLINE void R_TiltedSpanPixels_SSE2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count, INT32 blend)
+{
+	const UINT8 *source = ds_source;
+	const ptrdiff_t colormapofs = ds_colormap - colormaps;
+	const UINT8 *dsrc = NULL;
+	UINT32 offsets[4];
+	INT32 i;
+
+	if (blend == SPANBLEND_WATER)
+		dsrc = screens[1] + (ds_y+ds_bgofs)*vid.width + x;
+
+	if (count >= 4)
+	{
+		const __m128i ushift = _mm_cvtsi32_si128(nflatxshift), vshift = _mm_cvtsi32_si128(nflatyshift);
+		const __m128i mask = _mm_set1_epi32(nflatmask);
+		const __m128i ustep4 = _mm_set1_epi32(stepu * 4), vstep4 = _mm_set1_epi32(stepv * 4);
+		__m128i upos = _mm_setr_epi32(u, u + stepu, u + stepu * 2, u + stepu * 3);
+		__m128i vpos = _mm_setr_epi32(v, v + stepv, v + stepv * 2, v + stepv * 3);
+
+		do
+		{
+			_mm_storeu_si128((__m128i *)(void *)offsets, R_FlatOffsets_SSE2(upos, vpos, ushift, vshift, mask));
+			upos = _mm_add_epi32(upos, ustep4);
+			vpos = _mm_add_epi32(vpos, vstep4);
+
+			for (i = 0; i < 4; i++)
+			{
+				UINT8 color = (drawview->planezlight[drawview->tiltlighting[x + i]] + colormapofs)[source[offsets[i]]];
+				if (blend == SPANBLEND_WATER)
+					dest[i] = *(ds_transmap + (color << 8) + dsrc[i]);
+				else if (blend == SPANBLEND_TRANSLUCENT)
+					dest[i] = *(ds_transmap + (color << 8) + dest[i]);
+				else
+					dest[i] = color;
+			}
+
+			dest += 4;
+			if (blend == SPANBLEND_WATER)
+				dsrc += 4;
+			x += 4;
+			count -= 4;
+		} while (count >= 4);
+
+		u = (UINT32)_mm_cvtsi128_si32(upos);
+		v = (UINT32)_mm_cvtsi128_si32(vpos);
+	}
+	for (; count > 0; count--)
+	{
+		UINT8 color = (drawview->planezlight[drawview->tiltlighting[x++]] + colormapofs)[source[((v >> nflatyshift) & nflatmask) | (u >> nflatxshift)]];
+		if (blend == SPANBLEND_WATER)
+			*dest = *(ds_transmap + (color << 8) + *dsrc++);
+		else if (blend == SPANBLEND_TRANSLUCENT)
+			*dest = *(ds_transmap + (color << 8) + *dest);
+		else
+			*dest = color;
+		dest++;
+		u += stepu;
+		v += stepv;
+	}
+}
+
+/**	\brief Draws count pixels of a sloped span eight at a time,
+	gathering the texels, the colormap entries and the blended colors.
+
+	\param	blend	one of the SPANBLEND_ modes
+*/
+ATTRINLINE static FUNCTARGET("avx2") FUNCINLINE void R_TiltedSpanPixels_AVX2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count, INT32 blend)
+{
+	const UINT8 *dsrc = NULL;
+
+	if (blend == SPANBLEND_WATER)
+		dsrc = screens[1] + (ds_y+ds_bgofs)*vid.width + x;
+
+	if (count >= 8)
+	{
+		const __m128i ushift = _mm_cvtsi32_si128(nflatxshift), vshift = _mm_cvtsi32_si128(nflatyshift);
+		const __m256i mask = _mm256_set1_epi32(nflatmask);
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i ustep8 = _mm256_set1_epi32(stepu * 8), vstep8 = _mm256_set1_epi32(stepv * 8);
+		__m256i upos = _mm256_add_epi32(_mm256_set1_epi32(u), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(stepu)));
+		__m256i vpos = _mm256_add_epi32(_mm256_set1_epi32(v), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(stepv)));
+
+		do
+		{
+			__m256i texels = R_GatherBytes_AVX2(ds_source, R_FlatOffsets_AVX2(upos, vpos, ushift, vshift, mask));
+			__m256i lights = _mm256_loadu_si256((const __m256i *)(const void *)(drawview->tiltlighting + x));
+			__m256i maps = _mm256_i32gather_epi32((const int *)drawview->tiltlightoffsets, lights, 4);
+			__m256i colors = R_GatherBytes_AVX2(ds_colormap, _mm256_add_epi32(maps, texels));
+
+			if (blend == SPANBLEND_NONE)
+				R_StoreBytes_AVX2(dest, colors);
+			else
+			{
+				const UINT8 *back = (blend == SPANBLEND_WATER) ? dsrc : dest;
+				__m256i backs = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)back));
+				R_StoreBytes_AVX2(dest, R_GatherBytes_AVX2(ds_transmap, _mm256_add_epi32(_mm256_slli_epi32(colors, 8), backs)));
+			}
+			upos = _mm256_add_epi32(upos, ustep8);
+			vpos = _mm256_add_epi32(vpos, vstep8);
+
+			dest += 8;
+			if (blend == SPANBLEND_WATER)
+				dsrc += 8;
+			x += 8;
+			count -= 8;
+		} while (count >= 8);
+
+		u = (UINT32)_mm_cvtsi128_si32(_mm256_castsi256_si128(upos));
+		v = (UINT32)_mm_cvtsi128_si32(_mm256_castsi256_si128(vpos));
+	}
+	if (count > 0)
+		R_TiltedSpanPixels_SSE2(dest, x, u, v, stepu, stepv, count, blend);
+}
+
+static void R_TiltedSpanRun_SSE2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count)
+{
+	R_TiltedSpanPixels_SSE2(dest, x, u, v, stepu, stepv, count, SPANBLEND_NONE);
+}
+
+static void R_TiltedTranslucentSpanRun_SSE2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count)
+{
+	R_TiltedSpanPixels_SSE2(dest, x, u, v, stepu, stepv, count, SPANBLEND_TRANSLUCENT);
+}
+
+static void R_TiltedWaterSpanRun_SSE2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count)
+{
+	R_TiltedSpanPixels_SSE2(dest, x, u, v, stepu, stepv, count, SPANBLEND_WATER);
+}
+
+static FUNCTARGET("avx2") void R_TiltedSpanRun_AVX2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count)
+{
+	R_TiltedSpanPixels_AVX2(dest, x, u, v, stepu, stepv, count, SPANBLEND_NONE);
+}
+
+static FUNCTARGET("avx2") void R_TiltedTranslucentSpanRun_AVX2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count)
+{
+	R_TiltedSpanPixels_AVX2(dest, x, u, v, stepu, stepv, count, SPANBLEND_TRANSLUCENT);
+}
+
+static FUNCTARGET("avx2") void R_TiltedWaterSpanRun_AVX2(UINT8 *dest, INT32 x, UINT32 u, UINT32 v, UINT32 stepu, UINT32 stepv, INT32 count)
+{
+	R_TiltedSpanPixels_AVX2(dest, x, u, v, stepu, stepv, count, SPANBLEND_WATER);
+}
+
+/**	\brief Draws a sloped span with run, after working out the colormap
+	offsets it needs. Falls back to fallback if they don't fit.
+*/
+static void R_DrawTiltedSpanRuns_AVX2(tiltedspanrun_t run, tiltedspanrun_t fallback)
+{
+	INT32 i;
+
+	// All of a plane's light levels point into the same colormap table,
+	// so each of them can be turned into an offset from the first one.
+	for (i = 0; i < MAXLIGHTSCALE; i++)
+	{
+		ptrdiff_t offset = drawview->planezlight[i] - colormaps;
+		if (offset < -(1<<30) || offset > (1<<30))
+		{
+			R_DrawTiltedSpanRuns(fallback);
+			return;
+		}
+		drawview->tiltlightoffsets[i] = (INT32)offset;
+	}
+
+	R_DrawTiltedSpanRuns(run);
+}
+
+/**	\brief The R_DrawTiltedSpan_8_SSE2 function
+	Like R_DrawTiltedSpan_8, but steps through the texture four pixels at a time.
+*/
+void R_DrawTiltedSpan_8_SSE2(void)
+{
+	R_DrawTiltedSpanRuns(R_TiltedSpanRun_SSE2);
+}
+
+void R_DrawTiltedTranslucentSpan_8_SSE2(void)
+{
+	R_DrawTiltedSpanRuns(R_TiltedTranslucentSpanRun_SSE2);
+}
+
+void R_DrawTiltedTranslucentWaterSpan_8_SSE2(void)
+{
+	R_DrawTiltedSpanRuns(R_TiltedWaterSpanRun_SSE2);
+}
+
+/**	\brief The R_DrawTiltedSpan_8_AVX2 function
+	Like R_DrawTiltedSpan_8, but draws eight pixels at a time,
+	gathering the texels and the colormap entries.
+*/
+void R_DrawTiltedSpan_8_AVX2(void)
+{
+	R_DrawTiltedSpanRuns_AVX2(R_TiltedSpanRun_AVX2, R_TiltedSpanRun_SSE2);
+}
+
+void R_DrawTiltedTranslucentSpan_8_AVX2(void)
+{
+	R_DrawTiltedSpanRuns_AVX2(R_TiltedTranslucentSpanRun_AVX2, R_TiltedTranslucentSpanRun_SSE2);
+}
+
+void R_DrawTiltedTranslucentWaterSpan_8_AVX2(void)
+{
+	R_DrawTiltedSpanRuns_AVX2(R_TiltedWaterSpanRun_AVX2, R_TiltedWaterSpanRun_SSE2);
+}
+
+#endif // SIMDSPANS
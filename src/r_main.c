@@ -34,6 +34,7 @@
 #include "m_random.h" // quake camera shake
 #include "r_portal.h"
 #include "r_main.h"
+#include "p_pvs.h" // cv_pvs
 #include "i_system.h" // I_GetPreciseTime
 
 #ifdef HWRENDER
@@ -58,7 +59,8 @@ size_t validcount = 1;
 
 INT32 centerx, centery;
 
-fixed_t centerxfrac, centeryfrac;
+fixed_t centerxfrac;
+fixed_t centeryfrac;
 fixed_t projection;
 fixed_t projectiony; // aspect ratio
 fixed_t fovtan; // field of view
@@ -103,6 +105,8 @@ extracolormap_t *extra_colormaps = NULL;
 precise_t ps_prevframetime = 0;
 precise_t ps_rendercalltime = 0;
 precise_t ps_uitime = 0;
+int ps_hudpatchdraws = 0;
+int ps_hudpatchreuses = 0;
 precise_t ps_swaptime = 0;
 
 precise_t ps_bsptime = 0;
@@ -111,6 +115,27 @@ precise_t ps_sw_spritecliptime = 0;
 precise_t ps_sw_portaltime = 0;
 precise_t ps_sw_planetime = 0;
 precise_t ps_sw_maskedtime = 0;
+precise_t ps_sw_spritesorttime = 0;
+precise_t ps_sw_drawtime = 0;
+precise_t ps_sw_drawsorttime = 0;
+
+int ps_sw_numdrawthreads = 0;
+int ps_sw_numdrawcmds = 0;
+int ps_sw_drawsegvisits = 0;
+int ps_sw_numvisplanes = 0;
+int ps_sw_planefinds = 0;
+int ps_sw_planeprobes = 0;
+int ps_texturegens = 0;
+int ps_translationhits = 0;
+int ps_translationmisses = 0;
+precise_t ps_sw_drawthreadtime[MAXDRAWTHREADS];
+int ps_sw_drawthreadcmds[MAXDRAWTHREADS];
+
+int ps_sw_numportals = 0;
+int ps_sw_portalsculled = 0;
+int ps_sw_portalsmerged = 0;
+precise_t ps_sw_portalbsptime[MAXPORTALSTATS];
+int ps_sw_portalviewarea[MAXPORTALSTATS];
 
 int ps_numbspcalls = 0;
 int ps_numsprites = 0;
@@ -133,7 +158,12 @@ static CV_PossibleValue_t drawdist_precip_cons_t[] = {
 static CV_PossibleValue_t fov_cons_t[] = {{60*FRACUNIT, "MIN"}, {179*FRACUNIT, "MAX"}, {0, NULL}};
 static CV_PossibleValue_t translucenthud_cons_t[] = {{0, "MIN"}, {10, "MAX"}, {0, NULL}};
 static CV_PossibleValue_t maxportals_cons_t[] = {{0, "MIN"}, {12, "MAX"}, {0, NULL}}; // lmao rendering 32 portals, you're a card
+static CV_PossibleValue_t portalbudget_cons_t[] = {{0, "MIN"}, {1000, "MAX"}, {0, NULL}};
 static CV_PossibleValue_t homremoval_cons_t[] = {{0, "No"}, {1, "Yes"}, {2, "Flash"}, {0, NULL}};
+static CV_PossibleValue_t renderthreads_cons_t[] = {{1, "MIN"}, {MAXDRAWTHREADS, "MAX"}, {0, NULL}};
+static CV_PossibleValue_t texturecachesize_cons_t[] = {{8, "MIN"}, {4096, "MAX"}, {0, NULL}};
+static CV_PossibleValue_t spritecrowd_cons_t[] = {{0, "MIN"}, {MAXVISSPRITES, "MAX"}, {0, NULL}};
+static CV_PossibleValue_t deferdraw_cons_t[] = {{DEFERDRAW_OFF, "Off"}, {DEFERDRAW_ON, "On"}, {DEFERDRAW_SORTED, "Sorted"}, {0, NULL}};
 
 static void Fov_OnChange(void);
 static void ChaseCam_OnChange(void);
@@ -168,6 +198,24 @@ consvar_t cv_homremoval = CVAR_INIT ("homremoval", "No", CV_SAVE, homremoval_con
 
 consvar_t cv_maxportals = CVAR_INIT ("maxportals", "2", CV_SAVE, maxportals_cons_t, NULL);
 
+// Percentage of the view's pixels that portals may show each frame, 0 for no limit
+consvar_t cv_portalbudget = CVAR_INIT ("portalbudget", "0", CV_SAVE, portalbudget_cons_t, NULL);
+
+// Number of threads the Software renderer draws the view with
+consvar_t cv_renderthreads = CVAR_INIT ("renderthreads", "1", CV_SAVE, renderthreads_cons_t, NULL);
+
+// Record the Software renderer's columns and spans, and draw them after the view is set up
+consvar_t cv_deferdraw = CVAR_INIT ("deferdraw", "Off", CV_SAVE, deferdraw_cons_t, NULL);
+
+// How many megabytes of generated textures the Software renderer keeps around
+consvar_t cv_texturecachesize = CVAR_INIT ("texturecachesize", "128", CV_SAVE, texturecachesize_cons_t, NULL);
+
+// Reuse the last BSP traversal while the view and the map stand still
+consvar_t cv_bspcache = CVAR_INIT ("bspcache", "On", CV_SAVE, CV_OnOff, NULL);
+
+// Pad the Software renderer's view with copies of its sprites, up to this many
+consvar_t cv_spritecrowd = CVAR_INIT ("spritecrowd", "0", 0, spritecrowd_cons_t, NULL);
+
 consvar_t cv_renderstats = CVAR_INIT ("renderstats", "Off", 0, CV_OnOff, NULL);
 
 void SplitScreen_OnChange(void)
@@ -481,6 +529,49 @@ boolean R_DoCulling(line_t *cullheight, line_t *viewcullheight, fixed_t vz, fixe
 	return false;
 }
 
+/**	\brief Radix sorts count items by key, keeping the order of equal keys.
+	\param	items	the items to sort
+	\param	scratch	room for another count items
+	\return whichever of items and scratch holds the sorted items
+*/
+sortitem_t *R_RadixSortItems(sortitem_t *items, sortitem_t *scratch, size_t count)
+{
+	size_t i, shift;
+
+	if (!count)
+		return items;
+
+	for (shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256], sum = 0;
+		sortitem_t *swap;
+
+		memset(counts, 0, sizeof counts);
+		for (i = 0; i < count; i++)
+			counts[(items[i].key >> shift) & 0xFF]++;
+
+		// Nothing to do if every key has the same byte here
+		if (counts[(items[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		for (i = 0; i < 256; i++)
+		{
+			size_t c = counts[i];
+			counts[i] = sum;
+			sum += c;
+		}
+
+		for (i = 0; i < count; i++)
+			scratch[counts[(items[i].key >> shift) & 0xFF]++] = items[i];
+
+		swap = items;
+		items = scratch;
+		scratch = swap;
+	}
+
+	return items;
+}
+
 //
 // R_InitTextureMapping
 //
@@ -1080,6 +1171,40 @@ subsector_t *R_PointInSubsectorOrNull(fixed_t x, fixed_t y)
 	return ret;
 }
 
+//
+// R_IsPointInSector
+// Checks if the point is inside the sector's lines.
+// A subsector can hold lines of more than one sector,
+// so the sector R_PointInSubsector gives may not be the one the point is in.
+//
+boolean R_IsPointInSector(sector_t *sector, fixed_t x, fixed_t y)
+{
+	boolean inside = false;
+	size_t i;
+
+	for (i = 0; i < sector->linecount; i++)
+	{
+		line_t *ld = sector->lines[i];
+		fixed_t y1 = ld->v1->y, y2 = ld->v2->y;
+		INT64 side;
+
+		// Both sides in the sector; not part of its outline
+		if (ld->frontsector == ld->backsector)
+			continue;
+
+		if ((y1 > y) == (y2 > y))
+			continue;
+
+		// Count the lines crossed going right from the point
+		side = ((INT64)y - y1)*(((INT64)ld->v2->x - ld->v1->x)>>FRACBITS)
+			- ((INT64)x - ld->v1->x)*(((INT64)y2 - y1)>>FRACBITS);
+		if ((side > 0) == (y2 > y1))
+			inside = !inside;
+	}
+
+	return inside;
+}
+
 //
 // R_SetupFrame
 //
@@ -1464,6 +1589,17 @@ void R_RenderPlayerView(player_t *player)
 	framecount++;
 	validcount++;
 
+	// Record the drawing, if it's spread across threads.
+	R_StartDrawCommands();
+
+	// Make room for the textures this view needs.
+	ps_texturegens = 0;
+	ps_translationhits = 0;
+	ps_translationmisses = 0;
+	R_TrimTextureCache();
+
+	ps_sw_numportals = ps_sw_portalsculled = ps_sw_portalsmerged = 0;
+
 	// Clear buffers.
 	R_ClearPlanes();
 	if (viewmorph.use)
@@ -1498,8 +1634,10 @@ void R_RenderPlayerView(player_t *player)
 #endif
 	ps_numbspcalls = ps_numpolyobjects = ps_numdrawnodes = 0;
 	ps_bsptime = I_GetPreciseTime();
-	R_RenderBSPNode((INT32)numnodes - 1);
+	R_RenderBSPView((splitscreen && player == &players[secondarydisplayplayer]) ? 1 : 0);
 	ps_bsptime = I_GetPreciseTime() - ps_bsptime;
+	if (cv_spritecrowd.value)
+		R_AddSpriteCrowd(masks[nummasks - 1].vissprites[0], cv_spritecrowd.value);
 	ps_numsprites = visspritecount;
 #ifdef TIMING
 	RDMSR(0x10, &mycount);
@@ -1510,6 +1648,7 @@ void R_RenderPlayerView(player_t *player)
 //profile stuff ---------------------------------------------------------
 	Mask_Post(&masks[nummasks - 1]);
 
+	ps_sw_drawsegvisits = 0;
 	ps_sw_spritecliptime = I_GetPreciseTime();
 	R_ClipSprites(drawsegs, NULL);
 	ps_sw_spritecliptime = I_GetPreciseTime() - ps_sw_spritecliptime;
@@ -1524,9 +1663,24 @@ void R_RenderPlayerView(player_t *player)
 	if (portal_base)
 	{
 		portal_t *portal;
+		INT32 portalbudget = cv_portalbudget.value ? viewwidth*viewheight/100*cv_portalbudget.value : INT32_MAX;
 
 		for(portal = portal_base; portal; portal = portal_base)
 		{
+			precise_t portaltime;
+
+			// Deeper portals come last, so they're the first to go
+			// once this frame's portals have shown enough pixels.
+			if (portalbudget <= 0)
+			{
+				ps_sw_portalsculled++;
+				Portal_Remove(portal);
+				continue;
+			}
+			portalbudget -= portal->area;
+
+			portaltime = I_GetPreciseTime();
+
 			portalrender = portal->pass; // Recursiveness depth.
 
 			R_ClearFFloorClips();
@@ -1543,6 +1697,10 @@ void R_RenderPlayerView(player_t *player)
 			// that were previously stored.
 			Portal_ClipApply(portal);
 
+			// Nothing behind the columns the window doesn't cover
+			// can be seen, so don't traverse there either.
+			R_PortalClipClosedColumns(portal->start, portal->end);
+
 			validcount++;
 
 			masks = realloc(masks, (++nummasks)*sizeof(maskcount_t));
@@ -1557,6 +1715,13 @@ void R_RenderPlayerView(player_t *player)
 
 			R_ClipSprites(ds_p - (masks[nummasks - 1].drawsegs[1] - masks[nummasks - 1].drawsegs[0]), portal);
 
+			if (ps_sw_numportals < MAXPORTALSTATS)
+			{
+				ps_sw_portalbsptime[ps_sw_numportals] = I_GetPreciseTime() - portaltime;
+				ps_sw_portalviewarea[ps_sw_numportals] = portal->area;
+			}
+			ps_sw_numportals++;
+
 			Portal_Remove(portal);
 		}
 	}
@@ -1566,12 +1731,18 @@ void R_RenderPlayerView(player_t *player)
 	R_DrawPlanes();
 	ps_sw_planetime = I_GetPreciseTime() - ps_sw_planetime;
 
+	// Nothing drawn so far overlaps, so it can be drawn in any order
+	R_SortDrawCommands();
+
 	// draw mid texture and sprite
 	// And now 3D floors/sides!
+	ps_sw_spritesorttime = 0;
 	ps_sw_maskedtime = I_GetPreciseTime();
 	R_DrawMasked(masks, nummasks);
 	ps_sw_maskedtime = I_GetPreciseTime() - ps_sw_maskedtime;
 
+	R_FinishDrawCommands();
+
 	free(masks);
 }
 
@@ -1587,6 +1758,7 @@ void R_RegisterEngineStuff(void)
 	CV_RegisterVar(&cv_homremoval);
 	CV_RegisterVar(&cv_flipcam);
 	CV_RegisterVar(&cv_flipcam2);
+	CV_RegisterVar(&cv_pvs);
 
 	// Enough for dedicated server
 	if (dedicated)
@@ -1639,6 +1811,16 @@ void R_RegisterEngineStuff(void)
 	CV_RegisterVar(&cv_translucenthud);
 
 	CV_RegisterVar(&cv_maxportals);
+	CV_RegisterVar(&cv_portalbudget);
+#ifdef RENDERTHREADS
+	CV_RegisterVar(&cv_renderthreads);
+#endif
+	CV_RegisterVar(&cv_deferdraw);
+	CV_RegisterVar(&cv_texturecachesize);
+	CV_RegisterVar(&cv_bspcache);
+	CV_RegisterVar(&cv_spritecrowd);
+	COM_AddCommand("drawbench", Command_Drawbench_f);
+	COM_AddCommand("spanbench", Command_Spanbench_f);
 
 	CV_RegisterVar(&cv_movebob);
 }
@@ -25,7 +25,8 @@ extern fixed_t viewcos, viewsin;
 extern INT32 viewheight;
 extern INT32 centerx, centery;
 
-extern fixed_t centerxfrac, centeryfrac;
+extern fixed_t centerxfrac;
+extern fixed_t centeryfrac;
 extern fixed_t projection, projectiony;
 extern fixed_t fovtan;
 
@@ -73,14 +74,25 @@ fixed_t R_PointToDist2(fixed_t px2, fixed_t py2, fixed_t px1, fixed_t py1);
 fixed_t R_ScaleFromGlobalAngle(angle_t visangle);
 subsector_t *R_PointInSubsector(fixed_t x, fixed_t y);
 subsector_t *R_PointInSubsectorOrNull(fixed_t x, fixed_t y);
+boolean R_IsPointInSector(sector_t *sector, fixed_t x, fixed_t y);
 
 boolean R_DoCulling(line_t *cullheight, line_t *viewcullheight, fixed_t vz, fixed_t bottomh, fixed_t toph);
 
+typedef struct
+{
+	UINT64 key;
+	size_t index;
+} sortitem_t;
+
+sortitem_t *R_RadixSortItems(sortitem_t *items, sortitem_t *scratch, size_t count);
+
 // Render stats
 
 extern precise_t ps_prevframetime;// time when previous frame was rendered
 extern precise_t ps_rendercalltime;
 extern precise_t ps_uitime;
+extern int ps_hudpatchdraws;
+extern int ps_hudpatchreuses;
 extern precise_t ps_swaptime;
 
 extern precise_t ps_bsptime;
@@ -89,6 +101,31 @@ extern precise_t ps_sw_spritecliptime;
 extern precise_t ps_sw_portaltime;
 extern precise_t ps_sw_planetime;
 extern precise_t ps_sw_maskedtime;
+extern precise_t ps_sw_spritesorttime;
+extern precise_t ps_sw_drawtime;
+extern precise_t ps_sw_drawsorttime;
+
+#define MAXDRAWTHREADS 16
+
+extern int ps_sw_numdrawthreads;
+extern int ps_sw_numdrawcmds;
+extern int ps_sw_drawsegvisits;
+extern int ps_sw_numvisplanes;
+extern int ps_sw_planefinds;
+extern int ps_sw_planeprobes;
+extern int ps_texturegens;
+extern int ps_translationhits;
+extern int ps_translationmisses;
+extern precise_t ps_sw_drawthreadtime[MAXDRAWTHREADS];
+extern int ps_sw_drawthreadcmds[MAXDRAWTHREADS];
+
+#define MAXPORTALSTATS 8
+
+extern int ps_sw_numportals;
+extern int ps_sw_portalsculled;
+extern int ps_sw_portalsmerged;
+extern precise_t ps_sw_portalbsptime[MAXPORTALSTATS];
+extern int ps_sw_portalviewarea[MAXPORTALSTATS];
 
 extern int ps_numbspcalls;
 extern int ps_numsprites;
@@ -111,6 +148,9 @@ extern consvar_t cv_drawdist, cv_drawdist_nights, cv_drawdist_precip;
 extern consvar_t cv_fov;
 extern consvar_t cv_skybox;
 extern consvar_t cv_tailspickup;
+extern consvar_t cv_portalbudget;
+extern consvar_t cv_renderthreads, cv_deferdraw, cv_texturecachesize, cv_bspcache;
+extern consvar_t cv_spritecrowd;
 
 // Called by startup code.
 void R_Init(void);
@@ -14,6 +14,7 @@
 #include "r_picformats.h"
 #include "r_defs.h"
 #include "z_zone.h"
+#include "v_video.h" // V_FlushScaledPatches
 
 #ifdef HWRENDER
 #include "hardware/hw_glob.h"
@@ -104,6 +105,7 @@ static void Patch_FreeData(patch_t *patch)
 
 void Patch_Free(patch_t *patch)
 {
+	V_FlushScaledPatches();
 	Patch_FreeData(patch);
 	Z_Free(patch);
 }
@@ -121,6 +123,7 @@ static boolean Patch_FreeTagsCallback(void *mem)
 
 void Patch_FreeTags(INT32 lowtag, INT32 hightag)
 {
+	V_FlushScaledPatches();
 	Z_IterateTags(lowtag, hightag, Patch_FreeTagsCallback);
 }
 
@@ -47,9 +47,18 @@
 
 //SoM: 3/23/2000: Use Boom visplane hashing.
 
-visplane_t *visplanes[MAXVISPLANES];
+visplane_t **visplanes = NULL;
+size_t numvisplanelists = 0;
+static UINT32 visplanehashmask;
 static visplane_t *freetail;
 static visplane_t **freehead = &freetail;
+static size_t numvisplanesused = 0; // Since the last R_ClearPlanes
+
+// Visplanes are allocated this many at a time
+#define VISPLANESPERBLOCK 32
+
+// The list after the hash table, for fof planes
+#define FFLOORVISPLANES (numvisplanelists - 1)
 
 visplane_t *floorplane;
 visplane_t *ceilingplane;
@@ -58,9 +67,42 @@ static visplane_t *currentplane;
 visffloor_t ffloor[MAXFFLOORS];
 INT32 numffloors;
 
-//SoM: 3/23/2000: Boom visplane hashing routine.
-#define visplane_hash(picnum,lightlevel,height) \
-  ((unsigned)((picnum)*3+(lightlevel)+(height)*7) & VISPLANEHASHMASK)
+// Mixes every value R_FindPlane compares that usually differs between planes,
+// so planes split by R_CheckPlane don't all end up in the same few lists.
+static unsigned R_VisplaneHash(fixed_t height, INT32 picnum, INT32 lightlevel, fixed_t xoff, fixed_t yoff,
+	angle_t plangle, extracolormap_t *planecolormap, polyobj_t *polyobj, pslope_t *slope)
+{
+	UINT32 hash = (UINT32)picnum * 0x9E3779B1u;
+
+	hash = (hash ^ (UINT32)height) * 0x85EBCA77u;
+	hash = (hash ^ (UINT32)lightlevel) * 0xC2B2AE3Du;
+	hash = (hash ^ (UINT32)xoff) * 0x9E3779B1u;
+	hash = (hash ^ (UINT32)yoff) * 0x85EBCA77u;
+	hash = (hash ^ (UINT32)plangle) * 0xC2B2AE3Du;
+	hash = (hash ^ (UINT32)((size_t)planecolormap >> 4)) * 0x9E3779B1u;
+	hash = (hash ^ (UINT32)((size_t)polyobj >> 4)) * 0x85EBCA77u;
+	hash = (hash ^ (UINT32)((size_t)slope >> 4)) * 0xC2B2AE3Du;
+
+	return (hash ^ (hash >> 16)) & visplanehashmask;
+}
+
+// Grows the hash table to keep its lists short for that many visplanes.
+// Only call this while every list is empty.
+static void R_GrowVisplaneHash(size_t count)
+{
+	INT32 bits = MINVISPLANEHASHBITS;
+
+	while (bits < MAXVISPLANEHASHBITS && ((size_t)1 << bits) < count)
+		bits++;
+
+	if (((size_t)1 << bits) + 1 <= numvisplanelists)
+		return;
+
+	numvisplanelists = ((size_t)1 << bits) + 1;
+	visplanehashmask = (1u << bits) - 1;
+	visplanes = Z_Realloc(visplanes, numvisplanelists * sizeof (*visplanes), PU_STATIC, NULL);
+	memset(visplanes, 0, numvisplanelists * sizeof (*visplanes));
+}
 
 //SoM: 3/23/2000: Use boom opening limit removal
 size_t maxopenings;
@@ -256,7 +298,7 @@ void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 	ProfZeroTimer();
 #endif
 
-	spanfunc();
+	R_CallSpanDrawer(spanfunc);
 
 #ifdef TIMING
 	RDMSR(0x10, &mycount);
@@ -305,13 +347,18 @@ void R_ClearPlanes(void)
 		}
 	}
 
-	for (i = 0; i < MAXVISPLANES; i++)
+	for (i = 0; i < (INT32)numvisplanelists; i++)
 	for (*freehead = visplanes[i], visplanes[i] = NULL;
 		freehead && *freehead ;)
 	{
 		freehead = &(*freehead)->next;
 	}
 
+	// Now that every list is empty, make room for as many visplanes as this frame had
+	R_GrowVisplaneHash(numvisplanesused);
+	numvisplanesused = 0;
+	ps_sw_planefinds = ps_sw_planeprobes = 0;
+
 	lastopening = openings;
 
 	// texture calculation
@@ -327,20 +374,27 @@ void R_ClearPlanes(void)
 
 static visplane_t *new_visplane(unsigned hash)
 {
-	visplane_t *check = freetail;
-	if (!check)
-	{
-		check = calloc(2, sizeof (*check));
-		if (check == NULL) I_Error("%s: Out of memory", "new_visplane"); // FIXME: ugly
-	}
-	else
+	visplane_t *check;
+	if (!freetail)
 	{
-		freetail = freetail->next;
-		if (!freetail)
-			freehead = &freetail;
+		// They are never freed, so allocate a block of them
+		// and put them all on the free list
+		visplane_t *block = calloc(VISPLANESPERBLOCK, sizeof (*block));
+		INT32 i;
+		if (block == NULL) I_Error("%s: Out of memory", "new_visplane"); // FIXME: ugly
+		for (i = 0; i < VISPLANESPERBLOCK; i++)
+		{
+			*freehead = &block[i];
+			freehead = &block[i].next;
+		}
 	}
+	check = freetail;
+	freetail = freetail->next;
+	if (!freetail)
+		freehead = &freetail;
 	check->next = visplanes[hash];
 	visplanes[hash] = check;
+	ps_sw_numvisplanes = (int)++numvisplanesused;
 	return check;
 }
 
@@ -395,9 +449,11 @@ visplane_t *R_FindPlane(fixed_t height, INT32 picnum, INT32 lightlevel,
 
 	if (!pfloor)
 	{
-		hash = visplane_hash(picnum, lightlevel, height);
+		hash = R_VisplaneHash(height, picnum, lightlevel, xoff, yoff, plangle, planecolormap, polyobj, slope);
+		ps_sw_planefinds++;
 		for (check = visplanes[hash]; check; check = check->next)
 		{
+			ps_sw_planeprobes++;
 			if (polyobj != check->polyobj)
 				continue;
 			if (height == check->height && picnum == check->picnum
@@ -415,7 +471,7 @@ visplane_t *R_FindPlane(fixed_t height, INT32 picnum, INT32 lightlevel,
 	}
 	else
 	{
-		hash = MAXVISPLANES - 1;
+		hash = FFLOORVISPLANES;
 	}
 
 	check = new_visplane(hash);
@@ -489,12 +545,12 @@ visplane_t *R_CheckPlane(visplane_t *pl, INT32 start, INT32 stop)
 		visplane_t *new_pl;
 		if (pl->ffloor)
 		{
-			new_pl = new_visplane(MAXVISPLANES - 1);
+			new_pl = new_visplane(FFLOORVISPLANES);
 		}
 		else
 		{
-			unsigned hash =
-				visplane_hash(pl->picnum, pl->lightlevel, pl->height);
+			unsigned hash = R_VisplaneHash(pl->height, pl->picnum, pl->lightlevel, pl->xoffs, pl->yoffs,
+				pl->plangle, pl->extra_colormap, pl->polyobj, pl->slope);
 			new_pl = new_visplane(hash);
 		}
 
@@ -607,7 +663,7 @@ void R_DrawPlanes(void)
 
 	R_UpdatePlaneRipple();
 
-	for (i = 0; i < MAXVISPLANES; i++, pl++)
+	for (i = 0; i < (INT32)numvisplanelists; i++, pl++)
 	{
 		for (pl = visplanes[i]; pl; pl = pl->next)
 		{
@@ -657,7 +713,7 @@ static void R_DrawSkyPlane(visplane_t *pl)
 			dc_source =
 				R_GetColumn(texturetranslation[skytexture],
 					-angle); // get negative of angle for each column to display sky correct way round! --Monster Iestyn 27/01/18
-			colfunc();
+			R_CallColumnDrawer(colfunc);
 		}
 	}
 }
@@ -897,6 +953,7 @@ void R_DrawSinglePlane(visplane_t *pl)
 						bottom = vid.height;
 
 					// Only copy the part of the screen we need
+					R_FlushDrawCommands();
 					VID_BlitLinearScreen((splitscreen && viewplayer == &players[secondarydisplayplayer]) ? screens[0] + (top+(vid.height>>1))*vid.width : screens[0]+((top)*vid.width), screens[1]+((top)*vid.width),
 										 vid.width, bottom-top,
 										 vid.width, vid.width);
@@ -19,10 +19,9 @@
 #include "r_textures.h"
 #include "p_polyobj.h"
 
-#define VISPLANEHASHBITS 9
-#define VISPLANEHASHMASK ((1<<VISPLANEHASHBITS)-1)
-// the last visplane list is outside of the hash table and is used for fof planes
-#define MAXVISPLANES ((1<<VISPLANEHASHBITS)+1)
+// The visplane hash table grows with the number of visplanes in the last frame
+#define MINVISPLANEHASHBITS 9
+#define MAXVISPLANEHASHBITS 16
 
 //
 // Now what is a visplane, anyway?
@@ -55,7 +54,9 @@ typedef struct visplane_s
 	pslope_t *slope;
 } visplane_t;
 
-extern visplane_t *visplanes[MAXVISPLANES];
+// the last visplane list is outside of the hash table and is used for fof planes
+extern visplane_t **visplanes;
+extern size_t numvisplanelists;
 extern visplane_t *floorplane;
 extern visplane_t *ceilingplane;
 
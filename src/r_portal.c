@@ -14,6 +14,7 @@
 #include "r_portal.h"
 #include "r_plane.h"
 #include "r_main.h"
+#include "r_bsp.h"
 #include "doomstat.h"
 #include "p_spec.h" // Skybox viewpoints
 #include "z_zone.h"
@@ -31,6 +32,9 @@ INT32 portalclipstart, portalclipend;
 
 boolean portalline; // is curline a portal seg?
 
+// Can anything be seen through a column of a window?
+#define PORTAL_COLUMNOPEN(ceil, floor) ((floor) - (ceil) > 1)
+
 void Portal_InitList (void)
 {
 	portalrender = 0;
@@ -97,6 +101,9 @@ void Portal_ClipApply (const portal_t* portal)
 	}
 }
 
+/** Allocates a portal for the given screen range.
+ * It isn't in the list until Portal_Link is called on it.
+ */
 static portal_t* Portal_Add (const INT16 x1, const INT16 x2)
 {
 	portal_t *portal		= Z_Malloc(sizeof(portal_t), PU_LEVEL, NULL);
@@ -104,17 +111,6 @@ static portal_t* Portal_Add (const INT16 x1, const INT16 x2)
 	INT16 *floorclipsave	= Z_Malloc(sizeof(INT16)*(x2-x1 + 1), PU_LEVEL, NULL);
 	fixed_t *frontscalesave	= Z_Malloc(sizeof(fixed_t)*(x2-x1 + 1), PU_LEVEL, NULL);
 
-	// Linked list.
-	if (!portal_base)
-	{
-		portal_base	= portal;
-		portal_cap	= portal;
-	}
-	else
-	{
-		portal_cap->next = portal;
-		portal_cap = portal;
-	}
 	portal->next = NULL;
 
 	// Store clipping values so they can be restored once the portal is rendered.
@@ -130,15 +126,136 @@ static portal_t* Portal_Add (const INT16 x1, const INT16 x2)
 	return portal;
 }
 
-void Portal_Remove (portal_t* portal)
+static void Portal_Free (portal_t* portal)
 {
-	portal_base = portal->next;
 	Z_Free(portal->ceilingclip);
 	Z_Free(portal->floorclip);
 	Z_Free(portal->frontscale);
 	Z_Free(portal);
 }
 
+void Portal_Remove (portal_t* portal)
+{
+	portal_base = portal->next;
+	Portal_Free(portal);
+}
+
+/** Counts the pixels that can be seen through a portal's window.
+ */
+static INT32 Portal_Area (const portal_t* portal)
+{
+	INT32 i, area = 0;
+
+	for (i = 0; i < portal->end - portal->start; i++)
+	{
+		if (PORTAL_COLUMNOPEN(portal->ceilingclip[i], portal->floorclip[i]))
+			area += portal->floorclip[i] - portal->ceilingclip[i] - 1;
+	}
+
+	return area;
+}
+
+/** Folds a portal into another one with the same viewpoint,
+ * so that one BSP traversal renders both windows.
+ *
+ * A column can only hold one window, so it can't be done
+ * if both windows are open in the same column.
+ */
+static boolean Portal_Merge (portal_t* into, portal_t* from)
+{
+	INT32 start	= min(into->start, from->start);
+	INT32 end	= max(into->end, from->end);
+	INT32 i;
+
+	for (i = max(into->start, from->start); i < min(into->end, from->end); i++)
+	{
+		if (PORTAL_COLUMNOPEN(into->ceilingclip[i - into->start], into->floorclip[i - into->start])
+		&& PORTAL_COLUMNOPEN(from->ceilingclip[i - from->start], from->floorclip[i - from->start]))
+			return false;
+	}
+
+	// Widen the window, with the new columns closed
+	if (start < into->start || end > into->end)
+	{
+		INT16 *ceil		= Z_Malloc(sizeof(INT16)*(end-start + 1), PU_LEVEL, NULL);
+		INT16 *floor	= Z_Malloc(sizeof(INT16)*(end-start + 1), PU_LEVEL, NULL);
+		fixed_t *scale	= Z_Malloc(sizeof(fixed_t)*(end-start + 1), PU_LEVEL, NULL);
+
+		for (i = 0; i < end - start; i++)
+		{
+			ceil[i] = floor[i] = -1;
+			scale[i] = INT32_MAX;
+		}
+
+		memcpy(ceil + (into->start - start), into->ceilingclip, sizeof(INT16)*(into->end - into->start));
+		memcpy(floor + (into->start - start), into->floorclip, sizeof(INT16)*(into->end - into->start));
+		memcpy(scale + (into->start - start), into->frontscale, sizeof(fixed_t)*(into->end - into->start));
+
+		Z_Free(into->ceilingclip);
+		Z_Free(into->floorclip);
+		Z_Free(into->frontscale);
+
+		into->ceilingclip	= ceil;
+		into->floorclip		= floor;
+		into->frontscale	= scale;
+		into->start	= start;
+		into->end	= end;
+	}
+
+	for (i = from->start; i < from->end; i++)
+	{
+		if (!PORTAL_COLUMNOPEN(from->ceilingclip[i - from->start], from->floorclip[i - from->start]))
+			continue;
+		into->ceilingclip[i - start]	= from->ceilingclip[i - from->start];
+		into->floorclip[i - start]		= from->floorclip[i - from->start];
+		into->frontscale[i - start]		= from->frontscale[i - from->start];
+	}
+
+	into->area += from->area;
+	return true;
+}
+
+/** Puts a portal at the end of the list, or merges it into a portal
+ * still waiting to be rendered that sees from the same viewpoint.
+ */
+static void Portal_Link (portal_t* portal)
+{
+	portal_t *other;
+
+	portal->area = Portal_Area(portal);
+	if (!portal->area)
+	{
+		ps_sw_portalsculled++;
+		Portal_Free(portal);
+		return;
+	}
+
+	for (other = portal_base; other; other = other->next)
+	{
+		if (other->pass == portal->pass && other->clipline == portal->clipline
+		&& other->viewx == portal->viewx && other->viewy == portal->viewy
+		&& other->viewz == portal->viewz && other->viewangle == portal->viewangle
+		&& Portal_Merge(other, portal))
+		{
+			ps_sw_portalsmerged++;
+			Portal_Free(portal);
+			return;
+		}
+	}
+
+	// Linked list.
+	if (!portal_base)
+	{
+		portal_base	= portal;
+		portal_cap	= portal;
+	}
+	else
+	{
+		portal_cap->next = portal;
+		portal_cap = portal;
+	}
+}
+
 /** Creates a portal out of two lines and a determined screen range.
  *
  * line1 determines the entrance, and line2 the exit.
@@ -151,19 +268,43 @@ void Portal_Remove (portal_t* portal)
  */
 void Portal_Add2Lines (const INT32 line1, const INT32 line2, const INT32 x1, const INT32 x2)
 {
-	portal_t* portal = Portal_Add(x1, x2);
+	portal_t* portal;
+	INT32 first = x1, last = x2 - 1;
 
 	// Offset the portal view by the linedef centers
 	line_t* start	= &lines[line1];
 	line_t* dest	= &lines[line2];
 
-	angle_t dangle = R_PointToAngle2(0,0,dest->dx,dest->dy) - R_PointToAngle2(start->dx,start->dy,0,0);
+	angle_t dangle;
 
 	fixed_t disttopoint;
 	angle_t angtopoint;
 
 	vertex_t dest_c, start_c;
 
+	portalline = true; // this tells R_StoreWallRange that curline is a portal seg
+
+	// Skip the columns already behind solid walls, and the ones
+	// closed from top to bottom; nothing is seen through them.
+	if (!R_TrimToOpenClipRange(&first, &last))
+	{
+		ps_sw_portalsculled++;
+		return;
+	}
+	while (first <= last && !PORTAL_COLUMNOPEN(ceilingclip[first], floorclip[first]))
+		first++;
+	while (last >= first && !PORTAL_COLUMNOPEN(ceilingclip[last], floorclip[last]))
+		last--;
+	if (first > last)
+	{
+		ps_sw_portalsculled++;
+		return;
+	}
+
+	portal = Portal_Add(first, last + 1);
+
+	dangle = R_PointToAngle2(0,0,dest->dx,dest->dy) - R_PointToAngle2(start->dx,start->dy,0,0);
+
 	// looking glass center
 	start_c.x = (start->v1->x + start->v2->x) / 2;
 	start_c.y = (start->v1->y + start->v2->y) / 2;
@@ -184,8 +325,7 @@ void Portal_Add2Lines (const INT32 line1, const INT32 line2, const INT32 x1, con
 	portal->clipline = line2;
 
 	Portal_ClipRange(portal);
-
-	portalline = true; // this tells R_StoreWallRange that curline is a portal seg
+	Portal_Link(portal);
 }
 
 /** Store the clipping window for a portal using a visplane.
@@ -303,6 +443,10 @@ void Portal_AddSkybox (const visplane_t* plane)
 		portal->viewz += viewz * -mh->skybox_scalez;
 
 	portal->clipline = -1;
+
+	// Every sky visplane sees the same skybox, so most
+	// of these end up rendered in one go.
+	Portal_Link(portal);
 }
 
 /** Creates portals for the currently existing sky visplanes.
@@ -314,7 +458,7 @@ void Portal_AddSkyboxPortals (void)
 	INT32 i;
 	UINT16 count = 0;
 
-	for (i = 0; i < MAXVISPLANES; i++, pl++)
+	for (i = 0; i < (INT32)numvisplanelists; i++, pl++)
 	{
 		for (pl = visplanes[i]; pl; pl = pl->next)
 		{
@@ -39,6 +39,8 @@ typedef struct portal_s
 	INT16 *ceilingclip; /**< Temporary screen top clipping array. */
 	INT16 *floorclip;	/**< Temporary screen bottom clipping array. */
 	fixed_t *frontscale;/**< Temporary screen bottom clipping array. */
+
+	INT32 area;			/**< Pixels that can be seen through the window, at most. */
 } portal_t;
 
 extern portal_t* portal_base;
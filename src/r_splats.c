@@ -570,7 +570,7 @@ static void R_RasterizeFloorSplat(floorsplat_t *pSplat, vector2_t *verts, visspr
 		ds_y = y;
 		ds_x1 = x1;
 		ds_x2 = x2;
-		spanfunc();
+		R_CallSpanDrawer(spanfunc);
 
 		rastertab[y].minx = INT32_MAX;
 		rastertab[y].maxx = INT32_MIN;
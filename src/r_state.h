@@ -81,6 +81,8 @@ extern size_t numsides;
 extern side_t *sides;
 extern side_t *spawnsides;
 
+extern UINT32 geometrychanges;
+
 //
 // POV data.
 //
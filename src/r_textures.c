@@ -50,6 +50,91 @@ INT32 numtextures = 0; // total number of textures found,
 texture_t **textures = NULL;
 UINT32 **texturecolumnofs; // column offset lookup table for each texture
 UINT8 **texturecache; // graphics data for each generated full-size texture
+static UINT32 *texturecacheused; // when each texture's columns were last asked for
+static UINT32 *texturecachebytes; // how much memory each generated texture takes
+static INT32 *texturecacheprev, *texturecachenext; // cached textures, least recently used first
+
+// Textures not used in this many views can be freed from the texture cache
+#define TEXTURECACHEKEEPVIEWS 2
+
+static UINT32 texturecacheview = TEXTURECACHEKEEPVIEWS;
+static size_t texturecachetotal = 0;
+static INT32 texturecachehead = -1, texturecachetail = -1;
+
+//
+// R_UnlinkCachedTexture
+//
+// Takes a texture out of the texture cache's usage list,
+// and stops counting its memory.
+//
+static void R_UnlinkCachedTexture(INT32 tex)
+{
+	if (texturecacheprev[tex] != -1)
+		texturecachenext[texturecacheprev[tex]] = texturecachenext[tex];
+	else
+		texturecachehead = texturecachenext[tex];
+
+	if (texturecachenext[tex] != -1)
+		texturecacheprev[texturecachenext[tex]] = texturecacheprev[tex];
+	else
+		texturecachetail = texturecacheprev[tex];
+
+	texturecacheprev[tex] = texturecachenext[tex] = -1;
+
+	texturecachetotal -= texturecachebytes[tex];
+	texturememory -= min(texturememory, texturecachebytes[tex]);
+	texturecachebytes[tex] = 0;
+}
+
+//
+// R_TouchCachedTexture
+//
+// Marks a texture as used in this view, moving it to the end of the
+// usage list. That only happens the first time in each view, so the
+// list stays sorted by when each texture was last used.
+//
+static inline void R_TouchCachedTexture(INT32 tex)
+{
+	if (texturecacheused[tex] == texturecacheview)
+		return;
+
+	texturecacheused[tex] = texturecacheview;
+
+	if (!texturecachebytes[tex] || texturecachetail == tex)
+		return;
+
+	// Move it to the end
+	if (texturecacheprev[tex] != -1)
+		texturecachenext[texturecacheprev[tex]] = texturecachenext[tex];
+	else
+		texturecachehead = texturecachenext[tex];
+	texturecacheprev[texturecachenext[tex]] = texturecacheprev[tex];
+
+	texturecacheprev[tex] = texturecachetail;
+	texturecachenext[tex] = -1;
+	texturecachenext[texturecachetail] = tex;
+	texturecachetail = tex;
+}
+
+//
+// R_LinkCachedTexture
+//
+// Adds a newly generated texture to the end of the usage list.
+//
+static void R_LinkCachedTexture(INT32 tex, size_t blocksize)
+{
+	texturememory += blocksize;
+	texturecachetotal += blocksize;
+	texturecachebytes[tex] = (UINT32)blocksize;
+
+	texturecacheprev[tex] = texturecachetail;
+	texturecachenext[tex] = -1;
+	if (texturecachetail != -1)
+		texturecachenext[texturecachetail] = tex;
+	else
+		texturecachehead = tex;
+	texturecachetail = tex;
+}
 
 INT32 *texturewidth;
 fixed_t *textureheight; // needed for texture pegging
@@ -265,7 +350,7 @@ UINT8 *R_GenerateTexture(size_t texnum)
 	softwarepatch_t *realpatch;
 	UINT8 *pdata;
 	int x, x1, x2, i, width, height;
-	size_t blocksize;
+	size_t blocksize, headersize, columnsize;
 	column_t *patchcol;
 	UINT8 *colofs;
 
@@ -277,6 +362,13 @@ UINT8 *R_GenerateTexture(size_t texnum)
 	texture = textures[texnum];
 	I_Assert(texture != NULL);
 
+	ps_texturegens++;
+	texturecacheused[texnum] = texturecacheview;
+
+	// The zone might have purged this texture since it was last made
+	if (texturecachebytes[texnum])
+		R_UnlinkCachedTexture(texnum);
+
 	// allocate texture column offset lookup
 
 	// single-patch textures can have holes in them and may be used on
@@ -335,7 +427,7 @@ UINT8 *R_GenerateTexture(size_t texnum)
 			block = Z_Calloc(blocksize, PU_STATIC, // will change tag at end of this function
 				&texturecache[texnum]);
 			M_Memcpy(block, realpatch, blocksize);
-			texturememory += blocksize;
+			R_LinkCachedTexture(texnum, blocksize);
 
 			// use the patch's column lookup
 			colofs = (block + 8);
@@ -361,18 +453,21 @@ UINT8 *R_GenerateTexture(size_t texnum)
 	multipatch:
 	texture->holes = false;
 	texture->flip = 0;
-	blocksize = (texture->width * 4) + (texture->width * texture->height);
-	texturememory += blocksize;
-	block = Z_Malloc(blocksize+1, PU_STATIC, &texturecache[texnum]);
+	// each column starts on its own cache line, the first one right after the lookup table
+	headersize = ((texture->width * 4) + 63) & ~63;
+	columnsize = (texture->height + 63) & ~63;
+	blocksize = headersize + (texture->width * columnsize);
+	block = Z_MallocAlign(blocksize+1, PU_STATIC, &texturecache[texnum], 6);
 
 	memset(block, TRANSPARENTPIXEL, blocksize+1); // Transparency hack
+	R_LinkCachedTexture(texnum, blocksize);
 
 	// columns lookup table
 	colofs = block;
 	texturecolumnofs[texnum] = (UINT32 *)colofs;
 
 	// texture data after the lookup table
-	blocktex = block + (texture->width*4);
+	blocktex = block + headersize;
 
 	// Composite the columns together.
 	for (i = 0, patch = texture->patches; i < texture->patchcount; i++, patch++)
@@ -446,7 +541,7 @@ UINT8 *R_GenerateTexture(size_t texnum)
 				patchcol = (column_t *)((UINT8 *)realpatch + LONG(realpatch->columnofs[x-x1]));
 
 			// generate column ofset lookup
-			*(UINT32 *)&colofs[x<<2] = LONG((x * texture->height) + (texture->width*4));
+			*(UINT32 *)&colofs[x<<2] = LONG((x * columnsize) + headersize);
 			ColumnDrawerPointer(patchcol, block + LONG(*(UINT32 *)&colofs[x<<2]), patch, texture->height, height);
 		}
 
@@ -508,16 +603,44 @@ INT32 R_GetTextureNum(INT32 texnum)
 //
 void R_CheckTextureCache(INT32 tex)
 {
+	R_TouchCachedTexture(tex);
 	if (!texturecache[tex])
 		R_GenerateTexture(tex);
 }
 
+//
+// R_TrimTextureCache
+//
+// Frees the least recently used textures until the texture cache fits in
+// texturecachesize again. Only textures that weren't used in the last few
+// views are freed, so this never takes away a texture that is still being
+// drawn, and doesn't throw away what the next view will need right away.
+// Call this before each view is rendered.
+//
+void R_TrimTextureCache(void)
+{
+	size_t limit = (size_t)cv_texturecachesize.value << 20;
+
+	texturecacheview++;
+
+	while (texturecachetotal > limit && texturecachehead != -1)
+	{
+		INT32 oldest = texturecachehead;
+
+		// Everything left is still in use
+		if (texturecacheused[oldest] >= texturecacheview - TEXTURECACHEKEEPVIEWS)
+			break;
+
+		R_UnlinkCachedTexture(oldest);
+		Z_Free(texturecache[oldest]);
+	}
+}
+
 //
 // R_GetColumn
 //
 UINT8 *R_GetColumn(fixed_t tex, INT32 col)
 {
-	UINT8 *data;
 	INT32 width = texturewidth[tex];
 
 	if (width & (width - 1))
@@ -525,11 +648,12 @@ UINT8 *R_GetColumn(fixed_t tex, INT32 col)
 	else
 		col &= (width - 1);
 
-	data = texturecache[tex];
-	if (!data)
-		data = R_GenerateTexture(tex);
+	R_TouchCachedTexture(tex);
+
+	if (!texturecache[tex])
+		R_GenerateTexture(tex);
 
-	return data + LONG(texturecolumnofs[tex][col]);
+	return texturecache[tex] + LONG(texturecolumnofs[tex][col]);
 }
 
 void *R_GetFlat(lumpnum_t flatlumpnum)
@@ -710,7 +834,12 @@ void R_FlushTextureCache(void)
 
 	if (numtextures)
 		for (i = 0; i < numtextures; i++)
+		{
+			if (texturecachebytes[i])
+				R_UnlinkCachedTexture(i);
 			Z_Free(texturecache[i]);
+		}
+	texturecachetotal = 0;
 }
 
 // Need these prototypes for later; defining them here instead of r_textures.h so they're "private"
@@ -944,6 +1073,8 @@ void R_LoadTextures(void)
 			Z_Free(textures[i]);
 			Z_Free(texturecache[i]);
 		}
+		texturecachetotal = 0;
+		texturecachehead = texturecachetail = -1;
 		Z_Free(texturetranslation);
 		Z_Free(textures);
 	}
@@ -1031,8 +1162,8 @@ void R_LoadTextures(void)
 		I_Error("No textures detected in any WADs!\n");
 
 	// Allocate memory and initialize to 0 for all the textures we are initialising.
-	// There are actually 5 buffers allocated in one for convenience.
-	textures = Z_Calloc((numtextures * sizeof(void *)) * 5, PU_STATIC, NULL);
+	// There are actually 9 buffers allocated in one for convenience.
+	textures = Z_Calloc((numtextures * sizeof(void *)) * 9, PU_STATIC, NULL);
 
 	// Allocate texture column offset table.
 	texturecolumnofs = (void *)((UINT8 *)textures + (numtextures * sizeof(void *)));
@@ -1042,6 +1173,11 @@ void R_LoadTextures(void)
 	texturewidth     = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 3));
 	// Allocate texture height table.
 	textureheight    = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 4));
+	// Allocate texture cache usage tables.
+	texturecacheused  = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 5));
+	texturecachebytes = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 6));
+	texturecacheprev  = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 7));
+	texturecachenext  = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 8));
 	// Create translation table for global animation.
 	texturetranslation = Z_Malloc((numtextures + 1) * sizeof(*texturetranslation), PU_STATIC, NULL);
 
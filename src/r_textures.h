@@ -83,6 +83,7 @@ UINT8 *R_GenerateTexture(size_t texnum);
 UINT8 *R_GenerateTextureAsFlat(size_t texnum);
 INT32 R_GetTextureNum(INT32 texnum);
 void R_CheckTextureCache(INT32 tex);
+void R_TrimTextureCache(void);
 void R_ClearTextureNumCache(boolean btell);
 
 // Retrieve texture data.
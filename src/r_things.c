@@ -596,6 +596,40 @@ static vissprite_t *R_NewVisSprite(void)
 	return R_GetVisSprite(visspritecount++);
 }
 
+/**	\brief Copies the view's sprites until there are count of them,
+	to see how the renderer copes with a crowded scene.
+	\param	first	the view's first vissprite
+	\param	count	how many vissprites to end up with
+*/
+void R_AddSpriteCrowd(UINT32 first, UINT32 count)
+{
+	UINT32 end = visspritecount, i = first;
+	boolean copied = false;
+
+	if (first >= end)
+		return;
+
+	count = min(count, MAXVISSPRITES);
+	while (visspritecount < count)
+	{
+		vissprite_t *spr = R_GetVisSprite(i);
+
+		// Links need the sprite they are linked to
+		if (!(spr->cut & SC_LINKDRAW))
+		{
+			M_Memcpy(R_NewVisSprite(), spr, sizeof (vissprite_t));
+			copied = true;
+		}
+
+		if (++i == end)
+		{
+			if (!copied)
+				break;
+			i = first;
+		}
+	}
+}
+
 //
 // R_DrawMaskedColumn
 // Used for sprites and masked mid textures.
@@ -658,7 +692,7 @@ void R_DrawMaskedColumn(column_t *column)
 			// FIXTHIS: Figure out what "something more proper" is and do it.
 			// quick fix... something more proper should be done!!!
 			if (ylookup[dc_yl])
-				colfunc();
+				R_CallColumnDrawer(colfunc);
 #ifdef PARANOIA
 			else
 				I_Error("R_DrawMaskedColumn: Invalid ylookup for dc_yl %d", dc_yl);
@@ -722,12 +756,12 @@ void R_DrawFlippedMaskedColumn(column_t *column)
 
 			// Still drawn by R_DrawColumn.
 			if (ylookup[dc_yl])
-				colfunc();
+				R_CallColumnDrawer(colfunc);
 #ifdef PARANOIA
 			else
 				I_Error("R_DrawMaskedColumn: Invalid ylookup for dc_yl %d", dc_yl);
 #endif
-			Z_Free(dc_source);
+			R_FreeAfterDrawing(dc_source);
 		}
 		column = (column_t *)((UINT8 *)column + column->length + 4);
 	}
@@ -2286,14 +2320,35 @@ void R_AddSprites(sector_t *sec, INT32 lightlevel)
 //
 // R_SortVisSprites
 //
+static sortitem_t *vissortitems = NULL;
+static vissprite_t **vissortsprites = NULL;
+static size_t maxvissortitems = 0;
+
+// Sprites are drawn from the smallest scale to the largest,
+// and sprites of the same scale by dispoffset, smallest first.
+static inline UINT64 R_VisSpriteSortKey(fixed_t sortscale, INT32 dispoffset)
+{
+	return ((UINT64)((UINT32)sortscale ^ 0x80000000) << 32) | ((UINT32)dispoffset ^ 0x80000000);
+}
+
+static void R_ReserveVisSortItems(size_t count)
+{
+	if (count * 2 > maxvissortitems)
+	{
+		maxvissortitems = count * 2;
+		vissortitems = Z_Realloc(vissortitems, maxvissortitems * sizeof (*vissortitems), PU_STATIC, &vissortitems);
+		vissortsprites = Z_Realloc(vissortsprites, maxvissortitems * sizeof (*vissortsprites), PU_STATIC, &vissortsprites);
+	}
+}
+
 static void R_SortVisSprites(vissprite_t* vsprsortedhead, UINT32 start, UINT32 end)
 {
+	precise_t    time = I_GetPreciseTime();
 	UINT32       i, linkedvissprites = 0;
 	vissprite_t *ds, *dsprev, *dsnext, *dsfirst;
-	vissprite_t *best = NULL;
 	vissprite_t  unsorted;
-	fixed_t      bestscale;
-	INT32        bestdispoffset;
+	sortitem_t  *sorted;
+	UINT32       count;
 
 	unsorted.next = unsorted.prev = &unsorted;
 
@@ -2389,38 +2444,35 @@ static void R_SortVisSprites(vissprite_t* vsprsortedhead, UINT32 start, UINT32 e
 		}
 	}
 
-	// pull the vissprites out by scale
-	vsprsortedhead->next = vsprsortedhead->prev = vsprsortedhead;
-	for (i = start; i < end-linkedvissprites; i++)
+	// pull the vissprites out by scale, keeping the list order of equal ones
+	count = end - start - linkedvissprites;
+	R_ReserveVisSortItems(count);
+	for (i = 0, ds = unsorted.next; ds != &unsorted; i++, ds = ds->next)
 	{
-		bestscale = bestdispoffset = INT32_MAX;
-		for (ds = unsorted.next; ds != &unsorted; ds = ds->next)
-		{
 #ifdef PARANOIA
-			if (ds->cut & SC_LINKDRAW)
-				I_Error("R_SortVisSprites: no link or discardal made for linkdraw!");
+		if (ds->cut & SC_LINKDRAW)
+			I_Error("R_SortVisSprites: no link or discardal made for linkdraw!");
 #endif
 
-			if (ds->sortscale < bestscale)
-			{
-				bestscale = ds->sortscale;
-				bestdispoffset = ds->dispoffset;
-				best = ds;
-			}
-			// order visprites of same scale by dispoffset, smallest first
-			else if (ds->sortscale == bestscale && ds->dispoffset < bestdispoffset)
-			{
-				bestdispoffset = ds->dispoffset;
-				best = ds;
-			}
-		}
-		best->next->prev = best->prev;
-		best->prev->next = best->next;
-		best->next = vsprsortedhead;
-		best->prev = vsprsortedhead->prev;
-		vsprsortedhead->prev->next = best;
-		vsprsortedhead->prev = best;
+		vissortsprites[i] = ds;
+		vissortitems[i].key = R_VisSpriteSortKey(ds->sortscale, ds->dispoffset);
+		vissortitems[i].index = i;
 	}
+
+	sorted = R_RadixSortItems(vissortitems, vissortitems + count, count);
+
+	dsprev = vsprsortedhead;
+	for (i = 0; i < count; i++)
+	{
+		ds = vissortsprites[sorted[i].index];
+		ds->prev = dsprev;
+		dsprev->next = ds;
+		dsprev = ds;
+	}
+	dsprev->next = vsprsortedhead;
+	vsprsortedhead->prev = dsprev;
+
+	ps_sw_spritesorttime += I_GetPreciseTime() - time;
 }
 
 //
@@ -2797,104 +2849,181 @@ static void R_DrawPrecipitationSprite(vissprite_t *spr)
 	R_DrawPrecipitationVisSprite(spr);
 }
 
+// The drawsegs that can clip sprites, sorted into buckets of screen
+// columns, so that a sprite only looks at the drawsegs next to it.
+// Every bucket keeps the drawsegs from end to start, like they are scanned.
+typedef struct
+{
+	drawseg_t *ds;
+	INT32 x1, x2;
+	fixed_t scale; // The larger scale, or INT32_MAX if it always clips
+} spriteclipseg_t;
+
+#define CLIPBUCKETBITS 5 // 32 columns per bucket
+#define NUMCLIPBUCKETS ((MAXVIDWIDTH >> CLIPBUCKETBITS) + 1)
+
+static spriteclipseg_t *spriteclipsegs = NULL;
+static size_t maxspriteclipsegs = 0;
+static size_t clipbucketstart[NUMCLIPBUCKETS + 1];
+
+// Builds the buckets for the drawsegs from dsstart to ds_p.
+static void R_BuildSpriteClipSegs(drawseg_t *dsstart)
+{
+	size_t counts[NUMCLIPBUCKETS], total = 0;
+	drawseg_t *ds;
+	INT32 b;
+
+	memset(counts, 0, sizeof counts);
+
+	// Scan drawsegs from end to start for obscuring segs.
+	//SoM: 4/8/2000:
+	// Pointer check was originally nonportable
+	// and buggy, by going past LEFT end of array:
+
+	//    for (ds = ds_p-1; ds >= drawsegs; ds--)    old buggy code
+	for (ds = ds_p; ds-- > dsstart;)
+	{
+		// does not cover any sprite
+		if (!ds->silhouette && !ds->maskedtexturecol)
+			continue;
+
+		// is a portal
+		if (ds->portalpass != 66 && ds->portalpass > 0 && ds->portalpass <= portalrender)
+			continue;
+
+		for (b = ds->x1 >> CLIPBUCKETBITS; b <= (ds->x2 >> CLIPBUCKETBITS); b++)
+			counts[b]++;
+	}
+
+	for (b = 0; b < NUMCLIPBUCKETS; b++)
+	{
+		clipbucketstart[b] = total;
+		total += counts[b];
+	}
+	clipbucketstart[NUMCLIPBUCKETS] = total;
+
+	if (total > maxspriteclipsegs)
+	{
+		maxspriteclipsegs = max(total, maxspriteclipsegs * 2);
+		spriteclipsegs = Z_Realloc(spriteclipsegs, maxspriteclipsegs * sizeof (*spriteclipsegs), PU_STATIC, &spriteclipsegs);
+	}
+
+	// Reuse the counts as where the next drawseg of each bucket goes
+	for (b = 0; b < NUMCLIPBUCKETS; b++)
+		counts[b] = clipbucketstart[b];
+
+	for (ds = ds_p; ds-- > dsstart;)
+	{
+		spriteclipseg_t seg;
+
+		if (!ds->silhouette && !ds->maskedtexturecol)
+			continue;
+
+		if (ds->portalpass != 66 && ds->portalpass > 0 && ds->portalpass <= portalrender)
+			continue;
+
+		seg.ds = ds;
+		seg.x1 = ds->x1;
+		seg.x2 = ds->x2;
+		seg.scale = (ds->portalpass == 66) ? INT32_MAX : max(ds->scale1, ds->scale2);
+
+		for (b = ds->x1 >> CLIPBUCKETBITS; b <= (ds->x2 >> CLIPBUCKETBITS); b++)
+			spriteclipsegs[counts[b]++] = seg;
+	}
+}
+
 // R_ClipVisSprite
 // Clips vissprites without drawing, so that portals can work. -Red
-void R_ClipVisSprite(vissprite_t *spr, INT32 x1, INT32 x2, drawseg_t* dsstart, portal_t* portal)
+// The drawsegs it clips against are the ones R_BuildSpriteClipSegs found.
+static void R_ClipVisSprite(vissprite_t *spr, INT32 x1, INT32 x2, portal_t* portal)
 {
 	drawseg_t *ds;
 	INT32		x;
 	INT32		r1;
 	INT32		r2;
-	fixed_t		scale;
 	fixed_t		lowscale;
 	INT32		silhouette;
+	INT32		b, lastb;
+	size_t		i;
 
 	for (x = x1; x <= x2; x++)
 		spr->clipbot[x] = spr->cliptop[x] = -2;
 
-	// Scan drawsegs from end to start for obscuring segs.
-	// The first drawseg that has a greater scale
-	//  is the clip seg.
-	//SoM: 4/8/2000:
-	// Pointer check was originally nonportable
-	// and buggy, by going past LEFT end of array:
-
-	//    for (ds = ds_p-1; ds >= drawsegs; ds--)    old buggy code
-	for (ds = ds_p; ds-- > dsstart;)
+	// Each column is clipped by the first drawseg covering it that has
+	// a greater scale, so every bucket can be clipped on its own.
+	lastb = min(x2 >> CLIPBUCKETBITS, NUMCLIPBUCKETS - 1);
+	for (b = x1 >> CLIPBUCKETBITS; b <= lastb; b++)
 	{
-		// determine if the drawseg obscures the sprite
-		if (ds->x1 > x2 ||
-			ds->x2 < x1 ||
-			(!ds->silhouette
-			 && !ds->maskedtexturecol))
-		{
-			// does not cover sprite
-			continue;
-		}
+		INT32 bx1 = max(x1, b << CLIPBUCKETBITS);
+		INT32 bx2 = min(x2, ((b + 1) << CLIPBUCKETBITS) - 1);
 
-		if (ds->portalpass != 66)
+		ps_sw_drawsegvisits += (int)(clipbucketstart[b + 1] - clipbucketstart[b]);
+
+		for (i = clipbucketstart[b]; i < clipbucketstart[b + 1]; i++)
 		{
-			if (ds->portalpass > 0 && ds->portalpass <= portalrender)
-				continue; // is a portal
+			const spriteclipseg_t *seg = &spriteclipsegs[i];
 
-			if (ds->scale1 > ds->scale2)
-			{
-				lowscale = ds->scale2;
-				scale = ds->scale1;
-			}
-			else
-			{
-				lowscale = ds->scale1;
-				scale = ds->scale2;
-			}
+			// determine if the drawseg obscures the sprite
+			if (seg->x1 > bx2 || seg->x2 < bx1)
+				continue; // does not cover sprite
 
-			if (scale < spr->sortscale ||
-				(lowscale < spr->sortscale &&
-				 !R_PointOnSegSide (spr->gx, spr->gy, ds->curline)))
-			{
-				// masked mid texture?
-				/*if (ds->maskedtexturecol)
-					R_RenderMaskedSegRange (ds, r1, r2);*/
-				// seg is behind sprite
+			// seg is behind sprite
+			if (seg->scale < spr->sortscale)
 				continue;
+
+			ds = seg->ds;
+
+			if (ds->portalpass != 66)
+			{
+				lowscale = min(ds->scale1, ds->scale2);
+
+				if (lowscale < spr->sortscale &&
+					!R_PointOnSegSide (spr->gx, spr->gy, ds->curline))
+				{
+					// masked mid texture?
+					/*if (ds->maskedtexturecol)
+						R_RenderMaskedSegRange (ds, r1, r2);*/
+					// seg is behind sprite
+					continue;
+				}
 			}
-		}
 
-		r1 = ds->x1 < x1 ? x1 : ds->x1;
-		r2 = ds->x2 > x2 ? x2 : ds->x2;
+			r1 = ds->x1 < bx1 ? bx1 : ds->x1;
+			r2 = ds->x2 > bx2 ? bx2 : ds->x2;
 
-		// clip this piece of the sprite
-		silhouette = ds->silhouette;
+			// clip this piece of the sprite
+			silhouette = ds->silhouette;
 
-		if (spr->gz >= ds->bsilheight)
-			silhouette &= ~SIL_BOTTOM;
+			if (spr->gz >= ds->bsilheight)
+				silhouette &= ~SIL_BOTTOM;
 
-		if (spr->gzt <= ds->tsilheight)
-			silhouette &= ~SIL_TOP;
+			if (spr->gzt <= ds->tsilheight)
+				silhouette &= ~SIL_TOP;
 
-		if (silhouette == SIL_BOTTOM)
-		{
-			// bottom sil
-			for (x = r1; x <= r2; x++)
-				if (spr->clipbot[x] == -2)
-					spr->clipbot[x] = ds->sprbottomclip[x];
-		}
-		else if (silhouette == SIL_TOP)
-		{
-			// top sil
-			for (x = r1; x <= r2; x++)
-				if (spr->cliptop[x] == -2)
-					spr->cliptop[x] = ds->sprtopclip[x];
-		}
-		else if (silhouette == (SIL_TOP|SIL_BOTTOM))
-		{
-			// both
-			for (x = r1; x <= r2; x++)
+			if (silhouette == SIL_BOTTOM)
 			{
-				if (spr->clipbot[x] == -2)
-					spr->clipbot[x] = ds->sprbottomclip[x];
-				if (spr->cliptop[x] == -2)
-					spr->cliptop[x] = ds->sprtopclip[x];
+				// bottom sil
+				for (x = r1; x <= r2; x++)
+					if (spr->clipbot[x] == -2)
+						spr->clipbot[x] = ds->sprbottomclip[x];
+			}
+			else if (silhouette == SIL_TOP)
+			{
+				// top sil
+				for (x = r1; x <= r2; x++)
+					if (spr->cliptop[x] == -2)
+						spr->cliptop[x] = ds->sprtopclip[x];
+			}
+			else if (silhouette == (SIL_TOP|SIL_BOTTOM))
+			{
+				// both
+				for (x = r1; x <= r2; x++)
+				{
+					if (spr->clipbot[x] == -2)
+						spr->clipbot[x] = ds->sprbottomclip[x];
+					if (spr->cliptop[x] == -2)
+						spr->cliptop[x] = ds->sprtopclip[x];
+				}
 			}
 		}
 	}
@@ -2994,12 +3123,15 @@ void R_ClipVisSprite(vissprite_t *spr, INT32 x1, INT32 x2, drawseg_t* dsstart, p
 
 void R_ClipSprites(drawseg_t* dsstart, portal_t* portal)
 {
+	if (clippedvissprites < visspritecount)
+		R_BuildSpriteClipSegs(dsstart);
+
 	for (; clippedvissprites < visspritecount; clippedvissprites++)
 	{
 		vissprite_t *spr = R_GetVisSprite(clippedvissprites);
 		INT32 x1 = (spr->cut & SC_SPLAT) ? 0 : spr->x1;
 		INT32 x2 = (spr->cut & SC_SPLAT) ? viewwidth : spr->x2;
-		R_ClipVisSprite(spr, x1, x2, dsstart, portal);
+		R_ClipVisSprite(spr, x1, x2, portal);
 	}
 }
 
@@ -103,6 +103,7 @@ boolean R_SSE = false;
 boolean R_3DNow = false;
 boolean R_MMXExt = false;
 boolean R_SSE2 = false;
+boolean R_AVX2 = false;
 
 void SCR_SetDrawFuncs(void)
 {
@@ -156,6 +157,31 @@ void SCR_SetDrawFuncs(void)
 		spanfuncs_npo2[SPANDRAWFUNC_TILTEDWATER] = R_DrawTiltedTranslucentWaterSpan_NPO2_8;
 		spanfuncs_npo2[SPANDRAWFUNC_FOG] = NULL; // Not needed
 
+#ifdef SIMDSPANS
+		if (R_AVX2)
+		{
+			spanfuncs[BASEDRAWFUNC] = R_DrawSpan_8_AVX2;
+			spanfuncs[SPANDRAWFUNC_TRANS] = R_DrawTranslucentSpan_8_AVX2;
+			spanfuncs[SPANDRAWFUNC_TILTED] = R_DrawTiltedSpan_8_AVX2;
+			spanfuncs[SPANDRAWFUNC_TILTEDTRANS] = R_DrawTiltedTranslucentSpan_8_AVX2;
+			spanfuncs[SPANDRAWFUNC_WATER] = R_DrawTranslucentWaterSpan_8_AVX2;
+			spanfuncs[SPANDRAWFUNC_TILTEDWATER] = R_DrawTiltedTranslucentWaterSpan_8_AVX2;
+
+			V_MapBytes = V_MapBytes_AVX2;
+			V_BlendBytes = V_BlendBytes_AVX2;
+		}
+		else if (R_SSE2)
+		{
+			spanfuncs[BASEDRAWFUNC] = R_DrawSpan_8_SSE2;
+			spanfuncs[SPANDRAWFUNC_TRANS] = R_DrawTranslucentSpan_8_SSE2;
+			spanfuncs[SPANDRAWFUNC_TILTED] = R_DrawTiltedSpan_8_SSE2;
+			spanfuncs[SPANDRAWFUNC_TILTEDTRANS] = R_DrawTiltedTranslucentSpan_8_SSE2;
+			spanfuncs[SPANDRAWFUNC_WATER] = R_DrawTranslucentWaterSpan_8_SSE2;
+			spanfuncs[SPANDRAWFUNC_TILTEDWATER] = R_DrawTiltedTranslucentWaterSpan_8_SSE2;
+		}
+		spanfunc = spanfuncs[BASEDRAWFUNC];
+#endif
+
 #ifdef RUSEASM
 		if (R_ASM)
 		{
@@ -255,7 +281,9 @@ void SCR_Startup(void)
 			R_SSE = true;
 		if (RCpuInfo->SSE2)
 			R_SSE2 = true;
-		CONS_Printf("CPU Info: 486: %i, 586: %i, MMX: %i, 3DNow: %i, MMXExt: %i, SSE2: %i\n", R_486, R_586, R_MMX, R_3DNow, R_MMXExt, R_SSE2);
+		if (RCpuInfo->AVX2)
+			R_AVX2 = true;
+		CONS_Printf("CPU Info: 486: %i, 586: %i, MMX: %i, 3DNow: %i, MMXExt: %i, SSE2: %i, AVX2: %i\n", R_486, R_586, R_MMX, R_3DNow, R_MMXExt, R_SSE2, R_AVX2);
 	}
 
 	if (M_CheckParm("-noASM"))
@@ -278,6 +306,15 @@ void SCR_Startup(void)
 
 	if (M_CheckParm("-SSE2"))
 		R_SSE2 = true;
+	if (M_CheckParm("-noSSE2"))
+		R_SSE2 = false;
+
+	// Unlike the older instruction sets, AVX2 also needs the OS to save the
+	// upper halves of the registers, so it is never used without the CPU check
+	if (M_CheckParm("-AVX2") && RCpuInfo && RCpuInfo->AVX2)
+		R_AVX2 = true;
+	if (M_CheckParm("-noAVX2"))
+		R_AVX2 = false;
 
 	M_SetupMemcpy();
 
@@ -295,6 +332,7 @@ void SCR_Startup(void)
 
 	CV_RegisterVar(&cv_ticrate);
 	CV_RegisterVar(&cv_constextsize);
+	CV_RegisterVar(&cv_hudcache);
 
 	V_SetPalette(0);
 }
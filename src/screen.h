@@ -174,6 +174,13 @@ extern boolean R_MMX;
 extern boolean R_3DNow;
 extern boolean R_MMXExt;
 extern boolean R_SSE2;
+extern boolean R_AVX2;
+
+// Whether the SSE2 and AVX2 versions of the span drawers and of the
+// byte passes of the wipes are built
+#if (defined (__x86_64__) && (defined (__clang__) || (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || defined (_M_X64)
+#define SIMDSPANS
+#endif
 
 // ----------------
 // screen variables
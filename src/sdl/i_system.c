@@ -53,6 +53,11 @@ typedef LPVOID (WINAPI *p_MapViewOfFile) (HANDLE, DWORD, DWORD, DWORD, SIZE_T);
 #if defined (__unix__) || defined (UNIXCOMMON)
 #include <fcntl.h>
 #endif
+#if defined (__unix__) || defined(__APPLE__) || defined (UNIXCOMMON)
+#include <sys/mman.h> // I_MapFile
+#elif defined (_WIN32)
+#include <io.h> // _get_osfhandle
+#endif
 
 #include <stdio.h>
 #ifdef _WIN32
@@ -3092,6 +3097,54 @@ UINT32 I_GetFreeMem(UINT32 *total)
 #endif
 }
 
+void *I_MapFile(FILE *handle, size_t size)
+{
+#if defined (_WIN32)
+	HANDLE file, mapping;
+	void *ptr;
+
+	if (!size)
+		return NULL;
+
+	file = (HANDLE)_get_osfhandle(_fileno(handle));
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+		return NULL;
+
+	ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+	CloseHandle(mapping); // the view keeps the mapping alive
+	return ptr;
+#elif defined (__unix__) || defined(__APPLE__) || defined (UNIXCOMMON)
+	void *ptr;
+
+	if (!size)
+		return NULL;
+
+	ptr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(handle), 0);
+	return (ptr == MAP_FAILED) ? NULL : ptr;
+#else
+	(void)handle;
+	(void)size;
+	return NULL;
+#endif
+}
+
+void I_UnmapFile(void *ptr, size_t size)
+{
+#if defined (_WIN32)
+	(void)size;
+	UnmapViewOfFile(ptr);
+#elif defined (__unix__) || defined(__APPLE__) || defined (UNIXCOMMON)
+	munmap(ptr, size);
+#else
+	(void)ptr;
+	(void)size;
+#endif
+}
+
 const CPUInfoFlags *I_CPUInfo(void)
 {
 #if defined (_WIN32)
@@ -3132,6 +3185,9 @@ const CPUInfoFlags *I_CPUInfo(void)
 	}
 	WIN_CPUInfo.MMXExt      = SDL_FALSE; //SDL_HasMMXExt(); No longer in SDL2
 	WIN_CPUInfo.AMD3DNowExt = SDL_FALSE; //SDL_Has3DNowExt(); No longer in SDL2
+#if SDL_VERSION_ATLEAST(2,0,4)
+	WIN_CPUInfo.AVX2        = SDL_HasAVX2();
+#endif
 #endif
 	GetSystemInfo(&SI);
 	WIN_CPUInfo.CPUs = SI.dwNumberOfProcessors;
@@ -3148,6 +3204,9 @@ const CPUInfoFlags *I_CPUInfo(void)
 	SDL_CPUInfo.AMD3DNowExt = SDL_FALSE; //SDL_Has3DNowExt(); No longer in SDL2
 	SDL_CPUInfo.SSE         = SDL_HasSSE();
 	SDL_CPUInfo.SSE2        = SDL_HasSSE2();
+#if SDL_VERSION_ATLEAST(2,0,4)
+	SDL_CPUInfo.AVX2        = SDL_HasAVX2();
+#endif
 	SDL_CPUInfo.AltiVec     = SDL_HasAltiVec();
 	return &SDL_CPUInfo;
 #else
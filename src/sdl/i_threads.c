@@ -191,6 +191,12 @@ I_spawn_thread (
 	I_unlock_mutex(i_thread_pool_mutex);
 }
 
+int
+I_cpu_count (void)
+{
+	return SDL_GetCPUCount();
+}
+
 int
 I_thread_is_stopped (void)
 {
@@ -235,6 +235,8 @@ void ST_LoadGraphics(void)
 {
 	int i;
 
+	V_InvalidateHUDElements();
+
 	// SRB2 border patch
 	// st_borderpatchnum = W_GetNumForName("GFZFLR01");
 	// scr_borderpatch = W_CacheLumpNum(st_borderpatchnum, PU_HUDGFX);
@@ -345,6 +347,8 @@ void ST_LoadGraphics(void)
 // made separate so that skins code can reload custom face graphics
 void ST_LoadFaceGraphics(INT32 skinnum)
 {
+	V_InvalidateHUDElements();
+
 	if (skins[skinnum].sprites[SPR2_XTRA].numframes > XTRA_LIFEPIC)
 	{
 		spritedef_t *sprdef = &skins[skinnum].sprites[SPR2_XTRA];
@@ -620,22 +624,43 @@ static void ST_drawDebugInfo(void)
 #undef VFLAGS
 }
 
-static void ST_drawScore(void)
+// Score, time and rings are only drawn again when they change, once for each splitscreen view.
+static hudelement_t scoreelements[2], timeelements[2], ringselements[2];
+#define ST_HUDELEMENT(e) (&(e)[(splitscreen && stplyr == &players[secondarydisplayplayer]) ? 1 : 0])
+
+static UINT32 ST_HashHudItems(UINT32 key, hudnum_t first, hudnum_t last)
 {
-	if (F_GetPromptHideHud(hudinfo[HUD_SCORE].y))
-		return;
+	key = V_HashHUDKey(key, &hudinfo[first], (last - first + 1) * sizeof(hudinfo_t));
+	key = V_HashHUDKey(key, &cv_timetic.value, sizeof(cv_timetic.value));
+	return V_HashHUDKey(key, &tallnum[0], sizeof(tallnum[0]));
+}
+
+static void ST_drawScoreElement(void *userdata)
+{
+	INT32 score = *(INT32 *)userdata;
 
 	// SCORE:
 	ST_DrawPatchFromHud(HUD_SCORE, sboscore, V_HUDTRANS);
-	if (objectplacing)
-	{
-		if (op_displayflags > UINT16_MAX)
-			ST_DrawTopLeftOverlayPatch((hudinfo[HUD_SCORENUM].x-tallminus->width), hudinfo[HUD_SCORENUM].y, tallminus);
-		else
-			ST_DrawNumFromHud(HUD_SCORENUM, op_displayflags, V_HUDTRANS);
-	}
+	if (objectplacing && op_displayflags > UINT16_MAX)
+		ST_DrawTopLeftOverlayPatch((hudinfo[HUD_SCORENUM].x-tallminus->width), hudinfo[HUD_SCORENUM].y, tallminus);
 	else
-		ST_DrawNumFromHud(HUD_SCORENUM, stplyr->score, V_HUDTRANS);
+		ST_DrawNumFromHud(HUD_SCORENUM, score, V_HUDTRANS);
+}
+
+static void ST_drawScore(void)
+{
+	INT32 score = (INT32)(objectplacing ? op_displayflags : stplyr->score);
+	UINT32 key;
+
+	if (F_GetPromptHideHud(hudinfo[HUD_SCORE].y))
+		return;
+
+	key = ST_HashHudItems(0, HUD_SCORE, HUD_SCORENUM);
+	key = V_HashHUDKey(key, &objectplacing, sizeof(objectplacing));
+	key = V_HashHUDKey(key, &op_displayflags, sizeof(op_displayflags));
+	key = V_HashHUDKey(key, &score, sizeof(score));
+
+	V_DrawHUDElement(ST_HUDELEMENT(scoreelements), key, ST_drawScoreElement, &score);
 }
 
 static void ST_drawRaceNum(INT32 time)
@@ -671,6 +696,38 @@ static void ST_drawRaceNum(INT32 time)
 	V_DrawScaledPatch(((BASEVIDWIDTH - racenum->width)/2), height, V_PERPLAYER, racenum);
 }
 
+typedef struct
+{
+	INT32 tics, minutes, seconds, tictrn;
+	INT32 downwards, showtics;
+} sttime_t;
+
+static void ST_drawTimeElement(void *userdata)
+{
+	const sttime_t *time = userdata;
+
+	// TIME:
+	ST_DrawPatchFromHud(HUD_TIME, (time->downwards ? sboredtime : sbotime), V_HUDTRANS);
+
+	if (time->downwards) // overtime!
+		return;
+
+	if (cv_timetic.value == 3) // Tics only -- how simple is this?
+		ST_DrawNumFromHud(HUD_SECONDS, time->tics, V_HUDTRANS);
+	else
+	{
+		ST_DrawNumFromHud(HUD_MINUTES, time->minutes, V_HUDTRANS); // Minutes
+		ST_DrawPatchFromHud(HUD_TIMECOLON, sbocolon, V_HUDTRANS); // Colon
+		ST_DrawPadNumFromHud(HUD_SECONDS, time->seconds, 2, V_HUDTRANS); // Seconds
+
+		if (time->showtics)
+		{
+			ST_DrawPatchFromHud(HUD_TIMETICCOLON, sboperiod, V_HUDTRANS); // Period
+			ST_DrawPadNumFromHud(HUD_TICS, time->tictrn, 2, V_HUDTRANS); // Tics
+		}
+	}
+}
+
 static void ST_drawTime(void)
 {
 	INT32 seconds, minutes, tictrn, tics;
@@ -741,48 +798,64 @@ static void ST_drawTime(void)
 
 	downwards = (downwards && (tics < 30*TICRATE) && (leveltime/5 & 1) && !stoppedclock); // overtime?
 
-	// TIME:
-	ST_DrawPatchFromHud(HUD_TIME, (downwards ? sboredtime : sbotime), V_HUDTRANS);
+	{
+		sttime_t time;
+		UINT32 key;
 
-	if (downwards) // overtime!
-		return;
+		time.tics = tics;
+		time.minutes = minutes;
+		time.seconds = seconds;
+		time.tictrn = tictrn;
+		time.downwards = downwards;
+		time.showtics = (cv_timetic.value == 1 || cv_timetic.value == 2 || modeattacking || marathonmode);
 
-	if (cv_timetic.value == 3) // Tics only -- how simple is this?
-		ST_DrawNumFromHud(HUD_SECONDS, tics, V_HUDTRANS);
-	else
-	{
-		ST_DrawNumFromHud(HUD_MINUTES, minutes, V_HUDTRANS); // Minutes
-		ST_DrawPatchFromHud(HUD_TIMECOLON, sbocolon, V_HUDTRANS); // Colon
-		ST_DrawPadNumFromHud(HUD_SECONDS, seconds, 2, V_HUDTRANS); // Seconds
+		key = ST_HashHudItems(0, HUD_TIME, HUD_TIMETICCOLON);
+		key = V_HashHUDKey(key, &time, sizeof(time));
 
-		if (cv_timetic.value == 1 || cv_timetic.value == 2 || modeattacking || marathonmode)
-		{
-			ST_DrawPatchFromHud(HUD_TIMETICCOLON, sboperiod, V_HUDTRANS); // Period
-			ST_DrawPadNumFromHud(HUD_TICS, tictrn, 2, V_HUDTRANS); // Tics
-		}
+		V_DrawHUDElement(ST_HUDELEMENT(timeelements), key, ST_drawTimeElement, &time);
 	}
 }
 
+typedef struct
+{
+	patch_t *patch;
+	INT32 ringnum, flags;
+} strings_t;
+
+static void ST_drawRingsElement(void *userdata)
+{
+	const strings_t *rings = userdata;
+
+	ST_DrawPatchFromHud(HUD_RINGS, rings->patch, rings->flags);
+
+	if (cv_timetic.value == 2) // Yes, even in modeattacking
+		ST_DrawNumFromHud(HUD_RINGSNUMTICS, rings->ringnum, V_PERPLAYER|rings->flags);
+	else
+		ST_DrawNumFromHud(HUD_RINGSNUM, rings->ringnum, V_PERPLAYER|rings->flags);
+}
+
 static inline void ST_drawRings(void)
 {
-	INT32 ringnum;
+	strings_t rings;
+	UINT32 key;
 
 	if (F_GetPromptHideHud(hudinfo[HUD_RINGS].y))
 		return;
 
-	ST_DrawPatchFromHud(HUD_RINGS, ((!stplyr->spectator && stplyr->rings <= 0 && leveltime/5 & 1) ? sboredrings : sborings), ((stplyr->spectator) ? V_HUDTRANSHALF : V_HUDTRANS));
+	rings.patch = ((!stplyr->spectator && stplyr->rings <= 0 && leveltime/5 & 1) ? sboredrings : sborings);
+	rings.flags = ((stplyr->spectator) ? V_HUDTRANSHALF : V_HUDTRANS);
 
 	if (objectplacing)
-		ringnum = op_currentdoomednum;
+		rings.ringnum = op_currentdoomednum;
 	else if (stplyr->rings < 0 || stplyr->spectator || stplyr->playerstate == PST_REBORN)
-		ringnum = 0;
+		rings.ringnum = 0;
 	else
-		ringnum = stplyr->rings;
+		rings.ringnum = stplyr->rings;
 
-	if (cv_timetic.value == 2) // Yes, even in modeattacking
-		ST_DrawNumFromHud(HUD_RINGSNUMTICS, ringnum, V_PERPLAYER|((stplyr->spectator) ? V_HUDTRANSHALF : V_HUDTRANS));
-	else
-		ST_DrawNumFromHud(HUD_RINGSNUM, ringnum, V_PERPLAYER|((stplyr->spectator) ? V_HUDTRANSHALF : V_HUDTRANS));
+	key = ST_HashHudItems(0, HUD_RINGS, HUD_RINGSNUMTICS);
+	key = V_HashHUDKey(key, &rings, sizeof(rings));
+
+	V_DrawHUDElement(ST_HUDELEMENT(ringselements), key, ST_drawRingsElement, &rings);
 }
 
 static void ST_drawLivesArea(void)
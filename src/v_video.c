@@ -34,6 +34,10 @@
 #include "hardware/hw_glob.h"
 #endif
 
+#ifdef SIMDSPANS
+#include <immintrin.h>
+#endif
+
 // Each screen is [vid.width*vid.height];
 UINT8 *screens[5];
 // screens[0] = main display window
@@ -77,6 +81,8 @@ consvar_t cv_csaturation = CVAR_INIT ("csaturation", "10", CV_SAVE|CV_CALL, satu
 consvar_t cv_bsaturation = CVAR_INIT ("bsaturation", "10", CV_SAVE|CV_CALL, saturation_cons_t, CV_palette_OnChange);
 consvar_t cv_msaturation = CVAR_INIT ("msaturation", "10", CV_SAVE|CV_CALL, saturation_cons_t, CV_palette_OnChange);
 
+consvar_t cv_hudcache = CVAR_INIT ("hudcache", "On", 0, CV_OnOff, NULL);
+
 static CV_PossibleValue_t constextsize_cons_t[] = {
 	{V_NOSCALEPATCH, "Small"}, {V_SMALLSCALEPATCH, "Medium"}, {V_MEDSCALEPATCH, "Large"}, {0, "Huge"},
 	{0, NULL}};
@@ -483,6 +489,258 @@ void VID_BlitLinearScreen(const UINT8 *srcptr, UINT8 *destptr, INT32 width, INT3
 #endif
 }
 
+// --------------------------------------------------------------------------
+// Retained HUD elements
+// --------------------------------------------------------------------------
+
+// An element is recorded by drawing it into two layers, one cleared to 0x00 and
+// the other to 0xFF. The pixels it drew are the ones where both layers agree.
+// Only the rectangle the drawers report is compared, and then cleared again.
+static UINT8 *hudlayers[2] = {NULL, NULL};
+static size_t hudlayersize = 0;
+
+static boolean v_hudrecording = false;
+static boolean v_hudblended = false;
+static INT32 v_hudrect[4];
+
+// Bumped when the graphics the HUD is drawn with are reloaded
+static UINT32 hudgeneration = 0;
+
+typedef struct
+{
+	UINT32 ofs, length;
+} hudrun_t;
+
+// Grows the rectangle the element being recorded has drawn to.
+static inline void V_MarkHUDRect(INT32 x1, INT32 y1, INT32 x2, INT32 y2)
+{
+	if (!v_hudrecording)
+		return;
+
+	if (x1 < v_hudrect[0]) v_hudrect[0] = x1;
+	if (y1 < v_hudrect[1]) v_hudrect[1] = y1;
+	if (x2 > v_hudrect[2]) v_hudrect[2] = x2;
+	if (y2 > v_hudrect[3]) v_hudrect[3] = y2;
+}
+
+// The pixels just drawn depend on what was under them, so they can't be cached.
+static inline void V_MarkHUDBlend(void)
+{
+	v_hudblended = true;
+	V_MarkHUDRect(0, 0, vid.width, vid.height);
+}
+
+UINT32 V_HashHUDKey(UINT32 key, const void *data, size_t length)
+{
+	const UINT8 *p = data;
+
+	while (length--)
+		key = (key ^ *p++) * 0x01000193u;
+
+	return key;
+}
+
+void V_InvalidateHUDElements(void)
+{
+	hudgeneration++;
+}
+
+static void V_AllocHUDLayers(void)
+{
+	size_t size = vid.width * vid.height;
+
+	if (hudlayersize == size)
+		return;
+
+	Z_Free(hudlayers[0]);
+	Z_Free(hudlayers[1]);
+
+	hudlayers[0] = Z_Malloc(size, PU_STATIC, NULL);
+	hudlayers[1] = Z_Malloc(size, PU_STATIC, NULL);
+	memset(hudlayers[0], 0x00, size);
+	memset(hudlayers[1], 0xFF, size);
+
+	hudlayersize = size;
+}
+
+// Copies the runs of a recorded element onto the screen.
+static void V_PutHUDElement(hudelement_t *element)
+{
+	const hudrun_t *run = (const hudrun_t *)(void *)element->runs;
+	const UINT8 *pixels = element->runs + element->numruns * sizeof(hudrun_t);
+	INT32 i;
+
+	for (i = 0; i < element->numruns; i++, run++)
+	{
+		M_Memcpy(screens[0] + run->ofs, pixels, run->length);
+		pixels += run->length;
+	}
+}
+
+// Turns what was drawn into the layers into runs, and clears the layers behind it.
+static void V_StoreHUDElement(hudelement_t *element, INT32 x1, INT32 y1, INT32 x2, INT32 y2)
+{
+	INT32 numruns = 0, x, y, start;
+	size_t numpixels = 0, size;
+	hudrun_t *run;
+	UINT8 *pixels;
+
+	for (y = y1; y < y2; y++)
+	{
+		const UINT8 *a = hudlayers[0] + y*vid.width;
+		const UINT8 *b = hudlayers[1] + y*vid.width;
+
+		for (x = x1; x < x2; x++)
+		{
+			if (a[x] != b[x])
+				continue;
+			for (start = x; x < x2 && a[x] == b[x]; x++)
+				;
+			numruns++;
+			numpixels += x - start;
+		}
+	}
+
+	size = numruns * sizeof(hudrun_t) + numpixels;
+	if (size > element->size)
+	{
+		element->runs = Z_Realloc(element->runs, size, PU_STATIC, NULL);
+		element->size = size;
+	}
+
+	run = (hudrun_t *)(void *)element->runs;
+	pixels = element->runs + numruns * sizeof(hudrun_t);
+
+	for (y = y1; y < y2; y++)
+	{
+		UINT8 *a = hudlayers[0] + y*vid.width;
+		UINT8 *b = hudlayers[1] + y*vid.width;
+
+		for (x = x1; x < x2; x++)
+		{
+			if (a[x] != b[x])
+				continue;
+			for (start = x; x < x2 && a[x] == b[x]; x++)
+				*pixels++ = a[x];
+			run->ofs = y*vid.width + start;
+			run->length = x - start;
+			run++;
+		}
+
+		memset(a + x1, 0x00, x2 - x1);
+		memset(b + x1, 0xFF, x2 - x1);
+	}
+
+	element->numruns = numruns;
+}
+
+/**	\brief	Draws a HUD element, or puts it back from the last time it was drawn
+		if nothing it depends on has changed.
+
+	The draw function is called twice when the element is recorded,
+	so it must not do anything but draw.
+
+	\param	element		where the element is cached
+	\param	key		hash of everything the element is drawn from, see V_HashHUDKey
+	\param	draw		function that draws the element
+	\param	userdata	passed to the draw function
+
+	\return	void
+*/
+void V_DrawHUDElement(hudelement_t *element, UINT32 key, void (*draw)(void *), void *userdata)
+{
+	UINT8 *screen = screens[0];
+	INT32 x1, y1, x2, y2, patches, counted;
+	INT32 view = stplyr ? (INT32)(stplyr - players) : -1;
+
+	if (rendermode != render_soft || !cv_hudcache.value || v_hudrecording || !screen)
+	{
+		draw(userdata);
+		return;
+	}
+
+	key = V_HashHUDKey(key, &vid.width, sizeof(vid.width));
+	key = V_HashHUDKey(key, &vid.height, sizeof(vid.height));
+	key = V_HashHUDKey(key, &splitscreen, sizeof(splitscreen));
+	key = V_HashHUDKey(key, &view, sizeof(view));
+	key = V_HashHUDKey(key, &st_translucency, sizeof(st_translucency));
+	key = V_HashHUDKey(key, &hudgeneration, sizeof(hudgeneration));
+
+	if (element->cached && element->key == key)
+	{
+		V_PutHUDElement(element);
+		ps_hudpatchreuses += element->patches;
+		return;
+	}
+
+	element->cached = false;
+	element->key = key;
+
+	// It was translucent last time, so draw it straight to
+	// the screen until it isn't.
+	if (element->blended)
+	{
+		v_hudblended = false;
+		draw(userdata);
+		element->blended = v_hudblended;
+		return;
+	}
+
+	V_AllocHUDLayers();
+
+	v_hudrecording = true;
+	v_hudblended = false;
+	v_hudrect[0] = v_hudrect[1] = INT32_MAX;
+	v_hudrect[2] = v_hudrect[3] = INT32_MIN;
+
+	counted = ps_hudpatchdraws;
+	screens[0] = hudlayers[0];
+	draw(userdata);
+	patches = ps_hudpatchdraws - counted;
+
+	if (!v_hudblended)
+	{
+		screens[0] = hudlayers[1];
+		draw(userdata);
+	}
+
+	// Count the element's patches once, however many times it was drawn
+	ps_hudpatchdraws = counted + patches;
+
+	screens[0] = screen;
+	v_hudrecording = false;
+
+	x1 = max(v_hudrect[0], 0);
+	y1 = max(v_hudrect[1], 0);
+	x2 = min(v_hudrect[2], vid.width);
+	y2 = min(v_hudrect[3], vid.height);
+
+	if (x1 >= x2 || y1 >= y2)
+	{
+		x1 = y1 = x2 = y2 = 0;
+	}
+
+	if (v_hudblended)
+	{
+		for (; y1 < y2; y1++)
+		{
+			memset(hudlayers[0] + y1*vid.width + x1, 0x00, x2 - x1);
+			memset(hudlayers[1] + y1*vid.width + x1, 0xFF, x2 - x1);
+		}
+
+		element->blended = true;
+		ps_hudpatchdraws = counted;
+		draw(userdata);
+		return;
+	}
+
+	V_StoreHUDElement(element, x1, y1, x2, y2);
+	element->patches = patches;
+	element->cached = true;
+
+	V_PutHUDElement(element);
+}
+
 static UINT8 hudplusalpha[11]  = { 10,  8,  6,  4,  2,  0,  0,  0,  0,  0,  0};
 static UINT8 hudminusalpha[11] = { 10,  9,  9,  8,  8,  7,  7,  6,  6,  5,  5};
 
@@ -506,6 +764,298 @@ static inline UINT8 transmappedpdraw(const UINT8 *dest, const UINT8 *source, fix
 	return *(v_translevel + (((*(v_colormap + source[ofs>>FRACBITS]))<<8)&0xff00) + (*dest&0xff));
 }
 
+// --------------------------------------------------------------------------
+// Pre-scaled patches
+// --------------------------------------------------------------------------
+
+// A patch scaled for the screen, so it can be drawn without stepping through it.
+// Every column of the screen it covers has a list of runs:
+// the row the run starts on, its length, then its pixels.
+// A row of SCALEDPATCH_END ends the list.
+typedef struct
+{
+	// What the patch was scaled from
+	const patch_t *patch;
+	const UINT8 *columns;
+	INT16 width, height;
+	fixed_t colfrac, rowfrac, vdup;
+
+	UINT32 lastuse;
+	INT32 uses; // Only scaled once it's drawn twice at the same scale
+	size_t size;
+	UINT8 *data; // Column offsets, then the runs of every column
+} scaledpatch_t;
+
+#define SCALEDPATCH_SETS 256
+#define SCALEDPATCH_WAYS 8
+#define SCALEDPATCH_BUDGET (16<<20)
+#define SCALEDPATCH_MAXSIZE (512<<10) // Bigger patches are drawn as they are
+#define SCALEDPATCH_END 0xFFFF
+#define SCALEDPATCH_TOOBIG ((UINT8 *)(-1))
+
+static scaledpatch_t scaledpatches[SCALEDPATCH_SETS][SCALEDPATCH_WAYS];
+static size_t scaledpatchmemory = 0;
+static UINT32 scaledpatchclock = 0;
+static boolean scaledpatchesused = false;
+
+static inline void V_WriteScaledRow(UINT8 *p, UINT16 value)
+{
+	memcpy(p, &value, sizeof(UINT16));
+}
+
+static inline UINT16 V_ReadScaledRow(const UINT8 *p)
+{
+	UINT16 value;
+	memcpy(&value, p, sizeof(UINT16));
+	return value;
+}
+
+static void V_FreeScaledPatch(scaledpatch_t *sp)
+{
+	if (sp->data && sp->data != SCALEDPATCH_TOOBIG)
+	{
+		Z_Free(sp->data);
+		scaledpatchmemory -= sp->size;
+	}
+	memset(sp, 0, sizeof(scaledpatch_t));
+}
+
+// Frees every pre-scaled patch, for when the resolution changes,
+// or when patches are freed and their memory could hold new ones.
+void V_FlushScaledPatches(void)
+{
+	INT32 i, j;
+
+	if (!scaledpatchesused)
+		return;
+	scaledpatchesused = false;
+
+	for (i = 0; i < SCALEDPATCH_SETS; i++)
+		for (j = 0; j < SCALEDPATCH_WAYS; j++)
+			V_FreeScaledPatch(&scaledpatches[i][j]);
+}
+
+// Walks the patch exactly like V_DrawStretchyFixedPatch does, and writes the runs
+// into out. If out is NULL, it only returns how many bytes they take.
+static size_t V_ScalePatchColumns(const patch_t *patch, fixed_t colfrac, fixed_t rowfrac, fixed_t vdup, UINT8 *out)
+{
+	fixed_t col, ofs;
+	INT32 numcols = 0, c = 0;
+	size_t size;
+	const column_t *column;
+
+	for (col = 0; (col>>FRACBITS) < patch->width; col += colfrac)
+		numcols++;
+
+	size = numcols * sizeof(UINT32);
+
+	for (col = 0; (col>>FRACBITS) < patch->width; col += colfrac, c++)
+	{
+		INT32 topdelta, prevdelta = -1;
+
+		if (out)
+			((UINT32 *)(void *)out)[c] = (UINT32)size;
+
+		column = (const column_t *)((const UINT8 *)(patch->columns) + (patch->columnofs[col>>FRACBITS]));
+
+		while (column->topdelta != 0xff)
+		{
+			const UINT8 *source;
+			INT32 row, length = 0;
+
+			topdelta = column->topdelta;
+			if (topdelta <= prevdelta)
+				topdelta += prevdelta;
+			prevdelta = topdelta;
+			source = (const UINT8 *)(column) + 3;
+			row = FixedInt(FixedMul(topdelta<<FRACBITS, vdup));
+
+			for (ofs = 0; (ofs>>FRACBITS) < column->length; ofs += rowfrac)
+			{
+				if (out)
+					out[size + 4 + length] = source[ofs>>FRACBITS];
+				length++;
+			}
+
+			if (row < 0 || row >= SCALEDPATCH_END || length > UINT16_MAX)
+				return 0;
+
+			if (out)
+			{
+				V_WriteScaledRow(out + size, (UINT16)row);
+				V_WriteScaledRow(out + size + 2, (UINT16)length);
+			}
+			size += 4 + length;
+
+			if (size > SCALEDPATCH_MAXSIZE)
+				return 0;
+
+			column = (const column_t *)((const UINT8 *)column + column->length + 4);
+		}
+
+		if (out)
+			V_WriteScaledRow(out + size, SCALEDPATCH_END);
+		size += 2;
+	}
+
+	return size;
+}
+
+/**	\brief	Finds the patch pre-scaled with these steps,
+		scaling it if it was drawn at this scale before.
+
+	\return	The pre-scaled patch, or NULL to draw it as it is
+*/
+static scaledpatch_t *V_GetScaledPatch(const patch_t *patch, fixed_t colfrac, fixed_t rowfrac, fixed_t vdup)
+{
+	UINT32 hash = (UINT32)(size_t)patch * 0x9E3779B1u;
+	scaledpatch_t *set, *sp = NULL;
+	INT32 i;
+
+	hash ^= (UINT32)colfrac * 0x85EBCA6Bu;
+	hash ^= (UINT32)rowfrac * 0xC2B2AE35u;
+	set = scaledpatches[(hash ^ (hash >> 16)) & (SCALEDPATCH_SETS - 1)];
+
+	scaledpatchclock++;
+	scaledpatchesused = true;
+
+	for (i = 0; i < SCALEDPATCH_WAYS; i++)
+	{
+		if (set[i].patch == patch && set[i].columns == patch->columns
+		&& set[i].width == patch->width && set[i].height == patch->height
+		&& set[i].colfrac == colfrac && set[i].rowfrac == rowfrac && set[i].vdup == vdup)
+		{
+			sp = &set[i];
+			break;
+		}
+	}
+
+	if (!sp)
+	{
+		// Replace whatever in the set was drawn the longest time ago
+		sp = &set[0];
+		for (i = 1; i < SCALEDPATCH_WAYS; i++)
+			if (set[i].lastuse < sp->lastuse)
+				sp = &set[i];
+
+		V_FreeScaledPatch(sp);
+		sp->patch = patch;
+		sp->columns = patch->columns;
+		sp->width = patch->width;
+		sp->height = patch->height;
+		sp->colfrac = colfrac;
+		sp->rowfrac = rowfrac;
+		sp->vdup = vdup;
+	}
+
+	sp->lastuse = scaledpatchclock;
+
+	if (sp->data == SCALEDPATCH_TOOBIG)
+		return NULL;
+
+	if (!sp->data)
+	{
+		if (++sp->uses < 2)
+			return NULL;
+
+		sp->size = V_ScalePatchColumns(patch, colfrac, rowfrac, vdup, NULL);
+		if (!sp->size)
+		{
+			sp->data = SCALEDPATCH_TOOBIG;
+			return NULL;
+		}
+
+		// Keep within the budget, freeing what was drawn the longest time ago
+		while (scaledpatchmemory + sp->size > SCALEDPATCH_BUDGET)
+		{
+			scaledpatch_t *oldest = NULL;
+			INT32 j;
+
+			for (i = 0; i < SCALEDPATCH_SETS; i++)
+				for (j = 0; j < SCALEDPATCH_WAYS; j++)
+					if (scaledpatches[i][j].data && scaledpatches[i][j].data != SCALEDPATCH_TOOBIG
+					&& (!oldest || scaledpatches[i][j].lastuse < oldest->lastuse))
+						oldest = &scaledpatches[i][j];
+
+			if (!oldest)
+				break;
+			V_FreeScaledPatch(oldest);
+		}
+
+		sp->data = Z_Malloc(sp->size, PU_STATIC, NULL);
+		V_ScalePatchColumns(patch, colfrac, rowfrac, vdup, sp->data);
+		scaledpatchmemory += sp->size;
+	}
+
+	return sp;
+}
+
+// Draws a pre-scaled patch. Clips it just like V_DrawStretchyFixedPatch does.
+static void V_DrawScaledPatchColumns(const scaledpatch_t *sp, INT32 scrn, INT32 x, fixed_t pwidth, UINT8 *desttop)
+{
+	const UINT8 *screen = screens[scrn&V_PARAMMASK];
+	const UINT8 *deststop = screen + vid.rowbytes * vid.height;
+	UINT8 *deststart = desttop, *destend = desttop + pwidth;
+	const UINT32 *runofs = (const UINT32 *)(void *)sp->data;
+	INT32 offx, numcols = (INT32)(runofs[0] / sizeof(UINT32));
+
+	for (offx = 0; offx < numcols; offx++, desttop++)
+	{
+		const UINT8 *run = sp->data + runofs[offx];
+		UINT8 *column = desttop;
+
+		if (scrn & V_FLIP) // offx is measured from right edge instead of left
+		{
+			if (x+pwidth-offx < 0) // don't draw off the left of the screen (WRAP PREVENTION)
+				break;
+			if (x+pwidth-offx >= vid.width) // don't draw off the right of the screen (WRAP PREVENTION)
+				continue;
+			column = deststart + (destend - desttop);
+		}
+		else
+		{
+			if (x+offx < 0) // don't draw off the left of the screen (WRAP PREVENTION)
+				continue;
+			if (x+offx >= vid.width) // don't draw off the right of the screen (WRAP PREVENTION)
+				break;
+		}
+
+		for (;;)
+		{
+			INT32 row = V_ReadScaledRow(run), length;
+			const UINT8 *pixels;
+			UINT8 *dest;
+
+			if (row == SCALEDPATCH_END)
+				break;
+
+			length = V_ReadScaledRow(run + 2);
+			pixels = run + 4;
+			run += 4 + length;
+			dest = column + row*vid.width;
+
+			if (v_translevel)
+			{
+				for (; length-- && dest < deststop; dest += vid.width, pixels++)
+					if (dest >= screen)
+						*dest = *(v_translevel + (((v_colormap ? v_colormap[*pixels] : *pixels)<<8)&0xff00) + (*dest&0xff));
+			}
+			else if (v_colormap)
+			{
+				for (; length-- && dest < deststop; dest += vid.width, pixels++)
+					if (dest >= screen)
+						*dest = v_colormap[*pixels];
+			}
+			else
+			{
+				for (; length-- && dest < deststop; dest += vid.width, pixels++)
+					if (dest >= screen)
+						*dest = *pixels;
+			}
+		}
+	}
+}
+
 // Draws a patch scaled to arbitrary size.
 void V_DrawStretchyFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, fixed_t vscale, INT32 scrn, patch_t *patch, const UINT8 *colormap)
 {
@@ -534,6 +1084,8 @@ void V_DrawStretchyFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, fixed_t vsca
 	}
 #endif
 
+	ps_hudpatchdraws++;
+
 	patchdrawfunc = standardpdraw;
 
 	v_translevel = NULL;
@@ -762,6 +1314,21 @@ void V_DrawStretchyFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, fixed_t vsca
 	else
 		pwidth = patch->width * dupx;
 
+	if (v_translevel)
+		V_MarkHUDBlend();
+	else
+		V_MarkHUDRect(x, y, x + pwidth + 1, y + FixedInt(FixedMul(patch->height<<FRACBITS, vdup)) + 2);
+
+	if (colfrac != FRACUNIT || rowfrac != FRACUNIT)
+	{
+		const scaledpatch_t *scaled = V_GetScaledPatch(patch, colfrac, rowfrac, vdup);
+		if (scaled)
+		{
+			V_DrawScaledPatchColumns(scaled, scrn, x, pwidth, desttop);
+			return;
+		}
+	}
+
 	deststart = desttop;
 	destend = desttop + pwidth;
 
@@ -825,6 +1392,8 @@ void V_DrawCroppedPatch(fixed_t x, fixed_t y, fixed_t pscale, INT32 scrn, patch_
 	if (rendermode == render_none)
 		return;
 
+	V_MarkHUDRect(0, 0, vid.width, vid.height);
+
 #ifdef HWRENDER
 	//if (rendermode != render_soft && !con_startup)		// Not this again
 	if (rendermode == render_opengl)
@@ -1070,6 +1639,8 @@ void V_DrawBlock(INT32 x, INT32 y, INT32 scrn, INT32 width, INT32 height, const
 	dest = screens[scrn] + y*vid.width + x;
 	deststop = screens[scrn] + vid.rowbytes * vid.height;
 
+	V_MarkHUDRect(x, y, x + width, y + height);
+
 	while (height--)
 	{
 		M_Memcpy(dest, src, width);
@@ -1114,6 +1685,8 @@ static void V_BlitScaledPic(INT32 rx1, INT32 ry1, INT32 scrn, pic_t * pic)
 		return;
 	}
 
+	V_MarkHUDRect(0, 0, vid.width, vid.height);
+
 	dest = screens[scrn] + max(0, ry1 * vid.width) + max(0, rx1);
 	// y cliping to the screen
 	if (ry1 + height * vid.dupy >= vid.width)
@@ -1232,6 +1805,7 @@ void V_DrawFill(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c)
 
 		if (x == 0 && y == 0 && w == BASEVIDWIDTH && h == BASEVIDHEIGHT)
 		{ // Clear the entire screen, from dest to deststop. Yes, this really works.
+			V_MarkHUDRect(0, 0, vid.width, vid.height);
 			memset(screens[0], (c&255), vid.width * vid.height * vid.bpp);
 			return;
 		}
@@ -1289,6 +1863,8 @@ void V_DrawFill(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c)
 	if (y + h > vid.height)
 		h = vid.height - y;
 
+	V_MarkHUDRect(x, y, x + w, y + h);
+
 	dest = screens[0] + y*vid.width + x;
 	deststop = screens[0] + vid.rowbytes * vid.height;
 
@@ -1356,6 +1932,8 @@ void V_DrawFillConsoleMap(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c)
 	}
 #endif
 
+	V_MarkHUDBlend();
+
 	if ((alphalevel = ((c & V_ALPHAMASK) >> V_ALPHASHIFT)))
 	{
 		if (alphalevel == 13)
@@ -1553,6 +2131,8 @@ void V_DrawFadeFill(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c, UINT16 color, U
 	}
 #endif
 
+	V_MarkHUDBlend();
+
 	if (splitscreen && (c & V_PERPLAYER))
 	{
 		fixed_t adjusty = ((c & V_NOSCALESTART) ? vid.height : BASEVIDHEIGHT)>>1;
@@ -1714,6 +2294,8 @@ void V_DrawFlatFill(INT32 x, INT32 y, INT32 w, INT32 h, lumpnum_t flatnum)
 	}
 #endif
 
+	V_MarkHUDRect(0, 0, vid.width, vid.height);
+
 	size = W_LumpLength(flatnum);
 
 	switch (size)
@@ -1805,6 +2387,107 @@ void V_DrawPatchFill(patch_t *pat)
 	}
 }
 
+// ==========================================================================
+// FULL-SCREEN BYTE PASSES
+// ==========================================================================
+
+void (*V_MapBytes)(UINT8 *dest, const UINT8 *src, size_t count, const UINT8 *table) = V_MapBytes_C;
+void (*V_BlendBytes)(UINT8 *dest, const UINT8 *fg, const UINT8 *bg, size_t count, const UINT8 *transtable) = V_BlendBytes_C;
+
+/**	\brief Looks every byte of src up in a 256-entry table.
+	dest may be the same buffer as src.
+*/
+void V_MapBytes_C(UINT8 *dest, const UINT8 *src, size_t count, const UINT8 *table)
+{
+	while (count--)
+		*dest++ = table[*src++];
+}
+
+/**	\brief Blends two rows of bytes through a translucency table,
+	with fg as the row index and bg as the column.
+*/
+void V_BlendBytes_C(UINT8 *dest, const UINT8 *fg, const UINT8 *bg, size_t count, const UINT8 *transtable)
+{
+	while (count--)
+		*dest++ = transtable[(*fg++ << 8) + *bg++];
+}
+
+#ifdef SIMDSPANS
+/**	\brief Like V_MapBytes_C, but looks up 32 bytes at a time.
+	The table is split into sixteen rows of sixteen entries, and every row is
+	shuffled in with the bytes that don't belong to it pushed out of range.
+*/
+FUNCTARGET("avx2") void V_MapBytes_AVX2(UINT8 *dest, const UINT8 *src, size_t count, const UINT8 *table)
+{
+	const __m256i sixteen = _mm256_set1_epi8(16);
+	const __m256i inrange = _mm256_set1_epi8(0x70);
+	__m256i rows[16];
+	INT32 k;
+
+	if (count >= 32)
+	{
+		for (k = 0; k < 16; k++)
+			rows[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)(table + k*16)));
+
+		while (count >= 32)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i *)(const void *)src);
+			__m256i result = _mm256_setzero_si256();
+
+			for (k = 0; k < 16; k++)
+			{
+				// Only the bytes from k*16 to k*16+15 land on 0x70-0x7F,
+				// everything else has its top bit set and shuffles in a zero
+				result = _mm256_or_si256(result, _mm256_shuffle_epi8(rows[k], _mm256_adds_epu8(x, inrange)));
+				x = _mm256_sub_epi8(x, sixteen);
+			}
+
+			_mm256_storeu_si256((__m256i *)(void *)dest, result);
+			src += 32;
+			dest += 32;
+			count -= 32;
+		}
+	}
+
+	while (count--)
+		*dest++ = table[*src++];
+}
+
+/**	\brief Reads the bytes at eight offsets from base, the same way
+	R_GatherBytes_AVX2 in the span drawers does: each lane reads the dword
+	that ends at its byte, so nothing past the end of the table is read.
+*/
+static FUNCTARGET("avx2") inline __m256i V_GatherBytes_AVX2(const UINT8 *base, __m256i offsets)
+{
+	__m256i addr = _mm256_max_epi32(_mm256_sub_epi32(offsets, _mm256_set1_epi32(3)), _mm256_setzero_si256());
+	__m256i dwords = _mm256_i32gather_epi32((const int *)(const void *)base, addr, 1);
+	__m256i shift = _mm256_slli_epi32(_mm256_sub_epi32(offsets, addr), 3);
+	return _mm256_and_si256(_mm256_srlv_epi32(dwords, shift), _mm256_set1_epi32(0xFF));
+}
+
+/**	\brief Like V_BlendBytes_C, but gathers eight blended bytes at a time.
+*/
+FUNCTARGET("avx2") void V_BlendBytes_AVX2(UINT8 *dest, const UINT8 *fg, const UINT8 *bg, size_t count, const UINT8 *transtable)
+{
+	while (count >= 8)
+	{
+		__m256i fgs = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)fg));
+		__m256i bgs = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)bg));
+		__m256i bytes = V_GatherBytes_AVX2(transtable, _mm256_add_epi32(_mm256_slli_epi32(fgs, 8), bgs));
+		__m128i words = _mm_packs_epi32(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1));
+
+		_mm_storel_epi64((__m128i *)(void *)dest, _mm_packus_epi16(words, words));
+		fg += 8;
+		bg += 8;
+		dest += 8;
+		count -= 8;
+	}
+
+	while (count--)
+		*dest++ = transtable[(*fg++ << 8) + *bg++];
+}
+#endif
+
 //
 // Fade all the screen buffer, so that the menu is more readable,
 // especially now that we use the small hufont in the menus...
@@ -1824,27 +2507,24 @@ void V_DrawFadeScreen(UINT16 color, UINT8 strength)
 	}
 #endif
 
+	V_MarkHUDBlend();
+
 	{
 		const UINT8 *fadetable = ((color & 0xFF00) // Color is not palette index?
 		? ((UINT8 *)(((color & 0x0F00) == 0x0A00) ? fadecolormap // Do fadecolormap fade.
 		: (((color & 0x0F00) == 0x0B00) ? fadecolormap + (256 * FADECOLORMAPROWS) // Do white fadecolormap fade.
 		: colormaps)) + strength*256) // Do COLORMAP fade.
 		: ((UINT8 *)R_GetTranslucencyTable((9-strength)+1) + color*256)); // Else, do TRANSMAP** fade.
-		const UINT8 *deststop = screens[0] + vid.rowbytes * vid.height;
-		UINT8 *buf = screens[0];
 
 		// heavily simplified -- we don't need to know x or y
 		// position when we're doing a full screen fade
-		for (; buf < deststop; ++buf)
-			*buf = fadetable[*buf];
+		V_MapBytes(screens[0], screens[0], vid.rowbytes * vid.height, fadetable);
 	}
 }
 
 // Simple translucency with one color, over a set number of lines starting from the top.
 void V_DrawFadeConsBack(INT32 plines)
 {
-	UINT8 *deststop, *buf;
-
 #ifdef HWRENDER // not win32 only 19990829 by Kin
 	if (rendermode == render_opengl)
 	{
@@ -1854,11 +2534,12 @@ void V_DrawFadeConsBack(INT32 plines)
 	}
 #endif
 
+	V_MarkHUDBlend();
+
 	// heavily simplified -- we don't need to know x or y position,
 	// just the stop position
-	deststop = screens[0] + vid.rowbytes * min(plines, vid.height);
-	for (buf = screens[0]; buf < deststop; ++buf)
-		*buf = consolebgmap[*buf];
+	if (plines > 0)
+		V_MapBytes(screens[0], screens[0], vid.rowbytes * min(plines, vid.height), consolebgmap);
 }
 
 // Very similar to F_DrawFadeConsBack, except we draw from the middle(-ish) of the screen to the bottom.
@@ -1914,6 +2595,7 @@ void V_DrawPromptBack(INT32 boxheight, INT32 color)
 	}
 #endif
 
+	V_MarkHUDBlend();
 	CON_SetupBackColormapEx(color, true);
 
 	// heavily simplified -- we don't need to know x or y position,
@@ -1923,8 +2605,8 @@ void V_DrawPromptBack(INT32 boxheight, INT32 color)
 		buf += vid.rowbytes * boxheight;
 	else // 4 lines of space plus gaps between and some leeway
 		buf -= vid.rowbytes * ((boxheight * 4) + (boxheight/2)*5);
-	for (; buf < deststop; ++buf)
-		*buf = promptbgmap[*buf];
+	if (buf < deststop)
+		V_MapBytes(buf, buf, deststop - buf, promptbgmap);
 }
 
 // Gets string colormap, used for 0x80 color codes
@@ -3773,6 +4455,8 @@ void V_Init(void)
 
 void V_Recalc(void)
 {
+	V_FlushScaledPatches();
+
 	// scale 1,2,3 times in x and y the patches for the menus and overlays...
 	// calculated once and for all, used by routines in v_video.c and v_draw.c
 	vid.dupx = vid.width / BASEVIDWIDTH;
@@ -27,7 +27,7 @@
 
 extern UINT8 *screens[5];
 
-extern consvar_t cv_ticrate, cv_constextsize,
+extern consvar_t cv_ticrate, cv_constextsize, cv_hudcache,
 cv_globalgamma, cv_globalsaturation,
 cv_rhue, cv_yhue, cv_ghue, cv_chue, cv_bhue, cv_mhue,
 cv_rgamma, cv_ygamma, cv_ggamma, cv_cgamma, cv_bgamma, cv_mgamma,
@@ -39,6 +39,9 @@ void V_Init(void);
 // Recalculates the viddef (dupx, dupy, etc.) according to the current screen resolution.
 void V_Recalc(void);
 
+// Frees the patches that were pre-scaled for the screen.
+void V_FlushScaledPatches(void);
+
 // Color look-up table
 #define CLUTINDEX(r, g, b) (((r) >> 3) << 11) | (((g) >> 2) << 5) | ((b) >> 3)
 
@@ -189,6 +192,20 @@ void V_DrawFadeFill(INT32 x, INT32 y, INT32 w, INT32 h, INT32 c, UINT16 color, U
 void V_DrawFadeConsBack(INT32 plines);
 void V_DrawPromptBack(INT32 boxheight, INT32 color);
 
+// Passes over whole rows of screen bytes, for the fades and wipes.
+// dest[i] = table[src[i]], and dest[i] = transtable[(fg[i]<<8) + bg[i]].
+// Picked at startup depending on what the CPU supports; every version
+// gives exactly the same bytes as the C one.
+extern void (*V_MapBytes)(UINT8 *dest, const UINT8 *src, size_t count, const UINT8 *table);
+extern void (*V_BlendBytes)(UINT8 *dest, const UINT8 *fg, const UINT8 *bg, size_t count, const UINT8 *transtable);
+
+void V_MapBytes_C(UINT8 *dest, const UINT8 *src, size_t count, const UINT8 *table);
+void V_BlendBytes_C(UINT8 *dest, const UINT8 *fg, const UINT8 *bg, size_t count, const UINT8 *transtable);
+#ifdef SIMDSPANS
+void V_MapBytes_AVX2(UINT8 *dest, const UINT8 *src, size_t count, const UINT8 *table);
+void V_BlendBytes_AVX2(UINT8 *dest, const UINT8 *fg, const UINT8 *bg, size_t count, const UINT8 *transtable);
+#endif
+
 // draw a single character
 void V_DrawCharacter(INT32 x, INT32 y, INT32 c, boolean lowercaseallowed);
 // draw a single character, but for the chat
@@ -271,6 +288,22 @@ INT32 V_SmallThinStringWidth(const char *string, INT32 option);
 
 void V_DoPostProcessor(INT32 view, postimg_t type, INT32 param);
 
+// A HUD element that is put back from its last drawing when nothing it's drawn from changed
+typedef struct
+{
+	UINT32 key; // Hash of everything it was drawn from
+	boolean cached; // The runs can be put back instead of drawing it
+	boolean blended; // It drew translucently, so it's drawn directly
+	INT32 patches; // Patches drawn when it was recorded
+	INT32 numruns;
+	size_t size;
+	UINT8 *runs; // Offset and length of each run, then the pixels of every run
+} hudelement_t;
+
+UINT32 V_HashHUDKey(UINT32 key, const void *data, size_t length);
+void V_DrawHUDElement(hudelement_t *element, UINT32 key, void (*draw)(void *), void *userdata);
+void V_InvalidateHUDElements(void);
+
 void V_DrawPatchFill(patch_t *pat);
 
 void VID_BlitLinearScreen(const UINT8 *srcptr, UINT8 *destptr, INT32 width, INT32 height, size_t srcrowbytes,
@@ -33,6 +33,8 @@
 #include <unistd.h>
 #endif
 
+#include <sys/stat.h>
+
 #define ZWAD
 
 #ifdef ZWAD
@@ -47,6 +49,7 @@
 #include "w_wad.h"
 #include "z_zone.h"
 #include "fastcmp.h"
+#include "command.h" // lumpbench
 
 #include "filesrch.h"
 
@@ -54,6 +57,7 @@
 #include "d_netfil.h"
 #include "dehacked.h"
 #include "d_clisrv.h"
+#include "d_main.h" // srb2home
 #include "r_defs.h"
 #include "r_data.h"
 #include "r_textures.h"
@@ -62,10 +66,13 @@
 #include "i_system.h"
 #include "md5.h"
 #include "lua_script.h"
+#include "byteptr.h" // index cache
 #ifdef SCANTHINGS
 #include "p_setup.h" // P_ScanThings
 #endif
 #include "m_misc.h" // M_MapNumber
+#include "m_argv.h" // -nommap
+#include "i_threads.h"
 #include "g_game.h" // G_SetGameModified
 
 #ifdef HWRENDER
@@ -100,6 +107,17 @@ typedef struct lumpnum_cache_s
 static lumpnum_cache_t lumpnumcache[LUMPNUMCACHESIZE];
 static UINT16 lumpnumcacheindex = 0;
 
+static void W_FreeLumpInfo(lumpinfo_t *lumpinfo, UINT16 numlumps);
+static void W_FreeLumpHashes(wadfile_t *wadfile);
+static size_t W_ReadLumpData(UINT16 wad, UINT16 lump, void *dest, size_t size, size_t offset, UINT8 *mapping);
+#ifndef NOMD5
+static void W_FlushFileMD5s(void);
+#endif
+
+#ifdef HAVE_ZLIB
+static void W_FlushInflatedLumps(void);
+#endif
+
 //===========================================================================
 //                                                                    GLOBALS
 //===========================================================================
@@ -113,19 +131,24 @@ wadfile_t *wadfiles[MAX_WADFILES]; // 0 to numwadfiles-1 are valid
 // being ejected
 void W_Shutdown(void)
 {
+	W_FinishPrefetch();
+#ifdef HAVE_ZLIB
+	W_FlushInflatedLumps();
+#endif
+#ifndef NOMD5
+	W_FlushFileMD5s();
+#endif
+
 	while (numwadfiles--)
 	{
 		wadfile_t *wad = wadfiles[numwadfiles];
 
+		if (wad->mapping)
+			I_UnmapFile(wad->mapping, wad->filesize);
 		fclose(wad->handle);
 		Z_Free(wad->filename);
-		while (wad->numlumps--)
-		{
-			Z_Free(wad->lumpinfo[wad->numlumps].longname);
-			Z_Free(wad->lumpinfo[wad->numlumps].fullname);
-		}
-
-		Z_Free(wad->lumpinfo);
+		W_FreeLumpInfo(wad->lumpinfo, wad->numlumps);
+		W_FreeLumpHashes(wad);
 		Z_Free(wad);
 	}
 }
@@ -287,39 +310,485 @@ static inline void W_LoadDehackedLumps(UINT16 wadnum, boolean mainfile)
 #endif
 }
 
+// ==========================================================================
+//                                                               FILE HASHING
+// ==========================================================================
+
+// MD5s are made on worker threads. W_InitFile hashes a file while it reads
+// the file's directory, and W_InitMultipleFiles hashes all of its files at
+// once, across cores. A finished MD5 waits in the queue until W_MakeFileMD5
+// claims it. Downloads are hashed as their fragments arrive, and the result
+// is handed over the same way, through W_AddFileMD5.
+//
+// Jobs are keyed by the path the file is opened with, as W_OpenWadFile finds
+// it, and by its size and modification time, so a file that is replaced in
+// the meantime gets hashed again. A job that W_InitFile gives up on is
+// cancelled; if it is being hashed, its worker frees it when done.
+
+#ifndef NOMD5
+typedef struct md5job_s
+{
+	char filename[MAX_WADPATH];
+	UINT64 size, mtime;
+	UINT8 md5sum[16];
+	INT32 result;  // as W_MakeFileMD5, -1 while pending
+	boolean taken; // a thread is hashing the file, or has
+	boolean cancelled; // no longer queued, for the worker to free
+	struct md5job_s *next;
+} md5job_t;
+
+static md5job_t *md5jobs = NULL; // in queue order, guarded by md5_mutex
+
+#ifdef HAVE_THREADS
+static I_mutex md5_mutex;
+static I_cond  md5_cond;
+#  define Lock_md5()   I_lock_mutex(&md5_mutex)
+#  define Unlock_md5() I_unlock_mutex(md5_mutex)
+#else
+#  define Lock_md5()
+#  define Unlock_md5()
+#endif
+
+static boolean W_StatFile(const char *filename, UINT64 *size, UINT64 *mtime)
+{
+	struct stat st;
+
+	if (stat(filename, &st) < 0)
+		return false;
+
+	*size = (UINT64)st.st_size;
+	*mtime = (UINT64)st.st_mtime;
+	return true;
+}
+
+static INT32 W_HashFile(const char *filename, void *resblock)
+{
+	FILE *fhandle;
+	INT32 result = 1;
+
+	if ((fhandle = fopen(filename, "rb")) != NULL)
+	{
+		result = md5_stream(fhandle, resblock);
+		fclose(fhandle);
+	}
+
+	return result;
+}
+
+static md5job_t **W_FindFileMD5(const char *filename)
+{
+	md5job_t **link;
+
+	for (link = &md5jobs; *link; link = &(*link)->next)
+		if (!strcmp((*link)->filename, filename))
+			break;
+
+	return link;
+}
+
+#ifdef HAVE_THREADS
+// Hashes queued files until there are none left.
+static void W_HashWorker(void *userdata)
+{
+	(void)userdata;
+
+	for (;;)
+	{
+		md5job_t *job;
+		UINT8 md5sum[16];
+		INT32 result;
+
+		Lock_md5();
+		{
+			for (job = md5jobs; job && job->taken; job = job->next)
+				;
+			if (job)
+				job->taken = true;
+		}
+		Unlock_md5();
+
+		if (!job)
+			break;
+
+		result = W_HashFile(job->filename, md5sum);
+
+		Lock_md5();
+		{
+			if (job->cancelled)
+				free(job);
+			else
+			{
+				M_Memcpy(job->md5sum, md5sum, 16);
+				job->result = result;
+				I_wake_all_cond(&md5_cond);
+			}
+		}
+		Unlock_md5();
+	}
+}
+#endif
+
+/** Starts hashing files in the background, for W_MakeFileMD5.
+  * Files that can't be found as given are left alone.
+  *
+  * \param filenames Paths of the files, as they will be opened.
+  * \param count Number of files.
+  */
+static void W_QueueFileMD5s(const char **filenames, size_t count)
+{
+#ifdef HAVE_THREADS
+	INT32 numthreads = 0;
+	size_t i;
+
+	Lock_md5();
+	{
+		for (i = 0; i < count; i++)
+		{
+			md5job_t **link = W_FindFileMD5(filenames[i]);
+			md5job_t *job;
+			UINT64 size, mtime;
+
+			if (*link || !W_StatFile(filenames[i], &size, &mtime))
+				continue;
+
+			if ((job = malloc(sizeof (*job))) == NULL)
+				break;
+
+			strlcpy(job->filename, filenames[i], sizeof job->filename);
+			job->size = size;
+			job->mtime = mtime;
+			job->result = -1;
+			job->taken = false;
+			job->cancelled = false;
+			job->next = NULL;
+			*link = job;
+			numthreads++;
+		}
+	}
+	Unlock_md5();
+
+	numthreads = min(numthreads, I_cpu_count());
+	while (numthreads-- > 0)
+		I_spawn_thread("hash-files", W_HashWorker, NULL);
+#else
+	(void)filenames;
+	(void)count;
+#endif
+}
+
+/** Records the MD5 of a file that was hashed elsewhere,
+  * so that W_InitFile doesn't have to hash it again.
+  *
+  * \param filename Path of the file, as it will be opened.
+  * \param md5sum MD5 of the file.
+  */
+void W_AddFileMD5(const char *filename, const UINT8 *md5sum)
+{
+	md5job_t *job;
+	UINT64 size, mtime;
+
+	if (!W_StatFile(filename, &size, &mtime))
+		return;
+
+	Lock_md5();
+	{
+		job = *W_FindFileMD5(filename);
+
+		if (job && job->taken && job->result == -1)
+			; // being hashed already
+		else
+		{
+			if (!job && (job = malloc(sizeof (*job))) != NULL)
+			{
+				strlcpy(job->filename, filename, sizeof job->filename);
+				job->next = md5jobs;
+				md5jobs = job;
+			}
+
+			if (job)
+			{
+				job->size = size;
+				job->mtime = mtime;
+				M_Memcpy(job->md5sum, md5sum, 16);
+				job->result = 0;
+				job->taken = true;
+				job->cancelled = false;
+			}
+		}
+	}
+	Unlock_md5();
+}
+
+// Drops the job of a file that won't be loaded.
+static void W_CancelFileMD5(const char *filename)
+{
+	Lock_md5();
+	{
+		md5job_t **link = W_FindFileMD5(filename);
+		md5job_t *job = *link;
+
+		if (job)
+		{
+			*link = job->next;
+
+			if (job->taken && job->result == -1)
+				job->cancelled = true; // W_HashWorker frees it
+			else
+				free(job);
+		}
+	}
+	Unlock_md5();
+}
+
+// Waits for the files being hashed, and drops every job.
+static void W_FlushFileMD5s(void)
+{
+	Lock_md5();
+	{
+		md5job_t *job;
+
+		for (job = md5jobs; job; job = job->next)
+		{
+#ifdef HAVE_THREADS
+			while (job->taken && job->result == -1)
+				I_hold_cond(&md5_cond, md5_mutex);
+#endif
+		}
+
+		while ((job = md5jobs) != NULL)
+		{
+			md5jobs = job->next;
+			free(job);
+		}
+	}
+	Unlock_md5();
+}
+#else
+void W_AddFileMD5(const char *filename, const UINT8 *md5sum)
+{
+	(void)filename;
+	(void)md5sum;
+}
+#endif
+
 /** Compute MD5 message digest for bytes read from STREAM of this filname.
   *
   * The resulting message digest number will be written into the 16 bytes
-  * beginning at RESBLOCK.
+  * beginning at RESBLOCK. If the file was queued with W_QueueFileMD5s or
+  * W_AddFileMD5, that result is used instead.
   *
   * \param filename path of file
   * \param resblock resulting MD5 checksum
   * \return 0 if MD5 checksum was made, and is at resblock, 1 if error was found
   */
-static inline INT32 W_MakeFileMD5(const char *filename, void *resblock)
+static INT32 W_MakeFileMD5(const char *filename, void *resblock)
 {
 #ifdef NOMD5
 	(void)filename;
 	memset(resblock, 0x00, 16);
+	return 1;
 #else
-	FILE *fhandle;
+	tic_t t = I_GetTime();
+	md5job_t *job;
+	UINT64 size, mtime;
+	INT32 result = -1;
 
-	if ((fhandle = fopen(filename, "rb")) != NULL)
+	if (!W_StatFile(filename, &size, &mtime))
+		return 1;
+
+	CONS_Debug(DBG_SETUP, "Making MD5 for %s\n",filename);
+
+	Lock_md5();
 	{
-		tic_t t = I_GetTime();
-		CONS_Debug(DBG_SETUP, "Making MD5 for %s\n",filename);
-		if (md5_stream(fhandle, resblock) == 1)
+		job = *W_FindFileMD5(filename);
+
+		if (job && job->taken)
+		{
+#ifdef HAVE_THREADS
+			while (job->result == -1)
+				I_hold_cond(&md5_cond, md5_mutex);
+#endif
+			if (job->size == size && job->mtime == mtime)
+			{
+				M_Memcpy(resblock, job->md5sum, 16);
+				result = job->result;
+			}
+		}
+
+		// Claimed, or not taken by any worker yet
+		if (job)
 		{
-			fclose(fhandle);
-			return 1;
+			md5job_t **link = W_FindFileMD5(filename);
+			*link = job->next;
+			free(job);
 		}
+	}
+	Unlock_md5();
+
+	if (result == -1)
+		result = W_HashFile(filename, resblock);
+
+	if (result == 0)
 		CONS_Debug(DBG_SETUP, "MD5 calc for %s took %f seconds\n",
 			filename, (float)(I_GetTime() - t)/NEWTICRATE);
-		fclose(fhandle);
-		return 0;
-	}
+	return result;
 #endif
-	return 1;
+}
+
+// FNV-1a over a lump name.
+// Case insensitive hashes fold the name to upper case.
+static UINT32 W_HashLumpName(const char *name, boolean nocase)
+{
+	UINT32 hash = 2166136261u;
+
+	for (; *name; name++)
+	{
+		hash ^= (UINT8)(nocase ? toupper(*name) : *name);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static UINT32 W_HashLump(const lumpinfo_t *lump, lumphashtype_t type)
+{
+	switch (type)
+	{
+		case LUMPHASH_NAME:
+			return W_HashLumpName(lump->name, false);
+		case LUMPHASH_LONGNAME:
+			return W_HashLumpName(lump->longname, false);
+		default:
+			return 0;
+	}
+}
+
+// Compares the start of a full name with a name, case insensitively.
+// With len past the end of both, it orders full names.
+static INT32 W_CompareFullName(const char *fullname, const char *name, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		INT32 a = toupper((UINT8)fullname[i]), b = toupper((UINT8)name[i]);
+		if (a != b)
+			return a - b;
+		if (!a)
+			break;
+	}
+
+	return 0;
+}
+
+// Merge sorts lump numbers by full name.
+// Equal names keep their lump order, so the first of them comes first.
+static void W_SortFullNames(UINT16 *order, UINT16 *temp, size_t n, const lumpinfo_t *lumpinfo)
+{
+	size_t width, i;
+
+	for (width = 1; width < n; width *= 2)
+	{
+		for (i = 0; i < n; i += 2*width)
+		{
+			size_t a = i, mid = min(i + width, n), b = mid, end = min(i + 2*width, n), k = i;
+
+			while (a < mid && b < end)
+			{
+				if (W_CompareFullName(lumpinfo[order[b]].fullname, lumpinfo[order[a]].fullname, SIZE_MAX) < 0)
+					temp[k++] = order[b++];
+				else
+					temp[k++] = order[a++];
+			}
+			while (a < mid)
+				temp[k++] = order[a++];
+			while (b < end)
+				temp[k++] = order[b++];
+		}
+
+		M_Memcpy(order, temp, n * sizeof (*order));
+	}
+}
+
+/** Builds the lump name indexes of a resource file.
+  *
+  * \param wadfile The file, with its lumpinfo already read.
+  */
+static void W_MakeLumpHashes(wadfile_t *wadfile)
+{
+	UINT32 numbuckets = 16;
+	lumphashtype_t type;
+	INT32 i;
+
+	while (numbuckets < wadfile->numlumps)
+		numbuckets <<= 1;
+
+	for (type = 0; type < NUMLUMPHASHES; type++)
+	{
+		lumphash_t *hash = &wadfile->lumphash[type];
+
+		hash->mask = numbuckets - 1;
+		hash->first = Z_Malloc(numbuckets * sizeof (*hash->first), PU_STATIC, NULL);
+		hash->next = Z_Malloc(max(wadfile->numlumps, 1) * sizeof (*hash->next), PU_STATIC, NULL);
+		memset(hash->first, 0xFF, numbuckets * sizeof (*hash->first)); // LUMPHASH_END
+
+		// Insert backwards, so that every chain is in ascending lump order
+		for (i = wadfile->numlumps - 1; i >= 0; i--)
+		{
+			UINT32 bucket = W_HashLump(&wadfile->lumpinfo[i], type) & hash->mask;
+			hash->next[i] = hash->first[bucket];
+			hash->first[bucket] = (UINT32)i;
+		}
+	}
+
+	// Full names are looked up by prefix, which a hash can't do
+	{
+		UINT16 *temp = Z_Malloc(max(wadfile->numlumps, 1) * sizeof (*temp), PU_STATIC, NULL);
+
+		wadfile->fullnameorder = Z_Malloc(max(wadfile->numlumps, 1) * sizeof (*wadfile->fullnameorder), PU_STATIC, NULL);
+		for (i = 0; i < wadfile->numlumps; i++)
+			wadfile->fullnameorder[i] = (UINT16)i;
+		W_SortFullNames(wadfile->fullnameorder, temp, wadfile->numlumps, wadfile->lumpinfo);
+
+		Z_Free(temp);
+	}
+}
+
+/** Frees the lump name indexes of a resource file.
+  *
+  * \param wadfile The file.
+  */
+static void W_FreeLumpHashes(wadfile_t *wadfile)
+{
+	lumphashtype_t type;
+
+	for (type = 0; type < NUMLUMPHASHES; type++)
+	{
+		Z_Free(wadfile->lumphash[type].first);
+		Z_Free(wadfile->lumphash[type].next);
+	}
+	Z_Free(wadfile->fullnameorder);
+}
+
+/** Maps a resource file in memory, so that lumps can be read without stdio.
+  * Files with lumps past their end are left to stdio, which reports the error.
+  *
+  * \param wadfile The file, with its lumpinfo already read.
+  */
+static void W_MapFile(wadfile_t *wadfile)
+{
+	UINT16 i;
+
+	wadfile->mapping = NULL;
+
+	if (M_CheckParm("-nommap"))
+		return;
+
+	for (i = 0; i < wadfile->numlumps; i++)
+		if (wadfile->lumpinfo[i].position + wadfile->lumpinfo[i].disksize > wadfile->filesize)
+			return;
+
+	wadfile->mapping = I_MapFile(wadfile->handle, wadfile->filesize);
 }
 
 // Invalidates the cache of lump numbers. Call this whenever a wad is added.
@@ -545,6 +1014,49 @@ typedef struct zlentry_s
 #pragma pack()
 #endif
 
+/** Fills in the short and long names of a PKZip lump from its full name.
+ */
+static void ResSetLumpNamesZip (lumpinfo_t* lump_p)
+{
+	char* trimname;
+	char* dotpos;
+
+	// Strip away file address and extension for the 8char name.
+	if ((trimname = strrchr(lump_p->fullname, '/')) != 0)
+		trimname++;
+	else
+		trimname = lump_p->fullname; // Care taken for root files.
+
+	if ((dotpos = strrchr(trimname, '.')) == 0)
+		dotpos = lump_p->fullname + strlen(lump_p->fullname); // Watch for files without extension.
+
+	memset(lump_p->name, '\0', 9); // Making sure they're initialized to 0. Is it necessary?
+	strncpy(lump_p->name, trimname, min(8, dotpos - trimname));
+
+	lump_p->longname = Z_Calloc(dotpos - trimname + 1, PU_STATIC, NULL);
+	strlcpy(lump_p->longname, trimname, dotpos - trimname + 1);
+}
+
+/** Translates a PKZip compression method number.
+ */
+static compmethod ResGetCompressionZip (UINT16 method, const char* fullname)
+{
+	switch(method)
+	{
+	case 0:
+		return CM_NOCOMPRESSION;
+#ifdef HAVE_ZLIB
+	case 8:
+		return CM_DEFLATE;
+#endif
+	case 14:
+		return CM_LZF;
+	default:
+		CONS_Alert(CONS_WARNING, "%s: Unsupported compression method\n", fullname);
+		return CM_UNSUPPORTED;
+	}
+}
+
 /** Create a lumpinfo_t array for a PKZip file.
  */
 static lumpinfo_t* ResGetLumpsZip (FILE* handle, UINT16* nlmp)
@@ -584,8 +1096,6 @@ static lumpinfo_t* ResGetLumpsZip (FILE* handle, UINT16* nlmp)
 	for (i = 0; i < numlumps; i++, lump_p++)
 	{
 		char* fullname;
-		char* trimname;
-		char* dotpos;
 
 		if (fread(&zentry, 1, sizeof(zentry_t), handle) < sizeof(zentry_t))
 		{
@@ -613,47 +1123,16 @@ static lumpinfo_t* ResGetLumpsZip (FILE* handle, UINT16* nlmp)
 			return NULL;
 		}
 
-		// Strip away file address and extension for the 8char name.
-		if ((trimname = strrchr(fullname, '/')) != 0)
-			trimname++;
-		else
-			trimname = fullname; // Care taken for root files.
-
-		if ((dotpos = strrchr(trimname, '.')) == 0)
-			dotpos = fullname + strlen(fullname); // Watch for files without extension.
-
-		memset(lump_p->name, '\0', 9); // Making sure they're initialized to 0. Is it necessary?
-		strncpy(lump_p->name, trimname, min(8, dotpos - trimname));
-
-		lump_p->longname = Z_Calloc(dotpos - trimname + 1, PU_STATIC, NULL);
-		strlcpy(lump_p->longname, trimname, dotpos - trimname + 1);
-
 		lump_p->fullname = Z_Calloc(zentry.namelen + 1, PU_STATIC, NULL);
 		strncpy(lump_p->fullname, fullname, zentry.namelen);
 
 		free(fullname);
 
-		switch(zentry.compression)
-		{
-		case 0:
-			lump_p->compression = CM_NOCOMPRESSION;
-			break;
-#ifdef HAVE_ZLIB
-		case 8:
-			lump_p->compression = CM_DEFLATE;
-			break;
-#endif
-		case 14:
-			lump_p->compression = CM_LZF;
-			break;
-		default:
-			CONS_Alert(CONS_WARNING, "%s: Unsupported compression method\n", fullname);
-			lump_p->compression = CM_UNSUPPORTED;
-			break;
-		}
-
-		// skip and ignore comments/extra fields
-		if (fseek(handle, zentry.xtralen + zentry.commlen, SEEK_CUR) != 0)
+		ResSetLumpNamesZip(lump_p);
+		lump_p->compression = ResGetCompressionZip(zentry.compression, lump_p->fullname);
+
+		// skip and ignore comments/extra fields
+		if (fseek(handle, zentry.xtralen + zentry.commlen, SEEK_CUR) != 0)
 		{
 			CONS_Alert(CONS_ERROR, "Central directory is corrupt\n");
 			Z_Free(lumpinfo);
@@ -679,8 +1158,427 @@ static lumpinfo_t* ResGetLumpsZip (FILE* handle, UINT16* nlmp)
 	return lumpinfo;
 }
 
+static void W_FreeLumpInfo (lumpinfo_t* lumpinfo, UINT16 numlumps)
+{
+	while (numlumps--)
+	{
+		Z_Free(lumpinfo[numlumps].longname);
+		Z_Free(lumpinfo[numlumps].fullname);
+	}
+
+	Z_Free(lumpinfo);
+}
+
+// =========================================================================
+//                                                          PK3 INDEX CACHE
+// =========================================================================
+
+// Reading the central directory of a PK3 seeks to the local header of every
+// lump, and its MD5 reads the whole file. The result of both is kept in an
+// index under srb2home, keyed by the path, size and modification time of the
+// PK3, so that the next startup can skip them.
+//
+// -noindexcache ignores the indexes, -rebuildindexcache rewrites the index of
+// every PK3 that gets loaded, and -verifyindexcache still does the work and
+// replaces indexes that turn out to be stale. The latter is meant for
+// dedicated servers, which hand their MD5s to every client that joins.
+
+#define INDEXCACHE_MAGIC "SRB2PKX" // followed by INDEXCACHE_VERSION
+#define INDEXCACHE_VERSION 2
+
+// What the build that wrote an index supports. The compression of its lumps
+// is only meaningful to a build that can inflate the same methods, and its
+// MD5 is all zeros if the build couldn't make one.
+#define INDEXCACHE_DEFLATE 1
+#define INDEXCACHE_MD5 2
+
+#ifdef HAVE_ZLIB
+#define INDEXCACHE_DEFLATEFLAG INDEXCACHE_DEFLATE
+#else
+#define INDEXCACHE_DEFLATEFLAG 0
+#endif
+
+#ifdef NOMD5
+#define INDEXCACHE_MD5FLAG 0
+#else
+#define INDEXCACHE_MD5FLAG INDEXCACHE_MD5
+#endif
+
+#define INDEXCACHE_FEATURES (INDEXCACHE_DEFLATEFLAG|INDEXCACHE_MD5FLAG)
+
+// Bytes of the index header before the path of the PK3:
+// magic and version, INDEXCACHE_FEATURES, size, mtime, path length
+#define INDEXCACHE_HEADERSIZE (8 + 1 + 4 + 4 + 4 + 2)
+
+// Bytes of an index entry besides its name:
+// position, disksize, size, compression, name length
+#define INDEXCACHE_LUMPSIZE (4 + 4 + 4 + 1 + 2)
+
+typedef enum
+{
+	INDEXCACHE_OFF,
+	INDEXCACHE_ON,
+	INDEXCACHE_REBUILD,
+	INDEXCACHE_VERIFY
+} indexcachemode_t;
+
+static indexcachemode_t W_IndexCacheMode(void)
+{
+	if (M_CheckParm("-noindexcache"))
+		return INDEXCACHE_OFF;
+	if (M_CheckParm("-rebuildindexcache"))
+		return INDEXCACHE_REBUILD;
+	if (M_CheckParm("-verifyindexcache"))
+		return INDEXCACHE_VERIFY;
+	return INDEXCACHE_ON;
+}
+
+static void W_IndexCachePath(const char *filename, char *path, size_t len)
+{
+	snprintf(path, len, "%s" PATHSEP CACHE_DIR PATHSEP "%08x.idx",
+		srb2home, W_HashLumpName(filename, false));
+}
+
+/** Checks that an index was made from the PK3 as it is now.
+  *
+  * \param buf Start of the index.
+  * \param len Bytes available at buf.
+  * \param filename Path of the PK3, as it was opened.
+  * \param st Status of the PK3.
+  * \return Size of the header, or 0 if the index doesn't match.
+  */
+static size_t W_CheckIndexHeader(UINT8 *buf, size_t len, const char *filename, const struct stat *st)
+{
+	UINT8 *p = buf;
+	UINT64 mtime = (UINT64)st->st_mtime;
+	size_t pathlen;
+
+	if (len < INDEXCACHE_HEADERSIZE
+	|| memcmp(p, INDEXCACHE_MAGIC, 7) || p[7] != INDEXCACHE_VERSION)
+		return 0;
+	p += 8;
+
+	if (READUINT8(p) != INDEXCACHE_FEATURES
+	|| READUINT32(p) != (UINT32)st->st_size
+	|| READUINT32(p) != (UINT32)(mtime & UINT32_MAX)
+	|| READUINT32(p) != (UINT32)(mtime >> 32))
+		return 0;
+
+	pathlen = READUINT16(p);
+	if (len < INDEXCACHE_HEADERSIZE + pathlen
+	|| pathlen != strlen(filename) || memcmp(p, filename, pathlen))
+		return 0;
+
+	return INDEXCACHE_HEADERSIZE + pathlen;
+}
+
+/** Checks whether a PK3 will be loaded from the index cache,
+  * without reading the whole index.
+  *
+  * \param filename Path of the PK3, as it will be opened.
+  * \return true if its index is current.
+  */
+static boolean W_HasFileIndex(const char *filename)
+{
+	char path[MAX_WADPATH];
+	UINT8 buf[INDEXCACHE_HEADERSIZE + MAX_WADPATH];
+	struct stat st;
+	FILE *f;
+	size_t len;
+
+	if (W_IndexCacheMode() != INDEXCACHE_ON || stat(filename, &st) < 0)
+		return false;
+
+	W_IndexCachePath(filename, path, sizeof path);
+	if ((f = fopen(path, "rb")) == NULL)
+		return false;
+
+	len = fread(buf, 1, sizeof buf, f);
+	fclose(f);
+
+	return (W_CheckIndexHeader(buf, len, filename, &st) != 0);
+}
+
+/** Reads the index of a PK3 from the cache.
+  *
+  * \param filename Path of the PK3, as it was opened.
+  * \param md5sum Receives the MD5 of the PK3.
+  * \param nlmp Receives the number of lumps.
+  * \return The lumpinfo of the PK3, or NULL if it has no usable index.
+  */
+static lumpinfo_t *W_ReadFileIndex(const char *filename, UINT8 *md5sum, UINT16 *nlmp)
+{
+	char path[MAX_WADPATH];
+	struct stat st;
+	FILE *f;
+	long len;
+	size_t headersize;
+	UINT8 *buf, *p, *end;
+	UINT16 numlumps, i;
+	lumpinfo_t *lumpinfo = NULL;
+
+	if (stat(filename, &st) < 0)
+		return NULL;
+
+	W_IndexCachePath(filename, path, sizeof path);
+	if ((f = fopen(path, "rb")) == NULL)
+		return NULL;
+
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	if (len <= 0 || (buf = malloc(len)) == NULL)
+	{
+		fclose(f);
+		return NULL;
+	}
+
+	if (fread(buf, 1, len, f) < (size_t)len)
+	{
+		fclose(f);
+		free(buf);
+		return NULL;
+	}
+	fclose(f);
+
+	// Header, then MD5 and lump count
+	headersize = W_CheckIndexHeader(buf, len, filename, &st);
+	if (!headersize || len - headersize < 16 + 2)
+	{
+		free(buf);
+		return NULL;
+	}
+
+	p = buf + headersize;
+	end = buf + len;
+
+	M_Memcpy(md5sum, p, 16);
+	p += 16;
+	numlumps = READUINT16(p);
+
+	lumpinfo = Z_Calloc(max(numlumps, 1) * sizeof (*lumpinfo), PU_STATIC, NULL);
+
+	for (i = 0; i < numlumps; i++)
+	{
+		lumpinfo_t *lump_p = &lumpinfo[i];
+		UINT16 namelen;
+
+		if (end - p < INDEXCACHE_LUMPSIZE)
+			break;
+
+		lump_p->position = READUINT32(p);
+		lump_p->disksize = READUINT32(p);
+		lump_p->size = READUINT32(p);
+		lump_p->compression = READUINT8(p);
+		namelen = READUINT16(p);
+
+		if (end - p < namelen || lump_p->compression > CM_UNSUPPORTED)
+			break;
+
+		lump_p->fullname = Z_Calloc(namelen + 1, PU_STATIC, NULL);
+		M_Memcpy(lump_p->fullname, p, namelen);
+		p += namelen;
+
+		ResSetLumpNamesZip(lump_p);
+	}
+
+	free(buf);
+
+	if (i < numlumps)
+	{
+		// Truncated or damaged; the entries not read yet are still zeroed
+		CONS_Debug(DBG_SETUP, "Ignoring damaged index %s\n", path);
+		W_FreeLumpInfo(lumpinfo, numlumps);
+		return NULL;
+	}
+
+	*nlmp = numlumps;
+	return lumpinfo;
+}
+
+/** Writes the index of a PK3 to the cache.
+  *
+  * \param filename Path of the PK3, as it was opened.
+  * \param md5sum MD5 of the PK3.
+  * \param lumpinfo Lumps, as read from the central directory.
+  * \param numlumps Number of lumps.
+  */
+static void W_WriteFileIndex(const char *filename, const UINT8 *md5sum, const lumpinfo_t *lumpinfo, UINT16 numlumps)
+{
+	char path[MAX_WADPATH];
+	char temppath[MAX_WADPATH + 4];
+	struct stat st;
+	FILE *f;
+	size_t len, written;
+	UINT8 *buf, *p;
+	UINT64 mtime;
+	UINT16 pathlen = (UINT16)strlen(filename);
+	UINT16 i;
+
+	if (stat(filename, &st) < 0)
+		return;
+
+	len = INDEXCACHE_HEADERSIZE + pathlen + 16 + 2;
+	for (i = 0; i < numlumps; i++)
+		len += INDEXCACHE_LUMPSIZE + strlen(lumpinfo[i].fullname);
+
+	if ((buf = malloc(len)) == NULL)
+		return;
+
+	p = buf;
+	mtime = (UINT64)st.st_mtime;
+
+	M_Memcpy(p, INDEXCACHE_MAGIC, 7);
+	p[7] = INDEXCACHE_VERSION;
+	p += 8;
+	WRITEUINT8(p, INDEXCACHE_FEATURES);
+	WRITEUINT32(p, (UINT32)st.st_size);
+	WRITEUINT32(p, (UINT32)(mtime & UINT32_MAX));
+	WRITEUINT32(p, (UINT32)(mtime >> 32));
+	WRITEUINT16(p, pathlen);
+	M_Memcpy(p, filename, pathlen);
+	p += pathlen;
+#ifdef NOMD5
+	(void)md5sum;
+	memset(p, 0x00, 16);
+#else
+	M_Memcpy(p, md5sum, 16);
+#endif
+	p += 16;
+	WRITEUINT16(p, numlumps);
+
+	for (i = 0; i < numlumps; i++)
+	{
+		UINT16 namelen = (UINT16)strlen(lumpinfo[i].fullname);
+
+		WRITEUINT32(p, (UINT32)lumpinfo[i].position);
+		WRITEUINT32(p, (UINT32)lumpinfo[i].disksize);
+		WRITEUINT32(p, (UINT32)lumpinfo[i].size);
+		WRITEUINT8(p, (UINT8)lumpinfo[i].compression);
+		WRITEUINT16(p, namelen);
+		M_Memcpy(p, lumpinfo[i].fullname, namelen);
+		p += namelen;
+	}
+
+	// Write to a temporary file first, so a crash can't leave half an index
+	I_mkdir(va("%s" PATHSEP CACHE_DIR, srb2home), 0755);
+	W_IndexCachePath(filename, path, sizeof path);
+	snprintf(temppath, sizeof temppath, "%s.tmp", path);
+
+	if ((f = fopen(temppath, "wb")) == NULL)
+	{
+		free(buf);
+		return;
+	}
+
+	written = fwrite(buf, 1, len, f);
+	free(buf);
+
+	if (fclose(f) != 0 || written < len)
+	{
+		remove(temppath);
+		return;
+	}
+
+	remove(path);
+	if (rename(temppath, path) != 0)
+		remove(temppath);
+	else
+		CONS_Debug(DBG_SETUP, "Wrote index %s for %s\n", path, filename);
+}
+
+static boolean W_CompareLumpInfo(const lumpinfo_t *a, const lumpinfo_t *b, UINT16 numlumps)
+{
+	UINT16 i;
+
+	for (i = 0; i < numlumps; i++, a++, b++)
+	{
+		if (a->position != b->position || a->disksize != b->disksize
+		|| a->size != b->size || a->compression != b->compression
+		|| strcmp(a->fullname, b->fullname))
+			return false;
+	}
+
+	return true;
+}
+
+/** Gets the lumps and MD5 of a PK3 from the index cache.
+  * In verification mode, they are also read from the file itself,
+  * and a stale index is replaced.
+  *
+  * \param handle The open PK3.
+  * \param filename Path of the PK3, as it was opened.
+  * \param md5sum Receives the MD5 of the PK3.
+  * \param nlmp Receives the number of lumps.
+  * \return The lumpinfo of the PK3, or NULL if it has to be read from the file.
+  */
+static lumpinfo_t *W_GetIndexedLumpsZip(FILE *handle, const char *filename, UINT8 *md5sum, UINT16 *nlmp)
+{
+	indexcachemode_t mode = W_IndexCacheMode();
+	lumpinfo_t *lumpinfo, *verify;
+	UINT16 numlumps = 0, numverify = 0;
+	UINT8 verifymd5[16];
+
+	if (mode == INDEXCACHE_OFF || mode == INDEXCACHE_REBUILD)
+		return NULL;
+
+	if ((lumpinfo = W_ReadFileIndex(filename, md5sum, &numlumps)) == NULL)
+		return NULL;
+
+	if (mode != INDEXCACHE_VERIFY)
+	{
+		CONS_Debug(DBG_SETUP, "Using cached index for %s\n", filename);
+		*nlmp = numlumps;
+		return lumpinfo;
+	}
+
+#ifndef NOMD5
+	W_QueueFileMD5s(&filename, 1);
+#endif
+	if ((verify = ResGetLumpsZip(handle, &numverify)) == NULL)
+	{
+		W_FreeLumpInfo(lumpinfo, numlumps);
+		return NULL;
+	}
+
+#ifdef NOMD5
+	// There is no MD5 to check, only the lumps
+	memset(verifymd5, 0x00, 16);
+	if (numverify != numlumps
+#else
+	W_MakeFileMD5(filename, verifymd5);
+	if (numverify != numlumps || memcmp(verifymd5, md5sum, 16)
+#endif
+	|| !W_CompareLumpInfo(lumpinfo, verify, numlumps))
+	{
+		CONS_Alert(CONS_WARNING, M_GetText("Cached index of %s is stale, rebuilding it\n"), filename);
+		M_Memcpy(md5sum, verifymd5, 16);
+		W_WriteFileIndex(filename, md5sum, verify, numverify);
+		W_FreeLumpInfo(lumpinfo, numlumps);
+		*nlmp = numverify;
+		return verify;
+	}
+
+	W_FreeLumpInfo(verify, numverify);
+	*nlmp = numlumps;
+	return lumpinfo;
+}
+
+/** Writes the index of a PK3 that was just read, unless the cache is disabled.
+  */
+static void W_CacheIndexZip(const char *filename, const UINT8 *md5sum, const lumpinfo_t *lumpinfo, UINT16 numlumps)
+{
+	if (W_IndexCacheMode() != INDEXCACHE_OFF)
+		W_WriteFileIndex(filename, md5sum, lumpinfo, numlumps);
+}
+
 static UINT16 W_InitFileError (const char *filename, boolean exitworthy)
 {
+#ifndef NOMD5
+	W_CancelFileMD5(filename);
+#endif
+
 	if (exitworthy)
 	{
 #ifdef _DEBUG
@@ -718,6 +1616,7 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	size_t packetsize;
 	UINT8 md5sum[16];
 	int important;
+	boolean indexed;
 
 	if (!(refreshdirmenu & REFRESHDIR_ADDFILE))
 		refreshdirmenu = REFRESHDIR_NORMAL|REFRESHDIR_ADDFILE; // clean out cons_alerts that happened earlier
@@ -752,6 +1651,9 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	if (important == -1)
 	{
 		fclose(handle);
+#ifndef NOMD5
+		W_CancelFileMD5(filename);
+#endif
 		return INT16_MAX;
 	}
 
@@ -774,29 +1676,18 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 		packetsizetally = packetsize;
 	}
 
-#ifndef NOMD5
-	//
-	// w-waiiiit!
-	// Let's not add a wad file if the MD5 matches
-	// an MD5 of an already added WAD file!
-	//
-	W_MakeFileMD5(filename, md5sum);
+	// PK3s may have their lumps and MD5 in the index cache
+	if ((type = ResourceFileDetect(filename)) == RET_PK3)
+		lumpinfo = W_GetIndexedLumpsZip(handle, filename, md5sum, &numlumps);
+	indexed = (lumpinfo != NULL);
 
-	for (i = 0; i < numwadfiles; i++)
-	{
-		if (!memcmp(wadfiles[i]->md5sum, md5sum, 16))
-		{
-			CONS_Alert(CONS_ERROR, M_GetText("%s is already loaded\n"), filename);
-			if (important)
-				packetsizetally -= nameonlylength(filename) + 22;
-			if (handle)
-				fclose(handle);
-			return W_InitFileError(filename, false);
-		}
-	}
+#ifndef NOMD5
+	// Otherwise, hash the file while its directory is read
+	if (!indexed)
+		W_QueueFileMD5s(&filename, 1);
 #endif
 
-	switch(type = ResourceFileDetect(filename))
+	switch(type)
 	{
 	case RET_SOC:
 		lumpinfo = ResGetLumpsStandalone(handle, &numlumps, "OBJCTCFG");
@@ -805,7 +1696,8 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 		lumpinfo = ResGetLumpsStandalone(handle, &numlumps, "LUA_INIT");
 		break;
 	case RET_PK3:
-		lumpinfo = ResGetLumpsZip(handle, &numlumps);
+		if (!indexed)
+			lumpinfo = ResGetLumpsZip(handle, &numlumps);
 		break;
 	case RET_WAD:
 		lumpinfo = ResGetLumpsWad(handle, &numlumps, filename);
@@ -820,6 +1712,34 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 		return W_InitFileError(filename, startup);
 	}
 
+	if (!indexed)
+	{
+		W_MakeFileMD5(filename, md5sum);
+		if (type == RET_PK3)
+			W_CacheIndexZip(filename, md5sum, lumpinfo, numlumps);
+	}
+
+#ifndef NOMD5
+	//
+	// w-waiiiit!
+	// Let's not add a wad file if the MD5 matches
+	// an MD5 of an already added WAD file!
+	//
+	for (i = 0; i < numwadfiles; i++)
+	{
+		if (!memcmp(wadfiles[i]->md5sum, md5sum, 16))
+		{
+			CONS_Alert(CONS_ERROR, M_GetText("%s is already loaded\n"), filename);
+			if (important)
+				packetsizetally -= nameonlylength(filename) + 22;
+			W_FreeLumpInfo(lumpinfo, numlumps);
+			if (handle)
+				fclose(handle);
+			return W_InitFileError(filename, false);
+		}
+	}
+#endif
+
 	if (important && !mainfile)
 	{
 		//G_SetGameModified(true);
@@ -835,10 +1755,12 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	wadfile->handle = handle;
 	wadfile->numlumps = (UINT16)numlumps;
 	wadfile->lumpinfo = lumpinfo;
+	W_MakeLumpHashes(wadfile);
 	wadfile->important = important;
 	fseek(handle, 0, SEEK_END);
 	wadfile->filesize = (unsigned)ftell(handle);
 	wadfile->type = type;
+	W_MapFile(wadfile);
 
 	// already generated, just copy it over
 	M_Memcpy(&wadfile->md5sum, &md5sum, 16);
@@ -900,12 +1822,46 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
   */
 void W_InitMultipleFiles(char **filenames)
 {
+#ifndef NOMD5
+	{
+		// Hash all of the files across cores, while they load one by one.
+		// W_InitFile asks for them by the path W_OpenWadFile finds.
+		static char paths[MAX_WADFILES][MAX_WADPATH];
+		const char *tohash[MAX_WADFILES];
+		size_t count = 0;
+		char **name;
+
+		for (name = filenames; *name && count < MAX_WADFILES; name++)
+		{
+			const char *path = *name;
+			FILE *handle = W_OpenWadFile(&path, false);
+
+			if (handle == NULL)
+				continue;
+			fclose(handle);
+
+			if (!(ResourceFileDetect(path) == RET_PK3 && W_HasFileIndex(path)))
+			{
+				strlcpy(paths[count], path, MAX_WADPATH);
+				tohash[count] = paths[count];
+				count++;
+			}
+		}
+
+		W_QueueFileMD5s(tohash, count);
+	}
+#endif
+
 	// will be realloced as lumps are added
 	for (; *filenames; filenames++)
 	{
 		//CONS_Debug(DBG_SETUP, "Loading %s\n", *filenames);
 		W_InitFile(*filenames, numwadfiles < mainwads, true);
 	}
+
+#ifndef NOMD5
+	W_FlushFileMD5s(); // drop the files that failed to load
+#endif
 }
 
 /** Make sure a lump number is valid.
@@ -945,9 +1901,20 @@ const char *W_CheckNameForNum(lumpnum_t lumpnum)
 //
 // 'startlump' is the lump number to start the search
 //
+static UINT16 W_FindLumpName(const wadfile_t *wadfile, const char *uname, UINT16 startlump)
+{
+	const lumphash_t *hash = &wadfile->lumphash[LUMPHASH_NAME];
+	UINT32 i;
+
+	for (i = hash->first[W_HashLumpName(uname, false) & hash->mask]; i != LUMPHASH_END; i = hash->next[i])
+		if (i >= startlump && !strncmp(wadfile->lumpinfo[i].name, uname, 8))
+			return (UINT16)i;
+
+	return INT16_MAX;
+}
+
 UINT16 W_CheckNumForNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 {
-	UINT16 i;
 	static char uname[8 + 1];
 
 	if (!TestValidLump(wad,0))
@@ -962,12 +1929,7 @@ UINT16 W_CheckNumForNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 	//                       resources with the same name
 	//
 	if (startlump < wadfiles[wad]->numlumps)
-	{
-		lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
-		for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
-			if (!strncmp(lump_p->name, uname, sizeof(uname) - 1))
-				return i;
-	}
+		return W_FindLumpName(wadfiles[wad], uname, startlump);
 
 	// not found.
 	return INT16_MAX;
@@ -979,9 +1941,20 @@ UINT16 W_CheckNumForNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 // Should be the only version, but that's not possible until we fix
 // all the instances of non null-terminated strings in the codebase...
 //
+static UINT16 W_FindLumpLongName(const wadfile_t *wadfile, const char *uname, UINT16 startlump)
+{
+	const lumphash_t *hash = &wadfile->lumphash[LUMPHASH_LONGNAME];
+	UINT32 i;
+
+	for (i = hash->first[W_HashLumpName(uname, false) & hash->mask]; i != LUMPHASH_END; i = hash->next[i])
+		if (i >= startlump && !strcmp(wadfile->lumpinfo[i].longname, uname))
+			return (UINT16)i;
+
+	return INT16_MAX;
+}
+
 UINT16 W_CheckNumForLongNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 {
-	UINT16 i;
 	static char uname[256 + 1];
 
 	if (!TestValidLump(wad,0))
@@ -996,12 +1969,7 @@ UINT16 W_CheckNumForLongNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 	//                       resources with the same name
 	//
 	if (startlump < wadfiles[wad]->numlumps)
-	{
-		lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
-		for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
-			if (!strcmp(lump_p->longname, uname))
-				return i;
-	}
+		return W_FindLumpLongName(wadfiles[wad], uname, startlump);
 
 	// not found.
 	return INT16_MAX;
@@ -1052,21 +2020,41 @@ UINT16 W_CheckNumForFolderEndPK3(const char *name, UINT16 wad, UINT16 startlump)
 	return i;
 }
 
+// Finds the first lump at or after startlump whose full name starts with the name.
+// Those are next to each other in fullnameorder, so only they are looked at.
+static UINT16 W_FindLumpFullName(const wadfile_t *wadfile, const char *name, UINT16 startlump)
+{
+	size_t len = strlen(name), lo = 0, hi = wadfile->numlumps, mid;
+	UINT16 found = INT16_MAX;
+
+	// The first full name that isn't below the name
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (W_CompareFullName(wadfile->lumpinfo[wadfile->fullnameorder[mid]].fullname, name, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (; lo < wadfile->numlumps; lo++)
+	{
+		UINT16 lump = wadfile->fullnameorder[lo];
+
+		if (W_CompareFullName(wadfile->lumpinfo[lump].fullname, name, len))
+			break;
+		if (lump >= startlump && lump < found)
+			found = lump;
+	}
+
+	return found;
+}
+
 // In a PK3 type of resource file, it looks for an entry with the specified full name.
 // Returns lump position in PK3's lumpinfo, or INT16_MAX if not found.
 UINT16 W_CheckNumForFullNamePK3(const char *name, UINT16 wad, UINT16 startlump)
 {
-	INT32 i;
-	lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
-	for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
-	{
-		if (!strnicmp(name, lump_p->fullname, strlen(name)))
-		{
-			return i;
-		}
-	}
-	// Not found at all?
-	return INT16_MAX;
+	return W_FindLumpFullName(wadfiles[wad], name, startlump);
 }
 
 //
@@ -1263,17 +2251,189 @@ lumpnum_t W_CheckNumForNameInBlock(const char *name, const char *blockstart, con
 #include "fastcmp.h"
 UINT8 W_LumpExists(const char *name)
 {
-	INT32 i,j;
+	UINT32 bucket = W_HashLumpName(name, false);
+	INT32 i;
+	UINT32 j;
 	for (i = numwadfiles - 1; i >= 0; i--)
 	{
-		lumpinfo_t *lump_p = wadfiles[i]->lumpinfo;
-		for (j = 0; j < wadfiles[i]->numlumps; ++j, ++lump_p)
-			if (fastcmp(lump_p->longname, name))
+		const lumphash_t *hash = &wadfiles[i]->lumphash[LUMPHASH_LONGNAME];
+		for (j = hash->first[bucket & hash->mask]; j != LUMPHASH_END; j = hash->next[j])
+			if (fastcmp(wadfiles[i]->lumpinfo[j].longname, name))
 				return true;
 	}
 	return false;
 }
 
+// The lookups timed by lumpbench
+typedef enum
+{
+	LUMPBENCH_NAME,
+	LUMPBENCH_LONGNAME,
+	LUMPBENCH_FULLNAME,
+	NUMLUMPBENCHES
+} lumpbench_t;
+
+// The lookups as they were before the lump name indexes, for lumpbench.
+static UINT16 W_LinearSearchLump(const wadfile_t *wadfile, lumpbench_t type, const char *name)
+{
+	UINT16 i;
+	for (i = 0; i < wadfile->numlumps; i++)
+	{
+		const lumpinfo_t *lump_p = &wadfile->lumpinfo[i];
+		if ((type == LUMPBENCH_NAME && !strncmp(lump_p->name, name, 8))
+			|| (type == LUMPBENCH_LONGNAME && !strcmp(lump_p->longname, name))
+			|| (type == LUMPBENCH_FULLNAME && !strnicmp(name, lump_p->fullname, strlen(name))))
+			return i;
+	}
+	return INT16_MAX;
+}
+
+// Reads every lump of the loaded files the way a lump cache miss does,
+// first from the file mappings, then with stdio.
+static void W_BenchLumpReads(void)
+{
+	INT32 pass;
+	UINT16 wad, lump, nummapped = 0;
+
+	for (wad = 0; wad < numwadfiles; wad++)
+		if (wadfiles[wad]->mapping)
+			nummapped++;
+
+	CONS_Printf("%d of %d files are mapped in memory\n", nummapped, numwadfiles);
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		size_t total = 0;
+		precise_t t = I_GetPreciseTime();
+		int time;
+
+		for (wad = 0; wad < numwadfiles; wad++)
+		{
+			UINT8 *mapping = pass ? NULL : wadfiles[wad]->mapping;
+
+			for (lump = 0; lump < wadfiles[wad]->numlumps; lump++)
+			{
+				size_t len = W_LumpLengthPwad(wad, lump);
+				void *ptr;
+
+				if (!len)
+					continue;
+
+				ptr = Z_Malloc(len, PU_STATIC, NULL);
+				total += W_ReadLumpData(wad, lump, ptr, 0, 0, mapping);
+				Z_Free(ptr);
+			}
+		}
+
+		time = max(I_PreciseToMicros(I_GetPreciseTime() - t), 1);
+		CONS_Printf("%-6s %s KB in %d ms, %d MB/s\n", pass ? "stdio" : "mapped",
+			sizeu1(total>>10), time / 1000, (int)((INT64)total / time));
+	}
+}
+
+/** Benchmarks the lump name lookups on a synthetic PK3 directory,
+  * against a linear search of the same directory.
+  * With "read", benchmarks reading every loaded lump instead.
+  * Usage: lumpbench [number of lumps|read]
+  */
+void Command_LumpBench_f(void)
+{
+	static const char *folders[] = {"Sprites/", "Textures/", "Flats/", "Lua/"};
+	static const char *typenames[NUMLUMPBENCHES] = {"Name", "Long name", "Full name"};
+	size_t numlumps = 50000, sample, i;
+	wadfile_t *wadfile;
+	lumpbench_t type;
+	INT32 mismatches = 0;
+
+	if (COM_Argc() > 1 && !stricmp(COM_Argv(1), "read"))
+	{
+		W_BenchLumpReads();
+		return;
+	}
+
+	if (COM_Argc() > 1)
+		numlumps = min(max(atoi(COM_Argv(1)), 1), UINT16_MAX - 1);
+
+	// Build the directory of a fake PK3, which is never added to wadfiles
+	wadfile = Z_Calloc(sizeof (*wadfile), PU_STATIC, NULL);
+	wadfile->filename = Z_StrDup("lumpbench.pk3");
+	wadfile->type = RET_PK3;
+	wadfile->numlumps = (UINT16)numlumps;
+	wadfile->lumpinfo = Z_Calloc(numlumps * sizeof (*wadfile->lumpinfo), PU_STATIC, NULL);
+
+	for (i = 0; i < numlumps; i++)
+	{
+		lumpinfo_t *lump_p = &wadfile->lumpinfo[i];
+		const char *folder = folders[i % (sizeof folders / sizeof *folders)];
+
+		lump_p->longname = Z_Malloc(16, PU_STATIC, NULL);
+		snprintf(lump_p->longname, 16, "%05X_BENCHLUMP", (unsigned)i);
+		strlcpy(lump_p->name, lump_p->longname, sizeof lump_p->name);
+		lump_p->fullname = Z_Malloc(strlen(folder) + 16 + 4, PU_STATIC, NULL);
+		sprintf(lump_p->fullname, "%s%s.png", folder, lump_p->longname);
+	}
+
+	W_MakeLumpHashes(wadfile);
+
+	// Linear searches take quadratic time overall, so only time a sample of them
+	sample = min(numlumps, 1000);
+
+	CONS_Printf("Looking up %s lumps, average time per lookup:\n", sizeu1(numlumps));
+
+	for (type = 0; type < NUMLUMPBENCHES; type++)
+	{
+		precise_t t;
+		int hashedtime, lineartime;
+
+		t = I_GetPreciseTime();
+		for (i = 0; i < numlumps; i++)
+		{
+			const lumpinfo_t *lump_p = &wadfile->lumpinfo[i];
+			UINT16 lump;
+
+			if (type == LUMPBENCH_NAME)
+				lump = W_FindLumpName(wadfile, lump_p->name, 0);
+			else if (type == LUMPBENCH_LONGNAME)
+				lump = W_FindLumpLongName(wadfile, lump_p->longname, 0);
+			else
+				lump = W_FindLumpFullName(wadfile, lump_p->fullname, 0);
+
+			if (lump != i)
+				mismatches++;
+		}
+		hashedtime = I_PreciseToMicros(I_GetPreciseTime() - t);
+
+		t = I_GetPreciseTime();
+		for (i = 0; i < sample; i++)
+		{
+			const lumpinfo_t *lump_p = &wadfile->lumpinfo[i * numlumps / sample];
+			const char *name = (type == LUMPBENCH_NAME) ? lump_p->name
+				: (type == LUMPBENCH_LONGNAME) ? lump_p->longname : lump_p->fullname;
+
+			if (W_LinearSearchLump(wadfile, type, name) != i * numlumps / sample)
+				mismatches++;
+		}
+		lineartime = I_PreciseToMicros(I_GetPreciseTime() - t);
+
+		CONS_Printf("%-10s %6d ns indexed, %8d ns linear\n", typenames[type],
+			(int)((INT64)hashedtime * 1000 / (INT64)numlumps),
+			(int)((INT64)lineartime * 1000 / (INT64)sample));
+	}
+
+	if (mismatches)
+		CONS_Alert(CONS_ERROR, "%d lookups did not find their lump\n", mismatches);
+
+	for (i = 0; i < numlumps; i++)
+	{
+		Z_Free(wadfile->lumpinfo[i].longname);
+		Z_Free(wadfile->lumpinfo[i].fullname);
+	}
+	W_FreeLumpHashes(wadfile);
+	Z_Free(wadfile->lumpinfo);
+	Z_Free(wadfile->filename);
+	Z_Free(wadfile);
+}
+
 size_t W_LumpLengthPwad(UINT16 wad, UINT16 lump)
 {
 	if (!TestValidLump(wad, lump))
@@ -1352,18 +2512,544 @@ void zerr(int ret)
 }
 #endif
 
-/** Reads bytes from the head of a lump.
-  * Note: If the lump is compressed, the whole thing has to be read anyway.
+#ifdef HAVE_ZLIB
+// ==========================================================================
+//                                                  DECOMPRESSED LUMP CACHE
+// ==========================================================================
+
+// DEFLATE lumps are kept inflated here after they're read, up to a memory
+// budget, so that lumps purged from the zone aren't inflated over again.
+// Entries are malloc'd, since W_InflateLumps fills them from worker threads.
+
+typedef struct inflatedlump_s
+{
+	struct inflatedlump_s *prev, *next; // least recently used order, most recent first
+	struct inflatedlump_s *hashnext;
+	UINT16 wad, lump;
+	size_t size;
+	UINT8 *data;
+} inflatedlump_t;
+
+#define INFLATEDHASHSIZE 1024 // must be a power of two
+#define INFLATEDHASH(wad, lump) (((wad)*31 + (lump)) & (INFLATEDHASHSIZE-1))
+
+static inflatedlump_t *inflatedhash[INFLATEDHASHSIZE];
+static inflatedlump_t inflatedlru = {&inflatedlru, &inflatedlru, NULL, 0, 0, 0, NULL};
+static size_t inflatedsize = 0; // bytes held by the cache
+static size_t inflatedbudget = 0;
+static boolean inflatedbudgetset = false;
+
+// The cache budget, 32 MB unless overridden with -inflatecache <MB>
+static size_t W_InflatedBudget(void)
+{
+	if (!inflatedbudgetset)
+	{
+		inflatedbudgetset = true;
+		inflatedbudget = 32<<20;
+		if (M_CheckParm("-inflatecache") && M_IsNextParm())
+			inflatedbudget = (size_t)max(atoi(M_GetNextParm()), 0)<<20;
+	}
+	return inflatedbudget;
+}
+
+static void W_UnlinkInflatedLump(inflatedlump_t *entry)
+{
+	entry->prev->next = entry->next;
+	entry->next->prev = entry->prev;
+}
+
+static void W_LinkInflatedLump(inflatedlump_t *entry)
+{
+	entry->next = inflatedlru.next;
+	entry->prev = &inflatedlru;
+	inflatedlru.next->prev = entry;
+	inflatedlru.next = entry;
+}
+
+static void W_FreeInflatedLump(inflatedlump_t *entry)
+{
+	inflatedlump_t **link = &inflatedhash[INFLATEDHASH(entry->wad, entry->lump)];
+
+	while (*link != entry)
+		link = &(*link)->hashnext;
+	*link = entry->hashnext;
+
+	W_UnlinkInflatedLump(entry);
+	inflatedsize -= entry->size;
+	free(entry->data);
+	free(entry);
+}
+
+/** Finds a lump in the decompressed lump cache, and marks it as recently used.
   *
-  * \param wad Wad number to read from.
-  * \param lump Lump number to read from.
-  * \param dest Buffer in memory to serve as destination.
-  * \param size Number of bytes to read.
-  * \param offest Number of bytes to offset.
-  * \return Number of bytes read (should equal size).
-  * \sa W_ReadLump, W_RawReadLumpHeader
+  * \return The cache entry, or NULL if the lump isn't cached.
   */
-size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, size_t offset)
+static inflatedlump_t *W_FindInflatedLump(UINT16 wad, UINT16 lump)
+{
+	inflatedlump_t *entry;
+
+	for (entry = inflatedhash[INFLATEDHASH(wad, lump)]; entry; entry = entry->hashnext)
+	{
+		if (entry->wad == wad && entry->lump == lump)
+		{
+			W_UnlinkInflatedLump(entry);
+			W_LinkInflatedLump(entry);
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/** Hands a freshly inflated lump over to the decompressed lump cache,
+  * evicting the least recently used lumps to stay within the budget.
+  *
+  * \param data The inflated lump, malloc'd. Freed if it can't be kept.
+  */
+static void W_KeepInflatedLump(UINT16 wad, UINT16 lump, UINT8 *data, size_t size)
+{
+	inflatedlump_t *entry;
+
+	// Don't let a single lump flush most of the cache
+	if (size > W_InflatedBudget() / 4 || W_FindInflatedLump(wad, lump))
+	{
+		free(data);
+		return;
+	}
+
+	while (inflatedsize + size > inflatedbudget)
+		W_FreeInflatedLump(inflatedlru.prev);
+
+	entry = malloc(sizeof (*entry));
+	if (!entry)
+	{
+		free(data);
+		return;
+	}
+
+	entry->wad = wad;
+	entry->lump = lump;
+	entry->size = size;
+	entry->data = data;
+	entry->hashnext = inflatedhash[INFLATEDHASH(wad, lump)];
+	inflatedhash[INFLATEDHASH(wad, lump)] = entry;
+	W_LinkInflatedLump(entry);
+	inflatedsize += size;
+}
+
+static void W_FlushInflatedLumps(void)
+{
+	while (inflatedlru.prev != &inflatedlru)
+		W_FreeInflatedLump(inflatedlru.prev);
+}
+
+/** Inflates raw DEFLATE data. Safe to call from any thread.
+  *
+  * \return Z_STREAM_END on success, a zlib error code otherwise.
+  */
+static int W_Inflate(UINT8 *rawData, size_t rawSize, UINT8 *decData, size_t decSize)
+{
+	int zErr;
+	z_stream strm;
+
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+
+	strm.total_in = strm.avail_in = rawSize;
+	strm.total_out = strm.avail_out = decSize;
+
+	strm.next_in = rawData;
+	strm.next_out = decData;
+
+	zErr = inflateInit2(&strm, -15);
+	if (zErr == Z_OK)
+	{
+		zErr = inflate(&strm, Z_FINISH);
+		(void)inflateEnd(&strm);
+	}
+
+	return zErr;
+}
+
+#endif // HAVE_ZLIB
+
+// ==========================================================================
+//                                                           LUMP PREFETCHING
+// ==========================================================================
+
+// W_PrefetchLumps hands a batch of lumps to a background thread, which pulls
+// them into memory while the caller carries on. Lumps of mapped files have
+// their pages faulted in, other lumps are read through the thread's own file
+// handles. DEFLATE lumps are then inflated in parallel, for the decompressed
+// lump cache. Nothing here touches the zone or the lump cache until
+// W_FinishPrefetch, on the main thread.
+
+typedef struct
+{
+	UINT16 wad, lump;
+	boolean inflate;      // inflate this lump for the decompressed lump cache
+	UINT8 *rawData;       // compressed data, in the file mapping or in rawBuffer
+	UINT8 *rawBuffer;     // compressed data read with stdio, malloc'd
+	UINT8 *decData;       // inflated data, malloc'd
+	int zErr;
+} prefetchjob_t;
+
+static prefetchjob_t *prefetchjobs = NULL; // the batch in flight
+static size_t numprefetchjobs;
+static size_t numinflatejobs = 0, nextinflatejob, numinflatedone; // inflate queue, guarded by prefetch_mutex
+static boolean prefetchdone;
+static precise_t prefetchtime;
+#ifdef HAVE_THREADS
+static INT32 prefetchinflatethreads; // set on the main thread, m_argv isn't thread-safe
+#endif
+
+#ifdef HAVE_THREADS
+static I_mutex prefetch_mutex;
+static I_cond  prefetch_cond;
+#  define Lock_prefetch()   I_lock_mutex(&prefetch_mutex)
+#  define Unlock_prefetch() I_unlock_mutex(prefetch_mutex)
+#else
+#  define Lock_prefetch()
+#  define Unlock_prefetch()
+#endif
+
+#ifdef HAVE_ZLIB
+// Inflates queued lumps until there are none left.
+static void W_InflateWorker(void *userdata)
+{
+	(void)userdata;
+
+	for (;;)
+	{
+		prefetchjob_t *job;
+		lumpinfo_t *l;
+
+		Lock_prefetch();
+		{
+			job = (nextinflatejob < numinflatejobs) ? &prefetchjobs[nextinflatejob++] : NULL;
+		}
+		Unlock_prefetch();
+
+		if (!job)
+			break;
+
+		l = &wadfiles[job->wad]->lumpinfo[job->lump];
+		if (job->inflate && job->rawData)
+		{
+			job->decData = malloc(l->size);
+			if (job->decData)
+				job->zErr = W_Inflate(job->rawData, l->disksize, job->decData, l->size);
+			else
+				job->zErr = Z_MEM_ERROR;
+		}
+
+		Lock_prefetch();
+		{
+			if (++numinflatedone == numinflatejobs)
+			{
+#ifdef HAVE_THREADS
+				I_wake_all_cond(&prefetch_cond);
+#endif
+			}
+		}
+		Unlock_prefetch();
+	}
+}
+#endif
+
+static void W_PrefetchThread(void *userdata)
+{
+	FILE *handles[MAX_WADFILES];
+	size_t i, numinflate = 0;
+	UINT16 wad;
+
+	(void)userdata;
+
+	for (wad = 0; wad < MAX_WADFILES; wad++)
+		handles[wad] = NULL;
+
+	for (i = 0; i < numprefetchjobs; i++)
+	{
+		prefetchjob_t *job = &prefetchjobs[i];
+		wadfile_t *wadfile = wadfiles[job->wad];
+		lumpinfo_t *l = &wadfile->lumpinfo[job->lump];
+
+		if (wadfile->mapping)
+		{
+			// Fault the pages in, so that reading the lump later doesn't wait on the disk
+			const volatile UINT8 *data = wadfile->mapping + l->position;
+			UINT8 sum = 0;
+			size_t ofs;
+
+			for (ofs = 0; ofs < l->disksize; ofs += 4096)
+				sum += data[ofs];
+			(void)sum;
+
+			job->rawData = wadfile->mapping + l->position;
+		}
+		else
+		{
+			if (!handles[job->wad])
+				handles[job->wad] = fopen(wadfile->filename, "rb");
+
+			job->rawBuffer = malloc(l->disksize);
+			if (job->rawBuffer && handles[job->wad]
+				&& fseek(handles[job->wad], (long)l->position, SEEK_SET) != -1
+				&& fread(job->rawBuffer, 1, l->disksize, handles[job->wad]) == l->disksize)
+			{
+				job->rawData = job->rawBuffer;
+			}
+
+			// Uncompressed lumps are in the OS file cache now, that's all we wanted
+			if (!job->inflate || !job->rawData)
+			{
+				free(job->rawBuffer);
+				job->rawBuffer = NULL;
+				job->rawData = NULL;
+			}
+		}
+
+		if (job->inflate && job->rawData)
+			numinflate++;
+	}
+
+	for (wad = 0; wad < MAX_WADFILES; wad++)
+		if (handles[wad])
+			fclose(handles[wad]);
+
+#ifdef HAVE_ZLIB
+	{
+#ifdef HAVE_THREADS
+		INT32 numthreads = prefetchinflatethreads;
+#endif
+
+		Lock_prefetch();
+		{
+			numinflatejobs = numprefetchjobs;
+			nextinflatejob = numinflatedone = 0;
+		}
+		Unlock_prefetch();
+
+#ifdef HAVE_THREADS
+		numthreads = min(numthreads, (INT32)numinflate - 1);
+
+		while (numthreads-- > 0)
+			I_spawn_thread("inflate-lumps", W_InflateWorker, NULL);
+#endif
+
+		// Lend a hand, then wait for the stragglers
+		W_InflateWorker(NULL);
+
+#ifdef HAVE_THREADS
+		Lock_prefetch();
+		{
+			while (numinflatedone < numinflatejobs)
+				I_hold_cond(&prefetch_cond, prefetch_mutex);
+		}
+		Unlock_prefetch();
+#endif
+
+		// Close the queue; workers still looking for a job will find none
+		Lock_prefetch();
+		{
+			numinflatejobs = 0;
+		}
+		Unlock_prefetch();
+	}
+#else
+	(void)numinflate;
+#endif
+
+	Lock_prefetch();
+	{
+		prefetchdone = true;
+#ifdef HAVE_THREADS
+		I_wake_all_cond(&prefetch_cond);
+#endif
+	}
+	Unlock_prefetch();
+}
+
+static int W_ComparePrefetchJobs(const void *a, const void *b)
+{
+	const prefetchjob_t *ja = a, *jb = b;
+	if (ja->wad != jb->wad)
+		return ja->wad - jb->wad;
+	return ja->lump - jb->lump;
+}
+
+/** Starts pulling a batch of lumps into memory in the background.
+  * Call W_FinishPrefetch before relying on the results; reading any of the
+  * lumps in the meantime is fine, if not any faster.
+  *
+  * \param lumps The lumps to prefetch. Duplicates and LUMPERROR are fine.
+  * \param count Number of lumps in the list.
+  */
+void W_PrefetchLumps(const lumpnum_t *lumps, size_t count)
+{
+	size_t i, numjobs = 0;
+#ifdef HAVE_ZLIB
+	size_t inflatesize = 0;
+#endif
+	prefetchjob_t *jobs;
+
+	// One batch at a time
+	W_FinishPrefetch();
+
+	if (!count)
+		return;
+
+	jobs = malloc(count * sizeof (*jobs));
+	if (!jobs)
+		return;
+
+	for (i = 0; i < count; i++)
+	{
+		UINT16 wad = WADFILENUM(lumps[i]), lump = LUMPNUM(lumps[i]);
+
+		if (lumps[i] == LUMPERROR || wad >= numwadfiles || lump >= wadfiles[wad]->numlumps)
+			continue;
+		if (!wadfiles[wad]->lumpinfo[lump].disksize)
+			continue;
+
+		jobs[numjobs].wad = wad;
+		jobs[numjobs].lump = lump;
+		numjobs++;
+	}
+
+	// Drop duplicates, and pick the lumps to inflate
+	qsort(jobs, numjobs, sizeof (*jobs), W_ComparePrefetchJobs);
+	for (i = count = 0; i < numjobs; i++)
+	{
+		prefetchjob_t *job = &jobs[count];
+
+		if (count && jobs[count-1].wad == jobs[i].wad && jobs[count-1].lump == jobs[i].lump)
+			continue;
+
+		*job = jobs[i];
+		job->inflate = false;
+		job->rawData = NULL;
+		job->rawBuffer = NULL;
+		job->decData = NULL;
+		job->zErr = 0;
+
+#ifdef HAVE_ZLIB
+		if (wadfiles[job->wad]->lumpinfo[job->lump].compression == CM_DEFLATE
+			&& !W_FindInflatedLump(job->wad, job->lump))
+		{
+			// No point inflating more than the cache can keep
+			inflatesize += wadfiles[job->wad]->lumpinfo[job->lump].size;
+			job->inflate = (inflatesize <= W_InflatedBudget());
+		}
+#endif
+
+		count++;
+	}
+
+	prefetchjobs = jobs;
+	numprefetchjobs = count;
+	prefetchdone = false;
+	prefetchtime = I_GetPreciseTime();
+
+#ifdef HAVE_THREADS
+	prefetchinflatethreads = I_cpu_count() - 1;
+	if (M_CheckParm("-inflatethreads") && M_IsNextParm())
+		prefetchinflatethreads = atoi(M_GetNextParm());
+
+	I_spawn_thread("prefetch-lumps", W_PrefetchThread, NULL);
+#else
+	W_PrefetchThread(NULL);
+#endif
+}
+
+/** Waits for the batch started by W_PrefetchLumps, if any, and moves the
+  * lumps it inflated into the decompressed lump cache.
+  */
+void W_FinishPrefetch(void)
+{
+	size_t i, numinflated = 0;
+	precise_t waittime;
+
+	if (!prefetchjobs)
+		return;
+
+	waittime = I_GetPreciseTime();
+
+#ifdef HAVE_THREADS
+	Lock_prefetch();
+	{
+		while (!prefetchdone)
+			I_hold_cond(&prefetch_cond, prefetch_mutex);
+	}
+	Unlock_prefetch();
+#endif
+
+	waittime = I_GetPreciseTime() - waittime;
+
+	for (i = 0; i < numprefetchjobs; i++)
+	{
+		prefetchjob_t *job = &prefetchjobs[i];
+
+#ifdef HAVE_ZLIB
+		if (job->decData && job->zErr == Z_STREAM_END)
+		{
+			W_KeepInflatedLump(job->wad, job->lump, job->decData, wadfiles[job->wad]->lumpinfo[job->lump].size);
+			numinflated++;
+		}
+		else
+#endif
+			free(job->decData); // W_ReadLumpHeaderPwad will report any error
+		free(job->rawBuffer);
+	}
+
+	CONS_Debug(DBG_SETUP, "Prefetched %s lumps (%s inflated) in %d us, waited %d us\n",
+		sizeu1(numprefetchjobs), sizeu2(numinflated),
+		I_PreciseToMicros(I_GetPreciseTime() - prefetchtime), I_PreciseToMicros(waittime));
+
+	free(prefetchjobs);
+	prefetchjobs = NULL;
+	numprefetchjobs = 0;
+}
+
+/** Decompresses a batch of lumps ahead of reading them, and waits for it.
+  *
+  * \sa W_PrefetchLumps
+  */
+void W_InflateLumps(const lumpnum_t *lumps, size_t count)
+{
+	W_PrefetchLumps(lumps, count);
+	W_FinishPrefetch();
+}
+
+
+// Returns the data of a compressed lump as stored in the file.
+// With a file mapping, this points straight into it; free it with W_FreeRawLump.
+static void *W_ReadRawLump(UINT16 wad, UINT16 lump, UINT8 *mapping)
+{
+	wadfile_t *wadfile = wadfiles[wad];
+	lumpinfo_t *l = wadfile->lumpinfo + lump;
+	void *rawData;
+
+	if (mapping)
+		return mapping + l->position;
+
+	rawData = Z_Malloc(l->disksize, PU_STATIC, NULL);
+	fseek(wadfile->handle, (long)l->position, SEEK_SET);
+	if (fread(rawData, 1, l->disksize, wadfile->handle) < l->disksize)
+		I_Error("wad %d, lump %d: cannot read compressed data", wad, lump);
+
+	return rawData;
+}
+
+static void W_FreeRawLump(UINT8 *mapping, void *rawData)
+{
+	if (!mapping)
+		Z_Free(rawData);
+}
+
+// Reads bytes from the head of a lump, from the file's mapping if it's given one.
+static size_t W_ReadLumpData(UINT16 wad, UINT16 lump, void *dest, size_t size, size_t offset, UINT8 *mapping)
 {
 	size_t lumpsize;
 	lumpinfo_t *l;
@@ -1385,22 +3071,30 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 	// We setup the desired file handle to read the lump data.
 	l = wadfiles[wad]->lumpinfo + lump;
 	handle = wadfiles[wad]->handle;
-	fseek(handle, (long)(l->position + offset), SEEK_SET);
 
 	// But let's not copy it yet. We support different compression formats on lumps, so we need to take that into account.
 	switch(wadfiles[wad]->lumpinfo[lump].compression)
 	{
 	case CM_NOCOMPRESSION:		// If it's uncompressed, we directly write the data into our destination, and return the bytes read.
-#ifdef NO_PNG_LUMPS
 		{
-			size_t bytesread = fread(dest, 1, size, handle);
+			size_t bytesread;
+
+			if (mapping)
+			{
+				M_Memcpy(dest, mapping + l->position + offset, size);
+				bytesread = size;
+			}
+			else
+			{
+				fseek(handle, (long)(l->position + offset), SEEK_SET);
+				bytesread = fread(dest, 1, size, handle);
+			}
+#ifdef NO_PNG_LUMPS
 			if (Picture_IsLumpPNG((UINT8 *)dest, bytesread))
 				Picture_ThrowPNGError(l->fullname, wadfiles[wad]->filename);
+#endif
 			return bytesread;
 		}
-#else
-		return fread(dest, 1, size, handle);
-#endif
 	case CM_LZF:		// Is it LZF compressed? Used by ZWADs.
 		{
 #ifdef ZWAD
@@ -1408,11 +3102,9 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 			char *decData; // Lump's decompressed real data.
 			size_t retval; // Helper var, lzf_decompress returns 0 when an error occurs.
 
-			rawData = Z_Malloc(l->disksize, PU_STATIC, NULL);
+			rawData = W_ReadRawLump(wad, lump, mapping);
 			decData = Z_Malloc(l->size, PU_STATIC, NULL);
 
-			if (fread(rawData, 1, l->disksize, handle) < l->disksize)
-				I_Error("wad %d, lump %d: cannot read compressed data", wad, lump);
 			retval = lzf_decompress(rawData, l->disksize, decData, l->size);
 #ifndef AVOID_ERRNO
 			if (retval == 0) // If this was returned, check if errno was set
@@ -1433,7 +3125,7 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 			if (!decData) // Did we get no data at all?
 				return 0;
 			M_Memcpy(dest, decData + offset, size);
-			Z_Free(rawData);
+			W_FreeRawLump(mapping, rawData);
 			Z_Free(decData);
 #ifdef NO_PNG_LUMPS
 			if (Picture_IsLumpPNG((UINT8 *)dest, size))
@@ -1451,52 +3143,40 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 		{
 			UINT8 *rawData; // The lump's raw data.
 			UINT8 *decData; // Lump's decompressed real data.
+			inflatedlump_t *inflated;
 
 			int zErr; // Helper var.
-			z_stream strm;
-			unsigned long rawSize = l->disksize;
-			unsigned long decSize = l->size;
-
-			rawData = Z_Malloc(rawSize, PU_STATIC, NULL);
-			decData = Z_Malloc(decSize, PU_STATIC, NULL);
 
-			if (fread(rawData, 1, rawSize, handle) < rawSize)
-				I_Error("wad %d, lump %d: cannot read compressed data", wad, lump);
-
-			strm.zalloc = Z_NULL;
-			strm.zfree = Z_NULL;
-			strm.opaque = Z_NULL;
-
-			strm.total_in = strm.avail_in = rawSize;
-			strm.total_out = strm.avail_out = decSize;
+			// Already inflated?
+			if ((inflated = W_FindInflatedLump(wad, lump)) != NULL)
+			{
+				M_Memcpy(dest, inflated->data + offset, size);
+#ifdef NO_PNG_LUMPS
+				if (Picture_IsLumpPNG((UINT8 *)dest, size))
+					Picture_ThrowPNGError(l->fullname, wadfiles[wad]->filename);
+#endif
+				return size;
+			}
 
-			strm.next_in = rawData;
-			strm.next_out = decData;
+			rawData = W_ReadRawLump(wad, lump, mapping);
+			decData = malloc(l->size);
+			if (!decData)
+				I_Error("wad %d, lump %d: out of memory inflating %s bytes", wad, lump, sizeu1(l->size));
 
-			zErr = inflateInit2(&strm, -15);
-			if (zErr == Z_OK)
+			zErr = W_Inflate(rawData, l->disksize, decData, l->size);
+			if (zErr == Z_STREAM_END)
 			{
-				zErr = inflate(&strm, Z_FINISH);
-				if (zErr == Z_STREAM_END)
-				{
-					M_Memcpy(dest, decData, size);
-				}
-				else
-				{
-					size = 0;
-					zerr(zErr);
-				}
-
-				(void)inflateEnd(&strm);
+				M_Memcpy(dest, decData + offset, size);
+				W_KeepInflatedLump(wad, lump, decData, l->size);
 			}
 			else
 			{
 				size = 0;
 				zerr(zErr);
+				free(decData);
 			}
 
-			Z_Free(rawData);
-			Z_Free(decData);
+			W_FreeRawLump(mapping, rawData);
 
 #ifdef NO_PNG_LUMPS
 			if (Picture_IsLumpPNG((UINT8 *)dest, size))
@@ -1511,6 +3191,24 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 	return 0;
 }
 
+/** Reads bytes from the head of a lump.
+  * Note: If the lump is compressed, the whole thing has to be read anyway.
+  *
+  * \param wad Wad number to read from.
+  * \param lump Lump number to read from.
+  * \param dest Buffer in memory to serve as destination.
+  * \param size Number of bytes to read.
+  * \param offest Number of bytes to offset.
+  * \return Number of bytes read (should equal size).
+  * \sa W_ReadLump, W_RawReadLumpHeader
+  */
+size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, size_t offset)
+{
+	if (!TestValidLump(wad,lump))
+		return 0;
+	return W_ReadLumpData(wad, lump, dest, size, offset, wadfiles[wad]->mapping);
+}
+
 size_t W_ReadLumpHeader(lumpnum_t lumpnum, void *dest, size_t size, size_t offset)
 {
 	return W_ReadLumpHeaderPwad(WADFILENUM(lumpnum), LUMPNUM(lumpnum), dest, size, offset);
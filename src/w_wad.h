@@ -97,6 +97,7 @@ virtlump_t* vres_Find(const virtres_t*, const char*);
 // =========================================================================
 
 #define MAX_WADPATH 512
+#define CACHE_DIR "cache" // In srb2home; holds what can be rebuilt whenever it goes missing
 #define MAX_WADFILES 48 // maximum of wad files used at the same time
 // (there is a max of simultaneous open files anyway, and this should be plenty)
 
@@ -112,6 +113,25 @@ typedef enum restype
 	RET_UNKNOWN,
 } restype_t;
 
+// Lump name indexes of a resource file, for the W_CheckNumFor* lookups
+typedef enum
+{
+	LUMPHASH_NAME,     // lumpinfo_t name
+	LUMPHASH_LONGNAME, // lumpinfo_t longname
+	NUMLUMPHASHES
+} lumphashtype_t;
+
+#define LUMPHASH_END UINT32_MAX // end of a hash chain
+
+// Lumps sharing a bucket are chained in ascending lump order,
+// so the first match at or after a start lump is the one to return.
+typedef struct
+{
+	UINT32 *first; // first lump of each bucket
+	UINT32 *next;  // next lump in the same bucket, indexed by lump number
+	UINT32 mask;   // number of buckets - 1
+} lumphash_t;
+
 typedef struct wadfile_s
 {
 	char *filename;
@@ -120,7 +140,10 @@ typedef struct wadfile_s
 	lumpcache_t *lumpcache;
 	lumpcache_t *patchcache;
 	UINT16 numlumps; // this wad's number of resources
+	lumphash_t lumphash[NUMLUMPHASHES];
+	UINT16 *fullnameorder; // lump numbers sorted by full name, case insensitive
 	FILE *handle;
+	UINT8 *mapping; // the whole file mapped in memory, or NULL to read lumps from handle
 	UINT32 filesize; // for network
 	UINT8 md5sum[16];
 
@@ -145,6 +168,9 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup);
 // W_InitMultipleFiles exits if a file was not found, but not if all is okay.
 void W_InitMultipleFiles(char **filenames);
 
+// Hands W_InitFile the MD5 of a file that was hashed elsewhere
+void W_AddFileMD5(const char *filename, const UINT8 *md5sum);
+
 const char *W_CheckNameForNumPwad(UINT16 wad, UINT16 lump);
 const char *W_CheckNameForNum(lumpnum_t lumpnum);
 
@@ -166,6 +192,8 @@ lumpnum_t W_GetNumForLongName(const char *name);
 lumpnum_t W_CheckNumForNameInBlock(const char *name, const char *blockstart, const char *blockend);
 UINT8 W_LumpExists(const char *name); // Lua uses this.
 
+void Command_LumpBench_f(void);
+
 size_t W_LumpLengthPwad(UINT16 wad, UINT16 lump);
 size_t W_LumpLength(lumpnum_t lumpnum);
 
@@ -179,6 +207,9 @@ void zerr(int ret); // zlib error checking
 size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, size_t offset);
 size_t W_ReadLumpHeader(lumpnum_t lump, void *dest, size_t size, size_t offest); // read all or a part of a lump
 void W_ReadLumpPwad(UINT16 wad, UINT16 lump, void *dest);
+void W_PrefetchLumps(const lumpnum_t *lumps, size_t count); // read a batch of lumps in the background
+void W_FinishPrefetch(void); // wait for W_PrefetchLumps
+void W_InflateLumps(const lumpnum_t *lumps, size_t count); // decompress a batch of lumps ahead of reading them
 void W_ReadLump(lumpnum_t lump, void *dest);
 
 void *W_CacheLumpNumPwad(UINT16 wad, UINT16 lump, INT32 tag);
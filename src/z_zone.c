@@ -33,6 +33,8 @@
 #include "i_video.h" // rendermode
 #include "z_zone.h"
 #include "m_misc.h" // M_Memcpy
+#include "m_argv.h" // M_CheckParm
+#include "d_main.h" // srb2home
 #include "lua_script.h"
 
 #ifdef HWRENDER
@@ -47,6 +49,13 @@ static boolean Z_calloc = false;
 
 #define ZONEID 0xa441d13d
 
+// Small level-lifetime blocks (mobjs, thinkers, precipitation...) are carved
+// out of per-size-class slabs instead of being malloc'd twice each. Valgrind
+// builds keep going through malloc so every block stays its own mempool.
+#if !defined (HAVE_VALGRIND) && !defined (NOZSLAB)
+#define ZSLAB
+#endif
+
 #ifdef ZDEBUG
 //#define ZDEBUG2
 #endif
@@ -81,19 +90,143 @@ typedef struct memblock_s
 	INT32 ownerline;
 #endif
 
+#ifdef ZSLAB
+	struct zslab_s *slab; // size class this block was carved from, NULL if malloc'd
+#endif
+
+	UINT16 site; // allocation profiler call site, 0 if not profiled
+
 	struct memblock_s *next, *prev;
 } ATTRPACK memblock_t;
 
 // both the head and tail of the zone memory block list
 static memblock_t head;
 
+// Level-tagged slab blocks are kept on their own list, so that
+// Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1) can drop them all at once
+// without walking them one by one.
+static memblock_t levelhead;
+
+#define Z_IsLevelTag(tag) ((tag) >= PU_LEVEL && (tag) < PU_PURGELEVEL)
+
+#ifdef ZSLAB
+// Slab objects are laid out as memblock_t, memhdr_t, then the user's data.
+// The data is always aligned to ZSLAB_ALIGN bytes, so small alignment
+// requests can be served from a slab as well.
+#define ZSLAB_ALIGN 16
+#define ZSLAB_GRANULARITY 32
+#define ZSLAB_MAXOBJSIZE 2048
+#define ZSLAB_NUMCLASSES (ZSLAB_MAXOBJSIZE / ZSLAB_GRANULARITY)
+#define ZSLAB_PAGESIZE (64<<10)
+
+#define ZSLAB_ROUNDUP(x, a) (((x) + (a) - 1) & ~((size_t)(a) - 1))
+
+// offset of the user's data from the start of a slab object
+#define ZSLAB_DATAOFS ZSLAB_ROUNDUP(sizeof (memblock_t) + sizeof (memhdr_t), ZSLAB_ALIGN)
+// the first object of a slab page; malloc only aligns to 8 bytes on some
+// 32-bit targets, so the page itself can't be trusted to be aligned
+#define ZSLAB_PAGESTART(page) ((UINT8 *)ZSLAB_ROUNDUP((size_t)(page) + sizeof (zslabpage_t), ZSLAB_ALIGN))
+
+typedef struct zslabpage_s
+{
+	struct zslabpage_s *next;
+} zslabpage_t;
+
+typedef struct zslabfree_s
+{
+	struct zslabfree_s *next;
+} zslabfree_t;
+
+typedef struct zslab_s
+{
+	size_t objsize; // size of every object in this class, headers included
+
+	zslabpage_t *pages; // every page owned by this class
+	zslabfree_t *freelist; // objects that were freed and can be reused
+
+	// Space that was never handed out in the newest page
+	UINT8 *bump, *bumpend;
+
+	size_t numpages;
+	size_t numlive;
+} zslab_t;
+
+static zslab_t slabs[ZSLAB_NUMCLASSES];
+
+// Slab blocks that were retagged out of the level tags (and moved to the
+// main list), and level slab blocks that were given a user after the fact.
+// Both force the level arena to take the slow path when it is released.
+static size_t slabescaped;
+static size_t slabusers;
+
+// The level arena: slab pages are carved out of a few large chunks, which
+// are all dropped in one go when the level is freed. Dropped chunks are
+// reused by the next level, and whatever it didn't need is given back to
+// the system when that level is freed in turn. Disabled by -nolevelarena,
+// in which case every page is malloc'd and freed on its own.
+#define ZARENA_PAGESPERCHUNK 16
+#define ZARENA_CHUNKOFS ZSLAB_ROUNDUP(sizeof (zarenachunk_t), ZSLAB_ALIGN)
+#define ZARENA_CHUNKSIZE (ZARENA_CHUNKOFS + ZARENA_PAGESPERCHUNK * ZSLAB_PAGESIZE)
+
+typedef struct zarenachunk_s
+{
+	struct zarenachunk_s *next;
+	size_t numpages; // pages handed out so far
+} zarenachunk_t;
+
+static boolean levelarena;
+static zarenachunk_t *arenachunks, *sparechunks;
+static size_t numarenachunks, numsparechunks;
+
+// The arena chunks again, sorted by address, to tell quickly if a pointer is in one
+static zarenachunk_t **sortedchunks;
+static size_t sortedchunkssize;
+#endif
+
 //
 // Function prototypes
 //
+#ifdef ZSLAB
+static zslab_t *Z_SlabForSize(size_t size, INT32 tag, void *user, INT32 alignbits);
+static void *Z_SlabAlloc(zslab_t *slab);
+static void Z_SlabFree(memblock_t *block);
+static void Z_SlabTrim(void);
+static void Z_RecycleLevelArena(void);
+static void Z_ResetLevelArena(void);
+static void Z_FreeSpareArena(void);
+#endif
+
+static void Z_CheckList(INT32 i, memblock_t *list);
+
 static void Command_Memfree_f(void);
 #ifdef ZDEBUG
 static void Command_Memdump_f(void);
 #endif
+static void Command_Zprofile_f(void);
+
+// ----------------------
+// Zone memory statistics
+// ----------------------
+
+static zstats_t tagstats[ZNUMTAGSTATS];
+
+// Allocation profiler call sites, hashed by file + line.
+// Site 0 is never used, blocks allocated while not profiling get it.
+#define ZMAXSITES 2048
+#define ZSITEHASHSIZE 4096
+
+static zstats_t sitestats[ZMAXSITES];
+static UINT16 sitehash[ZSITEHASHSIZE];
+static size_t numsites = 1;
+static boolean profiling = false;
+
+#ifdef ZSLAB
+#define Z_OnLevelList(block) ((block)->slab && Z_IsLevelTag((block)->tag))
+#else
+#define Z_OnLevelList(block) false
+#endif
+
+#define Z_TagStats(tag) (&tagstats[min(max((tag), 0), ZNUMTAGSTATS - 1)])
 
 // --------------------------
 // Zone memory initialisation
@@ -109,14 +242,28 @@ void Z_Init(void)
 	UINT32 total, memfree;
 
 	memset(&head, 0x00, sizeof(head));
+	memset(&levelhead, 0x00, sizeof(levelhead));
 
 	head.next = head.prev = &head;
+	levelhead.next = levelhead.prev = &levelhead;
+
+#ifdef ZSLAB
+	{
+		size_t i;
+		memset(slabs, 0x00, sizeof(slabs));
+		for (i = 0; i < ZSLAB_NUMCLASSES; i++)
+			slabs[i].objsize = (i + 1) * ZSLAB_GRANULARITY;
+	}
+
+	levelarena = !M_CheckParm("-nolevelarena");
+#endif
 
 	memfree = I_GetFreeMem(&total)>>20;
 	CONS_Printf("System memory: %uMB - Free: %uMB\n", total>>20, memfree);
 
 	// Note: This allocates memory. Watch out.
 	COM_AddCommand("memfree", Command_Memfree_f);
+	COM_AddCommand("zprofile", Command_Zprofile_f);
 
 #ifdef ZDEBUG
 	COM_AddCommand("memdump", Command_Memdump_f);
@@ -128,6 +275,84 @@ void Z_Init(void)
 // Zone memory allocation
 // ----------------------
 
+/** Inserts a block at the front of a zone memory block list.
+  *
+  * \param block The block to insert.
+  * \param list The head of the list, either head or levelhead.
+  */
+static void Z_LinkBlock(memblock_t *block, memblock_t *list)
+{
+	block->next = list->next;
+	block->prev = list;
+	list->next = block;
+	block->next->prev = block;
+}
+
+/** Counts a block as live in a set of statistics.
+  *
+  * \param st The tag's or call site's statistics.
+  * \param block The block.
+  */
+static void Z_StatsLink(zstats_t *st, memblock_t *block)
+{
+	st->live += block->realsize;
+	st->liveblocks++;
+
+	if (st->live > st->peak)
+		st->peak = st->live;
+
+	if (Z_OnLevelList(block))
+	{
+		st->arena += block->realsize;
+		st->arenablocks++;
+	}
+}
+
+/** Stops counting a block as live in a set of statistics.
+  *
+  * \param st The tag's or call site's statistics.
+  * \param block The block.
+  */
+static void Z_StatsUnlink(zstats_t *st, memblock_t *block)
+{
+	st->live -= block->realsize;
+	st->liveblocks--;
+
+	if (Z_OnLevelList(block))
+	{
+		st->arena -= block->realsize;
+		st->arenablocks--;
+	}
+}
+
+/** Finds or adds the allocation profiler's entry for a call site.
+  *
+  * \param file The file the allocation was made from.
+  * \param line The line the allocation was made from.
+  * \return The site's index in sitestats, or 0 if there is no room left.
+  */
+static UINT16 Z_FindSite(const char *file, INT32 line)
+{
+	size_t i = (((size_t)file >> 3) ^ ((size_t)line * 2654435761u)) & (ZSITEHASHSIZE - 1);
+
+	// Linear probing; sitehash is never more than half full
+	while (sitehash[i])
+	{
+		zstats_t *site = &sitestats[sitehash[i]];
+		if (site->line == line && site->file == file)
+			return sitehash[i];
+		i = (i + 1) & (ZSITEHASHSIZE - 1);
+	}
+
+	if (numsites == ZMAXSITES)
+		return 0;
+
+	sitestats[numsites].file = file;
+	sitestats[numsites].line = line;
+	sitehash[i] = (UINT16)numsites;
+	return (UINT16)(numsites++);
+}
+
 /** Returns the corresponding memblock_t for a given memory block.
   *
   * \param ptr A pointer to allocated memory,
@@ -229,6 +454,30 @@ void Z_Free(void *ptr)
 	if (block->user != NULL)
 		*block->user = NULL;
 
+	// Update the statistics
+	Z_TagStats(block->tag)->frees++;
+	Z_StatsUnlink(Z_TagStats(block->tag), block);
+	if (block->site)
+	{
+		sitestats[block->site].frees++;
+		Z_StatsUnlink(&sitestats[block->site], block);
+	}
+
+#ifdef ZSLAB
+	if (block->slab)
+	{
+		if (!Z_IsLevelTag(block->tag))
+			slabescaped--;
+		if (block->user != NULL)
+			slabusers--;
+
+		block->prev->next = block->next;
+		block->next->prev = block->prev;
+		Z_SlabFree(block);
+		return;
+	}
+#endif
+
 	// Free the memory and get rid of the block.
 	free(block->real);
 #ifdef VALGRIND_DESTROY_MEMPOOL
@@ -257,6 +506,9 @@ static void *xm(size_t size)
 	{
 		// Oh crumbs: we're out of heap. Try purging the cache and reallocating.
 		Z_FreeTags(PU_PURGELEVEL, INT32_MAX);
+#ifdef ZSLAB
+		Z_FreeSpareArena();
+#endif
 		p = malloc(padedsize);
 
 		if (p == NULL)
@@ -277,15 +529,13 @@ static void *xm(size_t size)
   *             When the memory is freed by Z_Free later,
   *             the pointer at this address will then be automatically set to NULL.
   * \param alignbits The alignment of the memory to be allocated, in bits. Can be 0.
+  * \param file The file this was called from.
+  * \param line The line this was called from.
   * \note You can pass Z_Malloc() a NULL user if the tag is less than PU_PURGELEVEL.
   * \sa Z_CallocAlign, Z_ReallocAlign
   */
-#ifdef ZDEBUG
 void *Z_Malloc2(size_t size, INT32 tag, void *user, INT32 alignbits,
 	const char *file, INT32 line)
-#else
-void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
-#endif
 {
 	size_t extrabytes = (1<<alignbits) - 1;
 	size_t padsize = 0;
@@ -294,6 +544,9 @@ void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
 	memhdr_t *hdr;
 	void *given;
 	size_t blocksize = extrabytes + sizeof *hdr + size;
+#ifdef ZSLAB
+	zslab_t *slab;
+#endif
 
 #ifdef ZDEBUG2
 	CONS_Debug(DBG_MEMORY, "Z_Malloc %s:%d\n", file, line);
@@ -302,16 +555,30 @@ void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
 	if (blocksize < size)/* overflow check */
 		I_Error("You are allocating memory too large!");
 
-	block = xm(sizeof *block);
+#ifdef ZSLAB
+	slab = Z_SlabForSize(size, tag, user, alignbits);
+	if (slab)
+	{
+		// The block, the header and the data all live in one slab object.
+		ptr = Z_SlabAlloc(slab);
+		block = ptr;
+		given = (UINT8 *)ptr + ZSLAB_DATAOFS;
+		blocksize = slab->objsize - sizeof *block;
+	}
+	else
+#endif
+	{
+		block = xm(sizeof *block);
 #ifdef HAVE_VALGRIND
-	padsize += (1<<sizeof(size_t))*2;
+		padsize += (1<<sizeof(size_t))*2;
 #endif
-	ptr = xm(blocksize + padsize*2);
+		ptr = xm(blocksize + padsize*2);
 
-	// This horrible calculation makes sure that "given" is aligned
-	// properly.
-	given = (void *)((size_t)((UINT8 *)ptr + extrabytes + sizeof *hdr + padsize/2)
-		& ~extrabytes);
+		// This horrible calculation makes sure that "given" is aligned
+		// properly.
+		given = (void *)((size_t)((UINT8 *)ptr + extrabytes + sizeof *hdr + padsize/2)
+			& ~extrabytes);
+	}
 
 	// The mem header lives 'sizeof (memhdr_t)' bytes before given.
 	hdr = (memhdr_t *)((UINT8 *)given - sizeof *hdr);
@@ -320,10 +587,12 @@ void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
 	Z_calloc = false;
 #endif
 
-	block->next = head.next;
-	block->prev = &head;
-	head.next = block;
-	block->next->prev = block;
+#ifdef ZSLAB
+	if (slab)
+		Z_LinkBlock(block, &levelhead);
+	else
+#endif
+	Z_LinkBlock(block, &head);
 
 	block->real = ptr;
 	block->hdr = hdr;
@@ -335,6 +604,9 @@ void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
 #endif
 	block->size = blocksize;
 	block->realsize = size;
+#ifdef ZSLAB
+	block->slab = slab;
+#endif
 
 #ifdef VALGRIND_CREATE_MEMPOOL
 	VALGRIND_CREATE_MEMPOOL(block, padsize, Z_calloc);
@@ -359,6 +631,25 @@ void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
 		I_Error("Z_Malloc: attempted to allocate purgable block "
 			"(size %s) with no user", sizeu1(size));
 
+	// Update the statistics
+	{
+		zstats_t *st = Z_TagStats(tag);
+		st->allocs++;
+		st->bytes += size;
+		st->ticbytes += size;
+		Z_StatsLink(st, block);
+	}
+
+	block->site = profiling ? Z_FindSite(file, line) : 0;
+	if (block->site)
+	{
+		zstats_t *st = &sitestats[block->site];
+		st->allocs++;
+		st->bytes += size;
+		st->ticbytes += size;
+		Z_StatsLink(st, block);
+	}
+
 	return given;
 }
 
@@ -372,23 +663,17 @@ void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
   *             When the memory is freed by Z_Free later,
   *             the pointer at this address will then be automatically set to NULL.
   * \param alignbits The alignment of the memory to be allocated, in bits. Can be 0.
+  * \param file The file this was called from.
+  * \param line The line this was called from.
   * \note You can pass Z_Calloc() a NULL user if the tag is less than PU_PURGELEVEL.
   * \sa Z_MallocAlign, Z_ReallocAlign
   */
-#ifdef ZDEBUG
 void *Z_Calloc2(size_t size, INT32 tag, void *user, INT32 alignbits, const char *file, INT32 line)
-#else
-void *Z_CallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
-#endif
 {
 #ifdef VALGRIND_MEMPOOL_ALLOC
 	Z_calloc = true;
 #endif
-#ifdef ZDEBUG
-	return memset(Z_Malloc2    (size, tag, user, alignbits, file, line), 0, size);
-#else
-	return memset(Z_MallocAlign(size, tag, user, alignbits            ), 0, size);
-#endif
+	return memset(Z_Malloc2(size, tag, user, alignbits, file, line), 0, size);
 }
 
 /** The Z_ReallocAlign function.
@@ -403,15 +688,13 @@ void *Z_CallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits)
   * \param user The address of a pointer to the memory to be reallocated.
   *             This can be a different user to the one originally assigned to the memory block.
   * \param alignbits The alignment of the memory to be allocated, in bits. Can be 0.
+  * \param file The file this was called from.
+  * \param line The line this was called from.
   * \return A pointer to the reallocated memory. Can be NULL if memory was freed.
   * \note You can pass Z_Realloc() a NULL user if the tag is less than PU_PURGELEVEL.
   * \sa Z_MallocAlign, Z_CallocAlign
   */
-#ifdef ZDEBUG
 void *Z_Realloc2(void *ptr, size_t size, INT32 tag, void *user, INT32 alignbits, const char *file, INT32 line)
-#else
-void *Z_ReallocAlign(void *ptr, size_t size, INT32 tag, void *user, INT32 alignbits)
-#endif
 {
 	void *rez;
 	memblock_t *block;
@@ -428,13 +711,7 @@ void *Z_ReallocAlign(void *ptr, size_t size, INT32 tag, void *user, INT32 alignb
 	}
 
 	if (!ptr)
-	{
-#ifdef ZDEBUG
 		return Z_Calloc2(size, tag, user, alignbits, file , line);
-#else
-		return Z_CallocAlign(size, tag, user, alignbits);
-#endif
-	}
 
 #ifdef ZDEBUG
 	block = Ptr2Memblock2(ptr, "Z_Realloc", file, line);
@@ -448,10 +725,8 @@ void *Z_ReallocAlign(void *ptr, size_t size, INT32 tag, void *user, INT32 alignb
 #ifdef ZDEBUG
 	// Write every Z_Realloc call to a debug file.
 	DEBFILE(va("Z_Realloc at %s:%d\n", file, line));
-	rez = Z_Malloc2(size, tag, user, alignbits, file, line);
-#else
-	rez = Z_MallocAlign(size, tag, user, alignbits);
 #endif
+	rez = Z_Malloc2(size, tag, user, alignbits, file, line);
 
 	if (size < block->realsize)
 		copysize = size;
@@ -486,7 +761,12 @@ void Z_FreeTags(INT32 lowtag, INT32 hightag)
 {
 	memblock_t *block, *next;
 
-	Z_CheckHeap(420);
+	// Only ZDEBUG builds check the level list here, as that walks
+	// every level block and defeats the point of the level arena.
+	Z_CheckList(420, &head);
+#ifdef ZDEBUG
+	Z_CheckList(420, &levelhead);
+#endif
 	for (block = head.next; block != &head; block = next)
 	{
 		next = block->next; // get link before freeing
@@ -494,6 +774,31 @@ void Z_FreeTags(INT32 lowtag, INT32 hightag)
 		if (block->tag >= lowtag && block->tag <= hightag)
 			Z_Free((UINT8 *)block->hdr + sizeof *block->hdr);
 	}
+
+	if (hightag < PU_LEVEL || lowtag >= PU_PURGELEVEL)
+		return; // nothing on the level list can match
+
+#ifdef ZSLAB
+	// Freeing the whole level? Drop the arena instead of walking it.
+	if (levelarena && lowtag <= PU_LEVEL && hightag >= PU_PURGELEVEL - 1 && !slabescaped)
+	{
+		Z_ResetLevelArena();
+		return;
+	}
+#endif
+
+	for (block = levelhead.next; block != &levelhead; block = next)
+	{
+		next = block->next; // get link before freeing
+
+		if (block->tag >= lowtag && block->tag <= hightag)
+			Z_Free((UINT8 *)block->hdr + sizeof *block->hdr);
+	}
+
+#ifdef ZSLAB
+	// Give the pages of any size class that emptied out back to the system
+	Z_SlabTrim();
+#endif
 }
 
 /** Iterates through all memory for a given set of tags.
@@ -504,25 +809,315 @@ void Z_FreeTags(INT32 lowtag, INT32 hightag)
   */
 void Z_IterateTags(INT32 lowtag, INT32 hightag, boolean (*iterfunc)(void *))
 {
-	memblock_t *block, *next;
+	memblock_t *list, *block, *next;
 
 	if (!iterfunc)
 		I_Error("Z_IterateTags: no iterator function was given");
 
-	for (block = head.next; block != &head; block = next)
+	for (list = &head; list; list = (list == &head) ? &levelhead : NULL)
+	{
+		for (block = list->next; block != list; block = next)
+		{
+			next = block->next; // get link before possibly freeing
+
+			if (block->tag >= lowtag && block->tag <= hightag)
+			{
+				void *mem = (UINT8 *)block->hdr + sizeof *block->hdr;
+				boolean free = iterfunc(mem);
+				if (free)
+					Z_Free(mem);
+			}
+		}
+	}
+}
+
+#ifdef ZSLAB
+// --------------------
+// Slab allocator
+// --------------------
+
+/** Picks the slab size class that can hold a block.
+  *
+  * \param size Amount of memory requested, in bytes.
+  * \param tag Purge tag.
+  * \param user The user of the block.
+  * \param alignbits The alignment requested, in bits.
+  * \return The size class, or NULL if the block should be malloc'd instead.
+  */
+static zslab_t *Z_SlabForSize(size_t size, INT32 tag, void *user, INT32 alignbits)
+{
+	// Only level-lifetime blocks churn enough to be worth it
+	if (!Z_IsLevelTag(tag))
+		return NULL;
+
+	// Blocks with a user (lump caches and such) may be retagged later on,
+	// and would need to be walked to clear their users anyway
+	if (user != NULL)
+		return NULL;
+
+	if ((1<<alignbits) > ZSLAB_ALIGN)
+		return NULL;
+
+	if (size > ZSLAB_MAXOBJSIZE - ZSLAB_DATAOFS)
+		return NULL;
+
+	return &slabs[(ZSLAB_DATAOFS + size - 1) / ZSLAB_GRANULARITY];
+}
+
+/** Adds a chunk that was just put in the level arena to sortedchunks.
+  *
+  * \param chunk The new chunk, not yet counted in numarenachunks.
+  */
+static void Z_SortArenaChunk(zarenachunk_t *chunk)
+{
+	size_t i;
+
+	if (numarenachunks == sortedchunkssize)
 	{
-		next = block->next; // get link before possibly freeing
+		sortedchunkssize = sortedchunkssize ? sortedchunkssize * 2 : 16;
+		sortedchunks = realloc(sortedchunks, sortedchunkssize * sizeof (*sortedchunks));
+		if (!sortedchunks)
+			I_Error("Z_SortArenaChunk: out of memory");
+	}
 
-		if (block->tag >= lowtag && block->tag <= hightag)
+	for (i = numarenachunks; i > 0 && sortedchunks[i - 1] > chunk; i--)
+		sortedchunks[i] = sortedchunks[i - 1];
+	sortedchunks[i] = chunk;
+}
+
+/** Allocates a page for a slab size class, from the level arena if it is enabled.
+  *
+  * \return A pointer to the new page.
+  */
+static zslabpage_t *Z_SlabNewPage(void)
+{
+	zarenachunk_t *chunk = arenachunks;
+
+	if (!levelarena)
+		return xm(ZSLAB_PAGESIZE);
+
+	if (!chunk || chunk->numpages == ZARENA_PAGESPERCHUNK)
+	{
+		if (sparechunks)
+		{
+			chunk = sparechunks;
+			sparechunks = chunk->next;
+			numsparechunks--;
+		}
+		else
+			chunk = xm(ZARENA_CHUNKSIZE);
+
+		chunk->next = arenachunks;
+		chunk->numpages = 0;
+		arenachunks = chunk;
+		Z_SortArenaChunk(chunk);
+		numarenachunks++;
+	}
+
+	return (zslabpage_t *)((UINT8 *)chunk + ZARENA_CHUNKOFS + (chunk->numpages++) * ZSLAB_PAGESIZE);
+}
+
+/** Takes an object from a slab size class, adding a new page if it ran out.
+  *
+  * \param slab The size class.
+  * \return A pointer to the start of the object.
+  */
+static void *Z_SlabAlloc(zslab_t *slab)
+{
+	void *obj;
+
+	if (slab->freelist)
+	{
+		obj = slab->freelist;
+		slab->freelist = slab->freelist->next;
+	}
+	else
+	{
+		if (slab->bump + slab->objsize > slab->bumpend)
+		{
+			zslabpage_t *page = Z_SlabNewPage();
+
+			page->next = slab->pages;
+			slab->pages = page;
+			slab->numpages++;
+
+			slab->bump = ZSLAB_PAGESTART(page);
+			slab->bumpend = (UINT8 *)page + ZSLAB_PAGESIZE;
+		}
+
+		obj = slab->bump;
+		slab->bump += slab->objsize;
+	}
+
+	slab->numlive++;
+	return obj;
+}
+
+/** Returns a block to the size class it was taken from.
+  * The block must already be unlinked from the zone list.
+  *
+  * \param block The block to release.
+  */
+static void Z_SlabFree(memblock_t *block)
+{
+	zslab_t *slab = block->slab;
+	zslabfree_t *obj = block->real; // start of the slab object
+
+	block->hdr->id = 0; // catch double frees
+
+	obj->next = slab->freelist;
+	slab->freelist = obj;
+	slab->numlive--;
+}
+
+/** Releases the pages of every size class that has no live objects left.
+  * Typically this is everything after Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1).
+  */
+static void Z_SlabTrim(void)
+{
+	size_t i;
+
+	if (levelarena)
+	{
+		// The pages are carved out of the arena's chunks, so they can only
+		// go back all at once, when nothing lives in any of them anymore.
+		for (i = 0; i < ZSLAB_NUMCLASSES; i++)
+			if (slabs[i].numlive)
+				return;
+		Z_RecycleLevelArena();
+		return;
+	}
+
+	for (i = 0; i < ZSLAB_NUMCLASSES; i++)
+	{
+		zslab_t *slab = &slabs[i];
+		zslabpage_t *page, *next;
+
+		if (slab->numlive || !slab->pages)
+			continue;
+
+		for (page = slab->pages; page; page = next)
 		{
-			void *mem = (UINT8 *)block->hdr + sizeof *block->hdr;
-			boolean free = iterfunc(mem);
-			if (free)
-				Z_Free(mem);
+			next = page->next;
+			free(page);
 		}
+
+		slab->pages = NULL;
+		slab->freelist = NULL;
+		slab->bump = slab->bumpend = NULL;
+		slab->numpages = 0;
+	}
+}
+
+/** Checks if a pointer points into the level arena.
+  *
+  * \param ptr The pointer to check.
+  * \return true if the pointer is inside one of the arena chunks.
+  */
+static boolean Z_InLevelArena(void *ptr)
+{
+	size_t lo = 0, hi = numarenachunks, mid;
+
+	// Find the last chunk that starts at or before ptr
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if ((UINT8 *)sortedchunks[mid] <= (UINT8 *)ptr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return (lo > 0 && (UINT8 *)ptr < (UINT8 *)sortedchunks[lo - 1] + ZARENA_CHUNKSIZE);
+}
+
+/** Gives the arena chunks left over from previous levels back to the system.
+  */
+static void Z_FreeSpareArena(void)
+{
+	zarenachunk_t *chunk, *next;
+
+	for (chunk = sparechunks; chunk; chunk = next)
+	{
+		next = chunk->next;
+		free(chunk);
+	}
+
+	sparechunks = NULL;
+	numsparechunks = 0;
+}
+
+/** Empties every size class and keeps the arena's chunks for the next level,
+  * minus those that this level didn't need.
+  */
+static void Z_RecycleLevelArena(void)
+{
+	zarenachunk_t *chunk, *next;
+	size_t i;
+
+	Z_FreeSpareArena();
+
+	for (chunk = arenachunks; chunk; chunk = next)
+	{
+		next = chunk->next;
+		chunk->next = sparechunks;
+		sparechunks = chunk;
+	}
+
+	numsparechunks = numarenachunks;
+	arenachunks = NULL;
+	numarenachunks = 0;
+
+	for (i = 0; i < ZSLAB_NUMCLASSES; i++)
+	{
+		zslab_t *slab = &slabs[i];
+		slab->pages = NULL;
+		slab->freelist = NULL;
+		slab->bump = slab->bumpend = NULL;
+		slab->numpages = 0;
+		slab->numlive = 0;
 	}
 }
 
+/** Frees every level-tagged slab block at once, by releasing the level arena.
+  * Only used when no slab block was retagged out of the level tags.
+  *
+  * \sa Z_FreeTags
+  */
+static void Z_ResetLevelArena(void)
+{
+	memblock_t *block;
+	size_t i;
+
+	// Users given to slab blocks by Z_SetUser still need to be cleared
+	if (slabusers)
+	{
+		for (block = levelhead.next; block != &levelhead; block = block->next)
+			if (block->user != NULL)
+				*block->user = NULL;
+		slabusers = 0;
+	}
+
+	// Same as Z_Free passing every block to Lua,
+	// without looking up every single block
+	LUA_InvalidateUserdataIf(Z_InLevelArena);
+
+	Z_RecycleLevelArena();
+
+	levelhead.next = levelhead.prev = &levelhead;
+
+	// Every block on the level list is gone
+	for (i = 0; i < ZNUMTAGSTATS + numsites; i++)
+	{
+		zstats_t *st = (i < ZNUMTAGSTATS) ? &tagstats[i] : &sitestats[i - ZNUMTAGSTATS];
+		st->frees += st->arenablocks;
+		st->live -= st->arena;
+		st->liveblocks -= st->arenablocks;
+		st->arena = st->arenablocks = 0;
+	}
+}
+#endif
+
 // -----------------
 // Utility functions
 // -----------------
@@ -552,19 +1147,20 @@ void Z_CheckMemCleanup(void)
 }
 
 
-/** Checks the heap, as well as the memhdr_ts, for any corruption or
-  * other problems.
+/** Checks one zone memory block list, as well as the memhdr_ts,
+  * for any corruption or other problems.
   * \param i Identifies from where in the code Z_CheckHeap was called.
+  * \param list The head of the list, either head or levelhead.
   * \author Graue <graue@oceanbase.org>
   */
-void Z_CheckHeap(INT32 i)
+static void Z_CheckList(INT32 i, memblock_t *list)
 {
 	memblock_t *block;
 	memhdr_t *hdr;
 	UINT32 blocknumon = 0;
 	void *given;
 
-	for (block = head.next; block != &head; block = block->next)
+	for (block = list->next; block != list; block = block->next)
 	{
 		blocknumon++;
 		hdr = block->hdr;
@@ -657,6 +1253,16 @@ void Z_CheckHeap(INT32 i)
 	}
 }
 
+/** Checks the heap, as well as the memhdr_ts, for any corruption or
+  * other problems.
+  * \param i Identifies from where in the code Z_CheckHeap was called.
+  */
+void Z_CheckHeap(INT32 i)
+{
+	Z_CheckList(i, &head);
+	Z_CheckList(i, &levelhead);
+}
+
 // ------------------------
 // Zone memory modification
 // ------------------------
@@ -710,7 +1316,35 @@ void Z_ChangeTag(void *ptr, INT32 tag)
 		I_Error("Internal memory management error: "
 			"tried to make block purgable but it has no owner");
 
+	Z_StatsUnlink(Z_TagStats(block->tag), block);
+	if (block->site)
+		Z_StatsUnlink(&sitestats[block->site], block);
+
+#ifdef ZSLAB
+	// Level slab blocks live on their own list, move the block over
+	if (block->slab && Z_IsLevelTag(block->tag) != Z_IsLevelTag(tag))
+	{
+		block->prev->next = block->next;
+		block->next->prev = block->prev;
+
+		if (Z_IsLevelTag(tag))
+		{
+			Z_LinkBlock(block, &levelhead);
+			slabescaped--;
+		}
+		else
+		{
+			Z_LinkBlock(block, &head);
+			slabescaped++;
+		}
+	}
+#endif
+
 	block->tag = tag;
+
+	Z_StatsLink(Z_TagStats(block->tag), block);
+	if (block->site)
+		Z_StatsLink(&sitestats[block->site], block);
 }
 
 /** Changes a memory block's user.
@@ -752,6 +1386,16 @@ void Z_SetUser(void *ptr, void **newuser)
 		I_Error("Internal memory management error: "
 			"tried to make block purgable but it has no owner");
 
+#ifdef ZSLAB
+	if (block->slab && (block->user == NULL) != (newuser == NULL))
+	{
+		if (newuser)
+			slabusers++;
+		else
+			slabusers--;
+	}
+#endif
+
 	block->user = (void*)newuser;
 	*newuser = ptr;
 }
@@ -770,24 +1414,107 @@ void Z_SetUser(void *ptr, void **newuser)
 size_t Z_TagsUsage(INT32 lowtag, INT32 hightag)
 {
 	size_t cnt = 0;
-	memblock_t *rover;
+	memblock_t *list, *rover;
 
-	for (rover = head.next; rover != &head; rover = rover->next)
+	for (list = &head; list; list = (list == &head) ? &levelhead : NULL)
 	{
-		if (rover->tag < lowtag || rover->tag > hightag)
-			continue;
-		cnt += rover->size + sizeof *rover;
+		for (rover = list->next; rover != list; rover = rover->next)
+		{
+			if (rover->tag < lowtag || rover->tag > hightag)
+				continue;
+			cnt += rover->size + sizeof *rover;
+		}
 	}
 
 	return cnt;
 }
 
+/** Returns the statistics kept for a tag.
+  *
+  * \param tag The tag.
+  * \return The tag's statistics. Tags past ZNUMTAGSTATS share the last entry.
+  */
+const zstats_t *Z_GetTagStats(INT32 tag)
+{
+	return Z_TagStats(tag);
+}
+
+/** Finds the call sites that allocated the most memory during the last tic,
+  * or with the most live memory if that's a tie.
+  *
+  * \param sites An array to fill with the call sites, most allocating first.
+  * \param maxsites The size of the array.
+  * \return The number of call sites put in the array.
+  */
+size_t Z_GetTopSites(const zstats_t **sites, size_t maxsites)
+{
+	size_t i, j, count = 0;
+
+	for (i = 1; i < numsites; i++)
+	{
+		const zstats_t *site = &sitestats[i];
+
+		if (!site->lastticbytes && !site->live)
+			continue;
+
+		// Insertion sort into the small output array
+		for (j = count; j > 0; j--)
+		{
+			const zstats_t *other = sites[j - 1];
+			if (other->lastticbytes > site->lastticbytes
+			|| (other->lastticbytes == site->lastticbytes && other->live >= site->live))
+				break;
+			if (j < maxsites)
+				sites[j] = other;
+		}
+
+		if (j < maxsites)
+		{
+			sites[j] = site;
+			if (count < maxsites)
+				count++;
+		}
+	}
+
+	return count;
+}
+
+/** Checks if the allocation profiler is running.
+  *
+  * \return true if call sites are being profiled.
+  */
+boolean Z_IsProfiling(void)
+{
+	return profiling;
+}
+
+/** Moves the per-tic statistics over to the next tic.
+  * Called once per game tic.
+  */
+void Z_StatsTicker(void)
+{
+	size_t i;
+
+	for (i = 0; i < ZNUMTAGSTATS; i++)
+	{
+		tagstats[i].lastticbytes = tagstats[i].ticbytes;
+		tagstats[i].ticbytes = 0;
+	}
+
+	for (i = 1; i < numsites; i++)
+	{
+		sitestats[i].lastticbytes = sitestats[i].ticbytes;
+		sitestats[i].ticbytes = 0;
+	}
+}
+
 // -----------------------
 // Miscellaneous functions
 // -----------------------
 
 /** The function called by the "memfree" console command.
   * Prints the memory being used by each part of the game to the console.
+  * With -slab, also lists every slab size class in use.
   */
 static void Command_Memfree_f(void)
 {
@@ -822,6 +1549,36 @@ static void Command_Memfree_f(void)
 	}
 #endif
 
+#ifdef ZSLAB
+	{
+		size_t i, pages = 0;
+
+		for (i = 0; i < ZSLAB_NUMCLASSES; i++)
+			pages += slabs[i].numpages;
+
+		CONS_Printf(M_GetText("Level slabs            : %7s KB\n"), sizeu1((pages * ZSLAB_PAGESIZE)>>10));
+		if (levelarena)
+		{
+			CONS_Printf(M_GetText("Level arena            : %7s KB in %s chunks\n"),
+				sizeu1((numarenachunks * ZARENA_CHUNKSIZE)>>10), sizeu2(numarenachunks));
+			CONS_Printf(M_GetText("Level arena (spare)    : %7s KB\n"),
+				sizeu1((numsparechunks * ZARENA_CHUNKSIZE)>>10));
+		}
+
+		if (COM_CheckParm("-slab"))
+		{
+			for (i = 0; i < ZSLAB_NUMCLASSES; i++)
+			{
+				const zslab_t *slab = &slabs[i];
+				if (!slab->numpages)
+					continue;
+				CONS_Printf(M_GetText("  %4s byte objects     : %7s live, %4s pages\n"),
+					sizeu1(slab->objsize - ZSLAB_DATAOFS), sizeu2(slab->numlive), sizeu3(slab->numpages));
+			}
+		}
+	}
+#endif
+
 	CONS_Printf("\x82%s", M_GetText("System Memory Info\n"));
 	freebytes = I_GetFreeMem(&totalbytes);
 	CONS_Printf(M_GetText("    Total physical memory: %7u KB\n"), totalbytes>>10);
@@ -836,7 +1593,7 @@ static void Command_Memfree_f(void)
   */
 static void Command_Memdump_f(void)
 {
-	memblock_t *block;
+	memblock_t *list, *block;
 	INT32 mintag = 0, maxtag = INT32_MAX;
 	INT32 i;
 
@@ -846,15 +1603,131 @@ static void Command_Memdump_f(void)
 	if ((i = COM_CheckParm("-max")))
 		maxtag = atoi(COM_Argv(i + 1));
 
-	for (block = head.next; block != &head; block = block->next)
+	for (list = &head; list; list = (list == &head) ? &levelhead : NULL)
+	for (block = list->next; block != list; block = block->next)
 		if (block->tag >= mintag && block->tag <= maxtag)
 		{
 			char *filename = strrchr(block->ownerfile, PATHSEP[0]);
+#ifdef ZSLAB
+			if (block->slab)
+			{
+				CONS_Printf("[%3d] %s (%s) bytes @ %s:%d (slab %s)\n", block->tag, sizeu1(block->size), sizeu2(block->realsize), filename ? filename + 1 : block->ownerfile, block->ownerline, sizeu3(block->slab->objsize - ZSLAB_DATAOFS));
+				continue;
+			}
+#endif
 			CONS_Printf("[%3d] %s (%s) bytes @ %s:%d\n", block->tag, sizeu1(block->size), sizeu2(block->realsize), filename ? filename + 1 : block->ownerfile, block->ownerline);
 		}
 }
 #endif
 
+/** Writes every tag's and profiled call site's statistics to a CSV file.
+  *
+  * \param filename The file to write to, in srb2home. Always given a .csv extension.
+  */
+static void Z_DumpStats(const char *filename)
+{
+	char name[256];
+	const char *path;
+	FILE *f;
+	size_t i;
+
+	// Lua can run this command too, so keep it out of other folders
+	if (!FIL_IsPlainFileName(filename))
+	{
+		CONS_Alert(CONS_ERROR, M_GetText("%s is not a valid file name\n"), filename);
+		return;
+	}
+
+	strlcpy(name, filename, sizeof name - 4);
+	FIL_ForceExtension(name, ".csv");
+
+	path = va("%s"PATHSEP"%s", srb2home, name);
+	f = fopen(path, "w");
+
+	if (!f)
+	{
+		CONS_Alert(CONS_ERROR, M_GetText("Couldn't open %s for writing\n"), path);
+		return;
+	}
+
+	fprintf(f, "kind,name,line,allocs,frees,bytes,live_bytes,live_blocks,peak_bytes,last_tic_bytes\n");
+
+	for (i = 0; i < ZNUMTAGSTATS; i++)
+	{
+		const zstats_t *st = &tagstats[i];
+		if (!st->allocs)
+			continue;
+		fprintf(f, "tag,%s,,%s,%s,%s,%s,%s,%s,%s\n", sizeu1(i),
+			sizeu2(st->allocs), sizeu3(st->frees), sizeu4(st->bytes), sizeu5(st->live),
+			sizeu1(st->liveblocks), sizeu2(st->peak), sizeu3(st->lastticbytes));
+	}
+
+	for (i = 1; i < numsites; i++)
+	{
+		const zstats_t *st = &sitestats[i];
+		fprintf(f, "site,%s,%d,%s,%s,%s,%s,%s,%s,%s\n", st->file, st->line,
+			sizeu1(st->allocs), sizeu2(st->frees), sizeu3(st->bytes), sizeu4(st->live),
+			sizeu5(st->liveblocks), sizeu1(st->peak), sizeu2(st->lastticbytes));
+	}
+
+	fclose(f);
+	CONS_Printf(M_GetText("Zone statistics written to %s\n"), path);
+}
+
+/** The function called by the "zprofile" console command.
+  * Controls the allocation profiler:
+  * zprofile on|off starts or stops profiling call sites,
+  * zprofile reset clears the totals and peaks,
+  * zprofile dump [file] writes all statistics to a CSV file,
+  * and with no arguments, the call sites allocating the most are listed.
+  */
+static void Command_Zprofile_f(void)
+{
+	const char *arg = (COM_Argc() > 1) ? COM_Argv(1) : "";
+	size_t i;
+
+	if (!stricmp(arg, "on"))
+	{
+		profiling = true;
+		CONS_Printf(M_GetText("Allocation profiler started.\n"));
+	}
+	else if (!stricmp(arg, "off"))
+	{
+		profiling = false;
+		CONS_Printf(M_GetText("Allocation profiler stopped.\n"));
+	}
+	else if (!stricmp(arg, "reset"))
+	{
+		for (i = 0; i < ZNUMTAGSTATS + numsites; i++)
+		{
+			zstats_t *st = (i < ZNUMTAGSTATS) ? &tagstats[i] : &sitestats[i - ZNUMTAGSTATS];
+			st->allocs = st->frees = st->bytes = 0;
+			st->peak = st->live;
+		}
+		CONS_Printf(M_GetText("Allocation profiler reset.\n"));
+	}
+	else if (!stricmp(arg, "dump"))
+	{
+		Z_DumpStats((COM_Argc() > 2) ? COM_Argv(2) : "zprofile.csv");
+	}
+	else
+	{
+		const zstats_t *top[10];
+		size_t count = Z_GetTopSites(top, sizeof top / sizeof *top);
+
+		CONS_Printf(M_GetText("zprofile <on/off/reset/dump [file]>: Profile zone allocations\n"));
+		CONS_Printf(M_GetText("The profiler is %s.\n"), profiling ? M_GetText("running") : M_GetText("stopped"));
+
+		for (i = 0; i < count; i++)
+		{
+			const char *filename = strrchr(top[i]->file, PATHSEP[0]);
+			CONS_Printf("%s:%d - %s bytes/tic, %s KB live, %s allocs\n",
+				filename ? filename + 1 : top[i]->file, top[i]->line,
+				sizeu1(top[i]->lastticbytes), sizeu2(top[i]->live>>10), sizeu3(top[i]->allocs));
+		}
+	}
+}
+
 /** Creates a copy of a string.
   *
   * \param s The string to be copied.
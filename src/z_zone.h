@@ -79,26 +79,27 @@ void Z_Init(void);
 //
 // Zone memory allocation
 //
-// enable ZDEBUG to get the file + line the functions were called from
+// The allocation functions always get the file + line they were called
+// from, for the allocation profiler (see the "zprofile" command)
+// enable ZDEBUG to get them for Z_Free too, and in the memdump command
 // for ZZ_Alloc, see doomdef.h
 //
 
-// Z_Free and alloc with alignment
+// Z_Free
 #ifdef ZDEBUG
 #define Z_Free(p)                 Z_Free2(p, __FILE__, __LINE__)
+void Z_Free2(void *ptr, const char *file, INT32 line);
+#else
+void Z_Free(void *ptr);
+#endif
+
+// Alloc with alignment
 #define Z_MallocAlign(s,t,u,a)    Z_Malloc2(s, t, u, a, __FILE__, __LINE__)
 #define Z_CallocAlign(s,t,u,a)    Z_Calloc2(s, t, u, a, __FILE__, __LINE__)
 #define Z_ReallocAlign(p,s,t,u,a) Z_Realloc2(p,s, t, u, a, __FILE__, __LINE__)
-void Z_Free2(void *ptr, const char *file, INT32 line);
 void *Z_Malloc2(size_t size, INT32 tag, void *user, INT32 alignbits, const char *file, INT32 line) FUNCALLOC(1);
 void *Z_Calloc2(size_t size, INT32 tag, void *user, INT32 alignbits, const char *file, INT32 line) FUNCALLOC(1);
 void *Z_Realloc2(void *ptr, size_t size, INT32 tag, void *user, INT32 alignbits, const char *file, INT32 line) FUNCALLOC(2);
-#else
-void Z_Free(void *ptr);
-void *Z_MallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits) FUNCALLOC(1);
-void *Z_CallocAlign(size_t size, INT32 tag, void *user, INT32 alignbits) FUNCALLOC(1);
-void *Z_ReallocAlign(void *ptr, size_t size, INT32 tag, void *user, INT32 alignbits) FUNCALLOC(2);
-#endif
 
 // Alloc with no alignment
 #define Z_Malloc(s,t,u)    Z_MallocAlign(s, t, u, 0)
@@ -146,6 +147,36 @@ void Z_SetUser(void *ptr, void **newuser);
 size_t Z_TagsUsage(INT32 lowtag, INT32 hightag);
 #define Z_TotalUsage() Z_TagsUsage(0, INT32_MAX)
 
+//
+// Zone memory statistics
+//
+// Per-tag statistics are always kept. Per-call site statistics are only
+// gathered while the allocation profiler is running (zprofile on).
+//
+typedef struct
+{
+	const char *file; // call site, NULL for tags
+	INT32 line;
+
+	size_t allocs, frees; // number of calls
+	size_t bytes; // total bytes allocated
+	size_t live, liveblocks; // bytes and blocks currently allocated
+	size_t peak; // highest live ever got
+
+	size_t ticbytes; // bytes allocated during the current tic
+	size_t lastticbytes; // bytes allocated during the last tic
+
+	// bytes and blocks in the level arena, released all at once
+	size_t arena, arenablocks;
+} zstats_t;
+
+#define ZNUMTAGSTATS 128
+
+const zstats_t *Z_GetTagStats(INT32 tag);
+size_t Z_GetTopSites(const zstats_t **sites, size_t maxsites);
+boolean Z_IsProfiling(void);
+void Z_StatsTicker(void);
+
 //
 // Miscellaneous functions
 //